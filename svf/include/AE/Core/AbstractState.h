@@ -48,6 +48,7 @@
 
 #include "AE/Core/AbstractValue.h"
 #include "AE/Core/IntervalValue.h"
+#include "AE/Core/ZoneDomain.h"
 #include "SVFIR/SVFVariables.h"
 #include "Util/Z3Expr.h"
 
@@ -59,9 +60,11 @@ class AbstractState
 {
     friend class SVFIR2AbsState;
     friend class RelationSolver;
+    friend class AESummaryCache;
 public:
     typedef Map<u32_t, AbstractValue> VarToAbsValMap;
     typedef VarToAbsValMap AddrToAbsValMap;
+    typedef Map<u32_t, DBM> PackToDBMMap;
     Set<NodeID> _freedAddrs;
 
 
@@ -74,7 +77,8 @@ public:
     AbstractState(VarToAbsValMap&_varToValMap, AddrToAbsValMap&_locToValMap) : _varToAbsVal(_varToValMap), _addrToAbsVal(_locToValMap) {}
 
     /// copy constructor
-    AbstractState(const AbstractState&rhs) : _freedAddrs(rhs._freedAddrs), _varToAbsVal(rhs.getVarToVal()), _addrToAbsVal(rhs.getLocToVal())
+    AbstractState(const AbstractState&rhs) : _freedAddrs(rhs._freedAddrs), _varToAbsVal(rhs.getVarToVal()), _addrToAbsVal(rhs.getLocToVal()),
+        _packToDBM(rhs.getPackToDBM())
     {
 
     }
@@ -124,13 +128,14 @@ public:
             _varToAbsVal = rhs._varToAbsVal;
             _addrToAbsVal = rhs._addrToAbsVal;
             _freedAddrs = rhs._freedAddrs;
+            _packToDBM = rhs._packToDBM;
         }
         return *this;
     }
 
     /// move constructor
     AbstractState(AbstractState&&rhs) : _varToAbsVal(std::move(rhs._varToAbsVal)),
-        _addrToAbsVal(std::move(rhs._addrToAbsVal))
+        _addrToAbsVal(std::move(rhs._addrToAbsVal)), _packToDBM(std::move(rhs._packToDBM))
     {
 
     }
@@ -143,6 +148,7 @@ public:
             _varToAbsVal = std::move(rhs._varToAbsVal);
             _addrToAbsVal = std::move(rhs._addrToAbsVal);
             _freedAddrs = std::move(rhs._freedAddrs);
+            _packToDBM = std::move(rhs._packToDBM);
         }
         return *this;
     }
@@ -197,6 +203,7 @@ protected:
     VarToAbsValMap _varToAbsVal; ///< Map a variable (symbol) to its abstract value
     AddrToAbsValMap
     _addrToAbsVal; ///< Map a memory address to its stored abstract value
+    PackToDBMMap _packToDBM; ///< Map a variable pack to its zone (DBM), a missing pack is top
 
 public:
 
@@ -277,11 +284,35 @@ public:
         return _addrToAbsVal;
     }
 
+    /// get pack2dbm map
+    const PackToDBMMap&getPackToDBM() const
+    {
+        return _packToDBM;
+    }
+
+    /// whether the pack has relational constraints (otherwise it is top)
+    inline bool hasDBM(u32_t packId) const
+    {
+        return _packToDBM.find(packId) != _packToDBM.end();
+    }
+
+    /// get the zone of a pack, creating a top DBM of the given dimension on demand
+    inline DBM& getDBM(u32_t packId, u32_t dim)
+    {
+        auto it = _packToDBM.find(packId);
+        if (it == _packToDBM.end())
+            it = _packToDBM.emplace(packId, DBM(dim)).first;
+        return it->second;
+    }
+
 public:
 
     /// domain widen with other, and return the widened domain
     AbstractState widening(const AbstractState&other);
 
+    /// domain widen with other using widening thresholds for intervals, and return the widened domain
+    AbstractState widening(const AbstractState&other, const OrderedSet<s64_t>& thresholds);
+
     /// domain narrow with other, and return the narrowed domain
     AbstractState narrowing(const AbstractState&other);
 
@@ -391,7 +422,8 @@ public:
     bool operator==(const AbstractState&rhs) const
     {
         return  eqVarToValMap(_varToAbsVal, rhs.getVarToVal()) &&
-                eqVarToValMap(_addrToAbsVal, rhs.getLocToVal());
+                eqVarToValMap(_addrToAbsVal, rhs.getLocToVal()) &&
+                _packToDBM == rhs.getPackToDBM();
     }
 
     bool operator!=(const AbstractState&rhs) const
@@ -415,6 +447,7 @@ public:
         _addrToAbsVal.clear();
         _varToAbsVal.clear();
         _freedAddrs.clear();
+        _packToDBM.clear();
     }
 
 };
@@ -454,6 +454,48 @@ public:
         }
     }
 
+    /// Current IntervalValue widen with another IntervalValue, an unstable bound
+    /// jumps to the nearest threshold before it goes to infinity
+    void widen_with(const IntervalValue &other, const OrderedSet<s64_t> &thresholds)
+    {
+        if (this->isBottom())
+        {
+            this->_lb = other._lb;
+            this->_ub = other._ub;
+        }
+        else if (other.isBottom())
+        {
+            return;
+        }
+        else
+        {
+            BoundedInt lb = this->lb(), ub = this->ub();
+            if (!lb.leq(other.lb()))
+            {
+                lb = minus_infinity();
+                if (!other.lb().is_infinity())
+                {
+                    // greatest threshold <= other.lb
+                    auto it = thresholds.upper_bound(other.lb().getNumeral());
+                    if (it != thresholds.begin())
+                        lb = BoundedInt(*std::prev(it));
+                }
+            }
+            if (!ub.geq(other.ub()))
+            {
+                ub = plus_infinity();
+                if (!other.ub().is_infinity())
+                {
+                    // least threshold >= other.ub
+                    auto it = thresholds.lower_bound(other.ub().getNumeral());
+                    if (it != thresholds.end())
+                        ub = BoundedInt(*it);
+                }
+            }
+            setValue(lb, ub);
+        }
+    }
+
     /// Current IntervalValue narrow with another IntervalValue
     void narrow_with(const IntervalValue &other)
     {
@@ -0,0 +1,236 @@
+//===- ZoneDomain.h ----Zone (Difference-Bound Matrix) Domain---------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * ZoneDomain.h
+ *
+ * A native relational numeric domain for abstract execution. Constraints of
+ * the form  v_j - v_i <= c  are kept in a dense difference-bound matrix (DBM)
+ * whose row/column 0 is the constant zero, so that interval bounds
+ * (v_k <= c and -v_k <= c) live in the same matrix. To keep the cubic closure
+ * affordable, variables are grouped into small packs by syntactic
+ * co-occurrence in CmpStmt/BinaryOPStmt/CopyStmt and each pack owns one DBM.
+ *
+ * Reference: A. Miné. A New Numerical Abstract Domain Based on
+ * Difference-Bound Matrices. PADO'01.
+ */
+
+#ifndef SVF_AE_CORE_ZONEDOMAIN_H
+#define SVF_AE_CORE_ZONEDOMAIN_H
+
+#include "AE/Core/IntervalValue.h"
+#include "SVFIR/SVFIR.h"
+
+namespace SVF
+{
+
+/*!
+ * Difference-bound matrix over a fixed number of variables.
+ * Entry m(i,j) bounds v_j - v_i <= m(i,j); index 0 stands for the constant 0.
+ * All operations except widening keep the matrix in closed (canonical) form.
+ */
+class DBM
+{
+public:
+    typedef s64_t Bound;
+
+    /// +oo of a matrix entry (no constraint)
+    static constexpr Bound INF = std::numeric_limits<s64_t>::max();
+
+    /// Top DBM over dim-1 variables
+    explicit DBM(u32_t dim = 1) : _dim(dim), _bottom(false), _mat(dim * dim, INF)
+    {
+        for (u32_t i = 0; i < _dim; ++i)
+            at(i, i) = 0;
+    }
+
+    DBM(const DBM&) = default;
+    DBM(DBM&&) = default;
+    DBM& operator=(const DBM&) = default;
+    DBM& operator=(DBM&&) = default;
+
+    inline u32_t dim() const
+    {
+        return _dim;
+    }
+
+    inline bool isBottom() const
+    {
+        return _bottom;
+    }
+
+    bool isTop() const;
+
+    inline Bound get(u32_t i, u32_t j) const
+    {
+        return _mat[i * _dim + j];
+    }
+
+    /// Overwrite an entry without closure, used to restore a saved closed matrix
+    inline void set(u32_t i, u32_t j, Bound c)
+    {
+        at(i, j) = c;
+    }
+
+    /// Interval of variable k (k >= 1) implied by the matrix
+    IntervalValue getInterval(u32_t k) const;
+
+    /// Add v_j - v_i <= c and restore closure incrementally in O(n^2)
+    void addConstraint(u32_t i, u32_t j, Bound c);
+
+    /// Meet the bounds of variable k with an interval
+    void meetInterval(u32_t k, const IntervalValue& itv);
+
+    /// Drop every constraint on variable k
+    void forget(u32_t k);
+
+    /// x := y + c
+    void assign(u32_t x, u32_t y, Bound c);
+
+    /// Full Floyd-Warshall closure, O(n^3)
+    void close();
+
+    void joinWith(const DBM& other);
+
+    void meetWith(const DBM& other);
+
+    /// Standard DBM widening: unstable bounds are dropped to +oo
+    void widenWith(const DBM& other);
+
+    /// Standard DBM narrowing: only +oo bounds are refined
+    void narrowWith(const DBM& other);
+
+    bool leq(const DBM& other) const;
+
+    bool equals(const DBM& other) const;
+
+    bool operator==(const DBM& other) const
+    {
+        return equals(other);
+    }
+
+    bool operator!=(const DBM& other) const
+    {
+        return !equals(other);
+    }
+
+    void setToBottom()
+    {
+        _bottom = true;
+    }
+
+    std::string toString() const;
+
+private:
+    inline Bound& at(u32_t i, u32_t j)
+    {
+        return _mat[i * _dim + j];
+    }
+
+    /// Saturating addition of two bounds
+    static inline Bound add(Bound a, Bound b)
+    {
+        if (a == INF || b == INF)
+            return INF;
+        Bound r;
+        if (__builtin_add_overflow(a, b, &r))
+            return a > 0 ? INF : std::numeric_limits<s64_t>::min() + 1;
+        return r;
+    }
+
+    /// Set the diagonal back to zero or detect an empty DBM
+    void checkDiagonal();
+
+    u32_t _dim;
+    bool _bottom;
+    std::vector<Bound> _mat;
+};
+
+/*!
+ * Variable packing for the zone domain.
+ * Integer SVFVars that co-occur in a comparison, an additive binary operation
+ * or a value copy are unioned into the same pack, as long as the pack does not
+ * exceed the configured size. Packs with a single variable are discarded since
+ * they carry no relation beyond the interval domain.
+ */
+class ZonePacks
+{
+public:
+    typedef std::pair<u32_t, u32_t> PackSlot; ///< <pack id, index inside the DBM (>= 1)>
+
+    ZonePacks(u32_t maxPackSize) : maxPackSize(maxPackSize) {}
+
+    /// Compute packs for all statements of the SVFIR
+    void build(SVFIR* pag);
+
+    /// Whether var is a member of some pack
+    inline bool inPack(NodeID var) const
+    {
+        return varToSlot.find(var) != varToSlot.end();
+    }
+
+    inline const PackSlot& getSlot(NodeID var) const
+    {
+        return varToSlot.at(var);
+    }
+
+    /// Whether two vars share one pack
+    inline bool inSamePack(NodeID v1, NodeID v2) const
+    {
+        auto it1 = varToSlot.find(v1), it2 = varToSlot.find(v2);
+        return it1 != varToSlot.end() && it2 != varToSlot.end() && it1->second.first == it2->second.first;
+    }
+
+    /// Member variables of a pack, in DBM index order (index i+1 for packVars[i])
+    inline const std::vector<NodeID>& getPackVars(u32_t packId) const
+    {
+        return packs.at(packId);
+    }
+
+    /// DBM dimension of a pack (member variables plus the zero variable)
+    inline u32_t getPackDim(u32_t packId) const
+    {
+        return packs.at(packId).size() + 1;
+    }
+
+    inline u32_t getPackNum() const
+    {
+        return packs.size();
+    }
+
+private:
+    /// Whether var can take part in the numeric relations of a pack
+    bool isPackable(const SVFVar* var) const;
+
+    NodeID find(NodeID var);
+
+    void unite(NodeID v1, NodeID v2);
+
+    u32_t maxPackSize;
+    Map<NodeID, NodeID> parent;
+    Map<NodeID, u32_t> packSize;
+    std::vector<std::vector<NodeID>> packs;
+    Map<NodeID, PackSlot> varToSlot;
+};
+
+} // End namespace SVF
+
+#endif // SVF_AE_CORE_ZONEDOMAIN_H
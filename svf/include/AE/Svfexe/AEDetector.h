@@ -32,6 +32,20 @@
 
 namespace SVF
 {
+/**
+ * @struct AEDetectorJournal
+ * @brief Side effects of a detector while one function call is analysed.
+ *
+ * A journal is recorded when a function summary is built and replayed when
+ * the summary is reused instead of re-analysing the callee.
+ */
+struct AEDetectorJournal
+{
+    u32_t kind{0}; ///< DetectorKind of the recording detector.
+    std::vector<std::pair<NodeID, std::string>> bugs; ///< ICFGNode ID and info of every detected bug.
+    std::vector<std::pair<NodeID, IntervalValue>> gepObjOffsets; ///< GepObjVar ID and its recorded offset from base.
+};
+
 /**
  * @class AEDetector
  * @brief Base class for all detectors.
@@ -97,8 +111,45 @@ public:
         return kind;
     }
 
+    /**
+     * @brief Start recording side effects into a journal. Recordings nest, and
+     * every active journal receives the side effects.
+     * @param journal Pointer to the journal to record into.
+     */
+    void pushJournal(AEDetectorJournal* journal)
+    {
+        journal->kind = kind;
+        journals.push_back(journal);
+    }
+
+    /**
+     * @brief Stop recording into the innermost journal.
+     */
+    void popJournal()
+    {
+        journals.pop_back();
+    }
+
+    /**
+     * @brief Replay the side effects recorded in a journal.
+     * @param journal The journal recorded by a detector of the same kind.
+     */
+    virtual void replayJournal(const AEDetectorJournal& journal) = 0;
+
 protected:
+    /**
+     * @brief Record a detected bug into all active journals.
+     * @param node Pointer to the ICFG node where the bug was detected.
+     * @param info The bug information.
+     */
+    void journalBug(const ICFGNode* node, const std::string& info)
+    {
+        for (AEDetectorJournal* journal : journals)
+            journal->bugs.emplace_back(node->getId(), info);
+    }
+
     DetectorKind kind; ///< The kind of the detector.
+    std::vector<AEDetectorJournal*> journals; ///< Active journals, innermost last.
 };
 
 /**
@@ -193,6 +244,8 @@ public:
      */
     void addToGepObjOffsetFromBase(const GepObjVar* obj, const IntervalValue& offset)
     {
+        for (AEDetectorJournal* journal : journals)
+            journal->gepObjOffsets.emplace_back(obj->getId(), offset);
         gepObjOffsetFromBase[obj] = offset;
     }
 
@@ -238,6 +291,7 @@ public:
      */
     void addBugToReporter(const AEException& e, const ICFGNode* node)
     {
+        journalBug(node, e.what());
 
         GenericBug::EventStack eventStack;
         SVFBugEvent sourceInstEvent(SVFBugEvent::EventType::SourceInst, node);
@@ -265,6 +319,12 @@ public:
         nodeToBugInfo[node] = e.what(); // Record the exception information for the node
     }
 
+    /**
+     * @brief Replays recorded GEP object offsets and bugs.
+     * @param journal The journal recorded by a buffer overflow detector.
+     */
+    void replayJournal(const AEDetectorJournal& journal);
+
     /**
      * @brief Reports all detected buffer overflow bugs.
      */
@@ -375,6 +435,8 @@ public:
     */
     void addBugToReporter(const AEException& e, const ICFGNode* node)
     {
+        journalBug(node, e.what());
+
         GenericBug::EventStack eventStack;
         SVFBugEvent sourceInstEvent(SVFBugEvent::EventType::SourceInst, node);
         eventStack.push_back(sourceInstEvent); // Add the source instruction event to the event stack
@@ -398,6 +460,12 @@ public:
         nodeToBugInfo[node] = e.what(); // Record the exception information for the node
     }
 
+    /**
+     * @brief Replays recorded bugs.
+     * @param journal The journal recorded by a nullptr dereference detector.
+     */
+    void replayJournal(const AEDetectorJournal& journal);
+
     /**
      * @brief Reports all detected nullptr dereference bugs.
      */
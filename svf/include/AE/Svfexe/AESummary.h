@@ -0,0 +1,212 @@
+//===- AESummary.h -- Function summaries for Abstract Execution---------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * AESummary.h
+ *
+ * Abstract execution inlines every callee, so the effect of a call depends on
+ * the abstract state at the callee entry. A summary therefore records, for one
+ * <function content hash, entry state hash> pair, the difference between the
+ * entry and exit states of the callee together with the detector side effects
+ * (bugs, GEP offsets, discharged checkpoints). When the same pair is met again,
+ * in the same run or in a later run reading the summary file, the callee is
+ * not re-analysed and the summary is applied instead.
+ *
+ * The content hash of a function covers its ICFG nodes, intra-procedural
+ * edges, SVF statements and the constants they refer to, and is combined with
+ * the hashes of all (transitive) callees over the call graph SCCs. It does not
+ * depend on SVFVar or ICFGNode IDs: globals and functions are hashed by name,
+ * constants by value and type, and the other variables and ICFG nodes by their
+ * order of appearance in the function body. An edit of one function therefore
+ * leaves the hashes of the functions it does not (transitively) call unchanged.
+ *
+ * Entry states and summaries are keyed by IDs within a run. The summary file
+ * refers to variables and ICFG nodes by the same position-independent names
+ * (a local name is qualified by the function name), which are translated back
+ * to the IDs of the reading run. A summary mentioning a variable that has no
+ * unique name in either run is not written or not loaded.
+ *
+ * The entry state hash is only used to find a candidate summary, which is
+ * applied only if its recorded entry state equals the current one.
+ */
+
+#ifndef SVF_AE_SVFEXE_AESUMMARY_H
+#define SVF_AE_SVFEXE_AESUMMARY_H
+
+#include "AE/Svfexe/AEDetector.h"
+#include "Graphs/CallGraph.h"
+#include "Graphs/SCC.h"
+
+namespace SVF
+{
+
+/*!
+ * The effect of one analysed call of a function under a given entry state.
+ */
+struct FunSummary
+{
+    bool hasExit{false}; ///< Whether the function exit is reachable
+    AbstractState::VarToAbsValMap varDelta; ///< Variables changed or added at the exit
+    AbstractState::AddrToAbsValMap addrDelta; ///< Memory changed or added at the exit
+    Set<u32_t> removedVars; ///< Variables of the entry state no longer present at the exit
+    Set<u32_t> removedAddrs; ///< Memory of the entry state no longer present at the exit
+    Set<NodeID> freedAdded; ///< Addresses freed by the call
+    Set<NodeID> freedRemoved; ///< Freed addresses no longer recorded at the exit
+    AbstractState::PackToDBMMap exitDBMs; ///< Zones at the exit
+    std::vector<AEDetectorJournal> journals; ///< Side effects of each detector
+    Set<NodeID> dischargedCheckpoints; ///< IDs of the checkpoint CallICFGNodes handled by the call
+    AbstractState entry; ///< Entry state the summary was computed for
+};
+
+/*!
+ * Function summaries keyed by <function content hash, entry state hash>.
+ */
+class AESummaryCache
+{
+public:
+    typedef SCCDetection<CallGraph*> CallGraphSCC;
+    typedef std::pair<u64_t, u64_t> SummaryKey; ///< <function hash, entry state hash>
+
+    AESummaryCache(const ZonePacks* packs) : zonePacks(packs) {}
+
+    /// Compute the content hash of every function of the call graph
+    void computeFunHashes(ICFG* icfg, CallGraph* callGraph, CallGraphSCC* callGraphScc);
+
+    inline u64_t getFunHash(const FunObjVar* fun) const
+    {
+        auto it = funToHash.find(fun);
+        assert(it != funToHash.end() && "function hash not computed?");
+        return it->second;
+    }
+
+    /// Order-independent hash of an abstract state
+    static u64_t hashState(const AbstractState& as);
+
+    /// Return the summary of a key computed for the given entry state, nullptr if there is none
+    inline const FunSummary* getSummary(const SummaryKey& key, const AbstractState& entry) const
+    {
+        auto it = summaries.find(key);
+        if (it == summaries.end() || !sameState(it->second.entry, entry))
+            return nullptr;
+        return &it->second;
+    }
+
+    inline void addSummary(const SummaryKey& key, FunSummary&& summary)
+    {
+        summaries[key] = std::move(summary);
+    }
+
+    /// Record the difference between the entry and the exit states into a summary
+    static void makeDelta(const AbstractState& entry, const AbstractState& exit, FunSummary& summary);
+
+    /// Turn an entry state into the exit state of a summary
+    static void applyDelta(const FunSummary& summary, AbstractState& as);
+
+    /// Load summaries from a file written by writeToFile, return false if it cannot be read
+    bool readFromFile(const std::string& fileName);
+
+    /// Write the summaries of the current functions into a file
+    void writeToFile(const std::string& fileName) const;
+
+    /// Whether two states are equal, including their freed addresses
+    static bool sameState(const AbstractState& lhs, const AbstractState& rhs);
+
+    inline u32_t getSummaryNum() const
+    {
+        return summaries.size();
+    }
+
+    u32_t hitNum{0};    ///< Calls answered by a summary
+    u32_t missNum{0};   ///< Calls analysed to build a summary
+    u32_t loadedNum{0}; ///< Summaries read from the summary file
+
+private:
+    typedef Map<u64_t, std::pair<u64_t, APOffset>> GepObjNames; ///< name of a field object -> <base name, offset>
+
+    /// Local numbering of the variables and ICFG nodes of one function body
+    struct FunScope
+    {
+        u64_t name; ///< Hash of the function name
+        Map<NodeID, u32_t> vars; ///< Local variables in their order of appearance
+        Map<const ICFGNode*, u32_t> nodes; ///< ICFG nodes in their order in the body
+    };
+
+    /// Hash of the statements and control flow of a function body, naming its variables and ICFG nodes
+    u64_t hashFunBody(ICFG* icfg, const FunObjVar* fun);
+
+    /// Position-independent hash of a statement of a function body
+    u64_t hashStmt(const SVFStmt* stmt, FunScope& scope);
+
+    /// Position-independent hash of a variable of a function body, the variable is named on the way
+    u64_t hashVar(const SVFVar* var, FunScope& scope);
+
+    /// Record the name of a variable, the first name of a variable is kept
+    void addVarName(NodeID id, u64_t name);
+
+    void addNodeName(NodeID id, u64_t name);
+
+    /// Name of a variable, false if it has no unique name
+    bool getVarName(NodeID id, u64_t& name, GepObjNames& gepObjNames) const;
+
+    /// Name of the object of a virtual address, false if it has no unique name
+    bool getAddrName(u32_t addr, u64_t& name, GepObjNames& gepObjNames) const;
+
+    bool getNodeName(NodeID id, u64_t& name) const;
+
+    /// Variable of a name in this run, false if there is no unique one
+    bool getNamedVar(u64_t name, NodeID& id) const;
+
+    bool getNamedNode(u64_t name, NodeID& id) const;
+
+    /// Write a summary with names instead of IDs, false if some ID has no unique name
+    bool writeSummary(std::ostream& os, u64_t funHash, const FunSummary& summary, GepObjNames& gepObjNames) const;
+
+    /// Write the values and zones of a state, records are prefixed by the given tag
+    bool writeState(std::ostream& os, const std::string& tag, const AbstractState::VarToAbsValMap& vars,
+                    const AbstractState::AddrToAbsValMap& addrs, const AbstractState::PackToDBMMap& dbms,
+                    GepObjNames& gepObjNames) const;
+
+    bool writeValue(std::ostream& os, const std::string& tag, u64_t name, const AbstractValue& val,
+                    GepObjNames& gepObjNames) const;
+
+    /// Read the value of a record written by writeValue, false if a name is unknown
+    bool readValue(std::istream& is, NodeID& id, AbstractValue& val) const;
+
+    /// Read the zone of a record written by writeState, false if its pack does not exist in this run
+    bool readDBM(std::istream& is, u32_t& packId, DBM& dbm) const;
+
+    /// Hash of a call graph SCC and all SCCs reachable from it
+    u64_t hashSCC(NodeID rep, CallGraph* callGraph, CallGraphSCC* callGraphScc,
+                  const Map<NodeID, u64_t>& ownHashes, Map<NodeID, u64_t>& sccHashes) const;
+
+    const ZonePacks* zonePacks;
+    Map<const FunObjVar*, u64_t> funToHash;
+    Map<SummaryKey, FunSummary> summaries;
+    Map<NodeID, u64_t> varToName;
+    Map<u64_t, NodeID> nameToVar;
+    Map<NodeID, u64_t> nodeToName;
+    Map<u64_t, NodeID> nameToNode;
+    Set<u64_t> ambiguousNames; ///< Names given to more than one variable or ICFG node
+};
+
+} // End namespace SVF
+
+#endif // SVF_AE_SVFEXE_AESUMMARY_H
@@ -32,6 +32,7 @@
 #include "AE/Core/AbstractState.h"
 #include "AE/Core/ICFGWTO.h"
 #include "AE/Svfexe/AEDetector.h"
+#include "AE/Svfexe/AESummary.h"
 #include "AE/Svfexe/AbsExtAPI.h"
 #include "Util/SVFBugReport.h"
 #include "Util/SVFStat.h"
@@ -98,6 +99,38 @@ public:
         }
         return generalNumMap["ICFG_Node_Trace"];
     }
+    u32_t& getWidenNum()
+    {
+        if (generalNumMap.count("Widen_Num") == 0)
+        {
+            generalNumMap["Widen_Num"] = 0;
+        }
+        return generalNumMap["Widen_Num"];
+    }
+    u32_t& getNarrowNum()
+    {
+        if (generalNumMap.count("Narrow_Num") == 0)
+        {
+            generalNumMap["Narrow_Num"] = 0;
+        }
+        return generalNumMap["Narrow_Num"];
+    }
+    u32_t& getEvictedStateNum()
+    {
+        if (generalNumMap.count("Evicted_State_Num") == 0)
+        {
+            generalNumMap["Evicted_State_Num"] = 0;
+        }
+        return generalNumMap["Evicted_State_Num"];
+    }
+    u32_t& getMaxTraceSize()
+    {
+        if (generalNumMap.count("Max_Trace_Size") == 0)
+        {
+            generalNumMap["Max_Trace_Size"] = 0;
+        }
+        return generalNumMap["Max_Trace_Size"];
+    }
 };
 
 /// AbstractInterpretation is same as Abstract Execution
@@ -133,6 +166,13 @@ public:
         WIDEN_NARROW
     };
 
+    /// Widening operator applied at cycle heads
+    enum WidenStrategy
+    {
+        STANDARD_WIDEN,  // unstable bounds go to infinity
+        THRESHOLD_WIDEN  // unstable bounds go to the nearest constant of the function first
+    };
+
     /// Constructor
     AbstractInterpretation();
 
@@ -220,6 +260,19 @@ private:
      */
     virtual void handleCycleWTO(const ICFGCycleWTO* cycle);
 
+    /**
+     * Widen the state of a cycle head with the strategy chosen by -widen-strategy
+     *
+     * @param cycleHead the head of the cycle
+     * @param prev the state of the head before the current iteration
+     * @param cur the state of the head after the current iteration
+     * @return the widened state
+     */
+    AbstractState widenCycleHead(const ICFGNode* cycleHead, const AbstractState& prev, const AbstractState& cur);
+
+    /// Widening thresholds of a function: constants compared against and sizes of the objects it allocates
+    const OrderedSet<s64_t>& getWideningThresholds(const FunObjVar* fun);
+
     void handleWTOComponents(const std::list<const ICFGWTOComp*>& wtoComps);
 
     void handleWTOComponent(const ICFGWTOComp* wtoComp);
@@ -286,6 +339,26 @@ private:
 
     void updateStateOnPhi(const PhiStmt *phi);
 
+    /**
+     * Update the zone (DBM) of the pack defined by stmt, and reduce it into intervals
+     *
+     * @param stmt SVFStatement which defines a packed integer variable
+     */
+    void updateZoneOnStmt(const SVFStmt *stmt);
+
+    /**
+     * Refine the zone of op0/op1 with the branch condition 'op0 predicate op1'
+     *
+     * @return false if the relational constraints make the branch infeasible
+     */
+    bool refineZoneOnCmp(AbstractState& as, NodeID op0, NodeID op1, s32_t predicate);
+
+    /// Get the zone of a pack, seeding a freshly created one with the current intervals
+    DBM& getZone(AbstractState& as, u32_t packId);
+
+    /// Meet the intervals of all pack members with the bounds implied by the zone
+    void reduceZone(AbstractState& as, u32_t packId);
+
 
     /// protected data members, also used in subclasses
     SVFIR* svfir;
@@ -294,11 +367,19 @@ private:
 
     ICFG* icfg;
     AEStat* stat;
+    /// Variable packs of the zone domain, only built with -zone-domain
+    ZonePacks* zonePacks{nullptr};
+    /// Function summaries, only used with -ae-summary
+    AESummaryCache* summaries{nullptr};
 
     std::vector<const CallICFGNode*> callSiteStack;
     Map<const FunObjVar*, const ICFGWTO*> funcToWTO;
+    /// Nodes whose states are evicted once a WTO is analysed, only used with -ae-evict-states
+    Map<const ICFGWTO*, std::vector<const ICFGNode*>> wtoToEvictableNodes;
     Set<std::pair<const CallICFGNode*, NodeID>> nonRecursiveCallSites;
     Set<const FunObjVar*> recursiveFuns;
+    /// Widening thresholds of each function, only used with -widen-strategy=threshold
+    Map<const FunObjVar*, OrderedSet<s64_t>> funToWideningThresholds;
 
 
     bool hasAbsStateFromTrace(const ICFGNode* node)
@@ -323,6 +404,30 @@ private:
     virtual bool isIndirectCall(const CallICFGNode* callNode);
     virtual void indirectCallFunPass(const CallICFGNode* callNode);
 
+    /**
+     * Analyse (inline) a callee at a call site, or apply its summary with -ae-summary
+     *
+     * @param callNode CallICFGNode of the call
+     * @param callee the called function
+     */
+    void handleCallee(const CallICFGNode* callNode, const FunObjVar* callee);
+
+    /// Apply the summary of callee under the state at its entry, analyse it and record a summary if there is none
+    void handleCalleeWithSummary(const FunObjVar* callee);
+
+    /**
+     * Drop the states of a fully analysed WTO that no pending component can read.
+     * States of call, return and exit nodes are kept since they are merged into
+     * callee entries and return sites, and so are the states of cycle heads.
+     *
+     * @param wto the WTO of a function partition whose analysis has just finished
+     */
+    void evictStates(const ICFGWTO* wto);
+
+    /// Collect the nodes of WTO components whose states are dead after the components are analysed
+    void collectEvictableNodes(const std::list<const ICFGWTOComp*>& wtoComps,
+                               std::vector<const ICFGNode*>& nodes) const;
+
     // there data should be shared with subclasses
     Map<std::string, std::function<void(const CallICFGNode*)>> func_map;
 
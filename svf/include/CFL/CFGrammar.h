@@ -291,6 +291,14 @@ class CFGrammar : public GrammarBase
 {
 
 public:
+    /// Productions whose body contains a symbol, compiled by compile()
+    struct CompiledProds
+    {
+        std::vector<Symbol> singleHeads;                        ///< X of each X -> sym
+        std::vector<std::pair<Symbol, Symbol>> firstRHSProds;   ///< (X, Z) of each X -> sym Z
+        std::vector<std::pair<Symbol, Symbol>> secondRHSProds;  ///< (X, Y) of each X -> Y sym
+    };
+
     CFGrammar();
 
     /// Methods for support type inquiry through isa, cast, and dyn_cast:
@@ -384,6 +392,15 @@ public:
 
     void dump(std::string fileName) const;
 
+    /// Compile the normalized productions into per-symbol lookup tables
+    void compile();
+
+    /// Compiled productions whose body contains sym, empty ones if there is none
+    inline const CompiledProds& getCompiledProds(const Symbol sym) const
+    {
+        auto it = symToCompiledProds.find(sym);
+        return it == symToCompiledProds.end() ? emptyCompiledProds : it->second;
+    }
 
     const inline u32_t num_generator()
     {
@@ -395,6 +412,8 @@ private:
     SymbolMap<Symbol, Productions> singleRHSToProds;
     SymbolMap<Symbol, Productions> firstRHSToProds;
     SymbolMap<Symbol, Productions> secondRHSToProds;
+    SymbolMap<Symbol, CompiledProds> symToCompiledProds;
+    const CompiledProds emptyCompiledProds;
     u32_t newTerminalSubscript;
 };
 
@@ -76,6 +76,9 @@ public:
     /// Get CFL graph
     CFLGraph* getCFLGraph();
 
+    /// Keys of the graph nodes for a saved closure, empty if none is loaded or saved
+    virtual CFLMatrixSolver::NodeKeys getNodeKeys() const;
+
     /// Count the num of Nonterminal Edges
     virtual void countSumEdges();
 
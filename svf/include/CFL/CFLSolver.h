@@ -33,6 +33,8 @@
 #include "Graphs/CFLGraph.h"
 #include "CFL/CFGrammar.h"
 #include "Util/WorkList.h"
+#include <deque>
+#include <mutex>
 
 using namespace std;
 
@@ -70,6 +72,11 @@ public:
     /// Start solving
     virtual void solve();
 
+    /// Called by the client once after its last solve()
+    virtual void finalize()
+    {
+    }
+
     /// Return CFL Graph
     inline const CFLGraph* getGraph() const
     {
@@ -116,70 +123,113 @@ protected:
 class POCRSolver : public CFLSolver
 {
 public:
-    typedef std::map<const Label, NodeBS> TypeMap;                  // Label with SparseBitVector of NodeID
-    typedef std::unordered_map<NodeID, TypeMap> DataMap;            // Each Node has a TypeMap
-    typedef typename DataMap::iterator iterator;                    // iterator for each node
-    typedef typename DataMap::const_iterator const_iterator;
+    /// Data are indexed first by the dense index of a label, then by the slot
+    /// of a node under that label. Slots are indexed by NodeID and only nodes
+    /// with data of a label get a bitset, so once the index of a label is known
+    /// a probe is two array accesses. Deques keep the references to the bitsets
+    /// valid while they grow.
+    struct LabelData
+    {
+        std::vector<u32_t> slots;                                   // slot + 1 of each NodeID, 0 if it has no data
+        std::deque<NodeBS> data;                                    // SparseBitVector of NodeID for each slot
+    };
+    typedef std::deque<LabelData> DataMap;                          // LabelData of each label index
 
 protected:
-    DataMap succMap;                                                // succ map for nodes contains Label: Edgeset
-    DataMap predMap;                                                // pred map for nodes contains Label: edgeset
-    const NodeBS emptyData;                                         // ??
+    Map<u32_t, u32_t> labelToIdx;                                   // dense index of each label
+    DataMap succMap;                                                // succ data of each label
+    DataMap predMap;                                                // pred data of each label
+    const NodeBS emptyData;                                         // data of a node without edges of a label
     NodeBS diff;
+
+    /// Dense index of a label, assigned at its first use
+    inline u32_t getLabelIdx(const Label ty)
+    {
+        auto it = labelToIdx.emplace(ty, succMap.size());
+        if (it.second)
+        {
+            succMap.emplace_back();
+            predMap.emplace_back();
+        }
+        return it.first->second;
+    }
+
+    /// Data of key in labelData, given a slot if it has none
+    static inline NodeBS& getData(LabelData& labelData, const NodeID key)
+    {
+        if (key >= labelData.slots.size())
+            labelData.slots.resize(key + 1, 0);
+        u32_t& slot = labelData.slots[key];
+        if (slot == 0)
+        {
+            labelData.data.emplace_back();
+            slot = labelData.data.size();
+        }
+        return labelData.data[slot - 1];
+    }
+
+    /// Data of key in labelData without creating it
+    inline const NodeBS& findData(const LabelData& labelData, const NodeID key) const
+    {
+        if (key >= labelData.slots.size() || labelData.slots[key] == 0)
+            return emptyData;
+        return labelData.data[labelData.slots[key] - 1];
+    }
+
+    /// Clear the data of key under every label
+    static inline void clearData(DataMap& dataMap, const NodeID key)
+    {
+        for (LabelData& labelData : dataMap)
+        {
+            if (key < labelData.slots.size() && labelData.slots[key] != 0)
+                labelData.data[labelData.slots[key] - 1].clear();
+        }
+    }
+
+    /// Data of key for ty without creating it
+    inline const NodeBS& findData(const DataMap& dataMap, const NodeID key, const Label ty) const
+    {
+        auto it = labelToIdx.find(ty);
+        if (it == labelToIdx.end())
+            return emptyData;
+        return findData(dataMap[it->second], key);
+    }
+
     // union/add data
     //@{
     inline bool addPred(const NodeID key, const NodeID src, const Label ty)
     {
-        return predMap[key][ty].test_and_set(src);
+        return getData(predMap[getLabelIdx(ty)], key).test_and_set(src);
     };
 
     inline bool addSucc(const NodeID key, const NodeID dst, const Label ty)
     {
-        return succMap[key][ty].test_and_set(dst);
+        return getData(succMap[getLabelIdx(ty)], key).test_and_set(dst);
     };
 
     inline bool addPreds(const NodeID key, const NodeBS& data, const Label ty)
     {
         if (data.empty())
             return false;
-        return predMap[key][ty] |= data;                            // union of sparsebitvector (add to LHS)
+        return getData(predMap[getLabelIdx(ty)], key) |= data;     // union of sparsebitvector (add to LHS)
     }
 
     inline bool addSuccs(const NodeID key, const NodeBS& data, const Label ty)
     {
         if (data.empty())
             return false;
-        return succMap[key][ty] |= data;                            // // union of sparsebitvector (add to LHS)
+        return getData(succMap[getLabelIdx(ty)], key) |= data;     // union of sparsebitvector (add to LHS)
     }
     //@}
 public:
 
     virtual void clear()
     {
+        labelToIdx.clear();
         succMap.clear();
         predMap.clear();
     }
 
-    inline const_iterator begin() const
-    {
-        return succMap.begin();
-    }
-
-    inline const_iterator end() const
-    {
-        return succMap.end();
-    }
-
-    inline iterator begin()
-    {
-        return succMap.begin();
-    }
-
-    inline iterator end()
-    {
-        return succMap.end();
-    }
-
     inline DataMap& getSuccMap()
     {
         return succMap;
@@ -190,42 +240,37 @@ public:
         return predMap;
     }
 
-    inline TypeMap& getSuccMap(const NodeID key)
-    {
-        return succMap[key];
-    }
-
-    inline TypeMap& getPredMap(const NodeID key)
-    {
-        return predMap[key];
-    }
-
-    inline NodeBS& getSuccs(const NodeID key, const Label ty)
+    inline const NodeBS& getSuccs(const NodeID key, const Label ty) const
     {
-        return succMap[key][ty];
+        return findData(succMap, key, ty);
     }
 
-    inline NodeBS& getPreds(const NodeID key, const Label ty)
+    inline const NodeBS& getPreds(const NodeID key, const Label ty) const
     {
-        return predMap[key][ty];
+        return findData(predMap, key, ty);
     }
 
     // Alias data operations
     //@{
     inline bool addEdge(const NodeID src, const NodeID dst, const Label ty)
     {
-        addSucc(src, dst, ty);
-        return addPred(dst, src, ty);
+        const u32_t idx = getLabelIdx(ty);
+        getData(succMap[idx], src).set(dst);
+        return getData(predMap[idx], dst).test_and_set(src);
     }
 
     /// add edges and return the set of added edges (dst) for src
     inline NodeBS addEdges(const NodeID src, const NodeBS& dstData, const Label ty)
     {
         NodeBS newDsts;
-        if (addSuccs(src, dstData, ty))
+        if (dstData.empty())
+            return newDsts;
+        const u32_t idx = getLabelIdx(ty);
+        if (getData(succMap[idx], src) |= dstData)
         {
+            LabelData& preds = predMap[idx];
             for (const NodeID datum: dstData)
-                if (addPred(datum, src, ty))
+                if (getData(preds, datum).test_and_set(src))
                     newDsts.set(datum);
         }
         return newDsts;
@@ -235,34 +280,30 @@ public:
     inline NodeBS addEdges(const NodeBS& srcData, const NodeID dst, const Label ty)
     {
         NodeBS newSrcs;
-        if (addPreds(dst, srcData, ty))
+        if (srcData.empty())
+            return newSrcs;
+        const u32_t idx = getLabelIdx(ty);
+        if (getData(predMap[idx], dst) |= srcData)
         {
+            LabelData& succs = succMap[idx];
             for (const NodeID datum: srcData)
-                if (addSucc(datum, dst, ty))
+                if (getData(succs, datum).test_and_set(dst))
                     newSrcs.set(datum);
         }
         return newSrcs;
     }
 
-    /// find src -> find src[ty] -> find dst in set
-    inline bool hasEdge(const NodeID src, const NodeID dst, const Label ty)
+    /// find src[ty] -> find dst in set
+    inline bool hasEdge(const NodeID src, const NodeID dst, const Label ty) const
     {
-        const_iterator iter1 = succMap.find(src);
-        if (iter1 == succMap.end())
-            return false;
-
-        auto iter2 = iter1->second.find(ty);
-        if (iter2 == iter1->second.end())
-            return false;
-
-        return iter2->second.test(dst);
+        return getSuccs(src, ty).test(dst);
     }
 
     /* This is a dataset version, to be modified to a cflData version */
     inline void clearEdges(const NodeID key)
     {
-        succMap[key].clear();
-        predMap[key].clear();
+        clearData(succMap, key);
+        clearData(predMap, key);
     }
     //@}
 
@@ -344,8 +385,14 @@ public:
     void meld_h(NodeID x, TreeNode* uNode, TreeNode* vNode);
 //@}
 public:
-    POCRHybridSolver(CFLGraph* _graph, CFGrammar* _grammar) : POCRSolver(_graph, _grammar)
+    POCRHybridSolver(CFLGraph* _graph, CFGrammar* _grammar) : POCRSolver(_graph, _grammar), hasTransitiveSym(false)
     {
+        auto it = grammar->getNonterminals().find("F");
+        if (it != grammar->getNonterminals().end())
+        {
+            transitiveSym = grammar->strToSymbol("F");
+            hasTransitiveSym = true;
+        }
     }
     /// Destructor
     virtual ~POCRHybridSolver()
@@ -368,6 +415,166 @@ public:
 public:
     void addArc(NodeID src, NodeID dst);
     void meld(NodeID x, TreeNode* uNode, TreeNode* vNode);
+
+protected:
+    /// Whether X -> Y Z is F -> F F, solved by the hybrid representation
+    inline bool isTransitiveProd(const Symbol& X, const Symbol& Y, const Symbol& Z) const
+    {
+        return hasTransitiveSym && X == transitiveSym && Y == transitiveSym && Z == transitiveSym;
+    }
+
+    Symbol transitiveSym;   ///< Symbol of F
+    bool hasTransitiveSym;  ///< Whether the grammar has F
+};
+
+/*!
+ * Solver over per-label adjacency matrices
+ * Each label keeps its matrix as sparse bit-vector rows (successors) and columns
+ * (predecessors), and productions are applied to whole rows so that one union
+ * joins a word of nodes at a time. Solving is semi-naive: a round only composes
+ * the edges found in the previous round (the delta) with the full matrices, and
+ * the new edges of a round are copied into the CFL graph for the clients.
+ *
+ * Rows and columns are sharded by node ID (node n lives in shard n % shardNum),
+ * one shard per thread. A round first composes the delta of every shard into
+ * thread-local candidates, then every thread adds the candidate rows of its own
+ * shard and finally the columns of its own shard, so no shard is written by two
+ * threads.
+ *
+ * The closure can be saved together with its base edges (the graph edges and
+ * the epsilon edges it was solved from) and loaded into a later run. The first
+ * solve() after a load then updates the closure to the base edges of the new
+ * graph: the derivations of removed base edges are over-deleted, the deleted
+ * edges that still have a derivation in one step are rederived (DRed), and the
+ * rederived and added edges are propagated by the usual rounds.
+ *
+ * The file keeps a key of each node, e.g. the kind, function, name and source
+ * location of its variable, so the saved nodes are mapped to the nodes of a
+ * graph built from a changed program whose IDs shifted. A node whose key is
+ * not unique in either graph is not mapped and is given an ID outside the
+ * graph instead; its base edges are then removed ones and everything derived
+ * from them is deleted by the update. Any one-to-one mapping gives the same
+ * closure, the keys only decide how much of the saved one is reused. Without
+ * keys (e.g. a graph read with -cfl-graph) a node is keyed by its ID. The file
+ * also keeps a hash of the normalized productions and is rejected if the
+ * grammar differs.
+ */
+class CFLMatrixSolver : public CFLSolver
+{
+public:
+    typedef Map<NodeID, NodeBS> Matrix;             ///< Non-empty rows of a shard
+    typedef std::vector<Matrix> ShardedMatrix;      ///< Shards of a matrix
+    typedef Map<u32_t, ShardedMatrix> LabelToMatrix;///< Matrix of each label
+    typedef Map<NodeID, std::string> NodeKeys;      ///< Key of each node in a saved closure
+
+    CFLMatrixSolver(CFLGraph* _graph, CFGrammar* _grammar, const NodeKeys& keys = NodeKeys());
+    /// Destructor
+    virtual ~CFLMatrixSolver()
+    {
+    }
+
+    /// Load the graph edges not yet in the matrices into the delta
+    virtual void initialize();
+
+    /// Iterate rounds until the delta is empty, incrementally if a closure is loaded
+    virtual void solve();
+
+    /// Save the closure if Options::CFLClosureOut() is set
+    virtual void finalize();
+
+    /// Write the closure and its base edges to fileName
+    void saveClosure(const std::string& fileName) const;
+
+    /// Read a closure written by saveClosure, the next solve() updates it to the graph.
+    /// Return false and keep the solver unchanged if the file does not fit the grammar and graph
+    bool loadClosure(const std::string& fileName);
+
+    /// Whether the options ask clients to use this solver
+    static bool isRequested();
+
+    /// Whether the matrix of ty has (src,dst)
+    inline bool hasEdge(const NodeID src, const NodeID dst, const Label ty) const
+    {
+        auto it = succMatrices.find(ty);
+        if (it == succMatrices.end())
+            return false;
+        const Matrix& rows = it->second[getShard(src)];
+        auto rowIt = rows.find(src);
+        return rowIt != rows.end() && rowIt->second.test(dst);
+    }
+
+    /// Number of rounds of all solve() calls
+    inline u32_t getNumOfRounds() const
+    {
+        return numOfRounds;
+    }
+
+protected:
+    /// Edge (src,dst) of a label whose column dst is yet to be updated
+    struct ColumnUpdate
+    {
+        u32_t label;
+        NodeID src;
+        NodeID dst;
+    };
+    typedef std::vector<ColumnUpdate> ColumnUpdates;
+
+    inline u32_t getShard(NodeID id) const
+    {
+        return id % shardNum;
+    }
+
+    /// Matrix of ty in labelToMatrix, created with all its shards if absent
+    inline ShardedMatrix& getMatrix(LabelToMatrix& labelToMatrix, u32_t ty)
+    {
+        ShardedMatrix& matrix = labelToMatrix[ty];
+        if (matrix.empty())
+            matrix.resize(shardNum);
+        return matrix;
+    }
+
+    /// Compose the delta rows of a shard with the matrices into candidates (read-only on the solver)
+    void processDelta(u32_t shard, LabelToMatrix& candidates);
+
+    /// Add the candidate rows of a shard that are new, return their columns to update by the shard of dst
+    bool addRows(u32_t shard, const std::vector<LabelToMatrix>& candidates, std::vector<ColumnUpdates>& updates);
+
+    /// Add the edges (src,dsts) of ty that are not in the matrices, return the added ones in newDsts
+    bool addEdges(const u32_t ty, const NodeID src, const NodeBS& dsts, NodeBS& newDsts);
+
+    /// Iterate rounds from the current delta until no edge is added
+    void runRounds();
+
+    /// Base edges of the graph and of the epsilon productions on its nodes
+    void collectBaseEdges(Map<u32_t, Matrix>& edges);
+
+    /// Update the loaded closure to the base edges of the graph
+    void solveIncrementally();
+
+    /// Whether (src,dst) of ty follows in one step from the edges in the matrices
+    bool isDerivable(const u32_t ty, const NodeID src, const NodeID dst) const;
+
+    /// Key of a node in the closure file, on one line
+    std::string getNodeKey(const NodeID id) const;
+
+    /// Hash of the normalized productions and the names of their symbols
+    std::string getGrammarHash() const;
+
+    /// Bodies of the productions of each head, used to rederive edges
+    //@{
+    Map<u32_t, std::vector<Symbol>> headToSingleBodies;
+    Map<u32_t, std::vector<std::pair<Symbol, Symbol>>> headToBinaryBodies;
+    //@}
+
+    LabelToMatrix succMatrices;     ///< Rows of each label
+    LabelToMatrix predMatrices;     ///< Columns of each label
+    LabelToMatrix delta;            ///< Rows found in the last round
+    Map<u32_t, Matrix> baseEdges;   ///< Edges the closure is solved from
+    NodeKeys nodeKeys;              ///< Keys of the nodes in the closure file, IDs are used if empty
+    bool closureLoaded;             ///< Whether the next solve() is incremental
+    u32_t shardNum;                 ///< Number of shards and threads
+    u32_t numOfRounds;
+    std::mutex checksMutex;
 };
 }
 
@@ -58,6 +58,9 @@ public:
     /// Build CFLGraph via VFG
     void buildCFLGraph();
 
+    /// Keys of the SVFG nodes for a saved closure
+    virtual CFLMatrixSolver::NodeKeys getNodeKeys() const;
+
 private:
     CFLSVFGBuilder memSSA;
     SVFG* svfg;
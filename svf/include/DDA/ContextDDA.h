@@ -64,6 +64,12 @@ public:
     /// Initialization of the analysis
     virtual void initialize() override;
 
+    /// Query server: also share the lock and the SVFG with the FlowDDA of out-of-budget queries
+    //@{
+    virtual void setSharedGraphMutex(std::mutex* m) override;
+    virtual void setSharedSVFG(SVFG* svfg) override;
+    //@}
+
     /// Finalize analysis
     virtual inline void finalize() override
     {
@@ -133,6 +139,7 @@ public:
     /// Whether call/return inside recursion
     inline virtual bool isEdgeInRecursion(CallSiteID csId)
     {
+        std::unique_lock<std::mutex> lock = lockSharedGraphs();
         const FunObjVar* caller = getCallGraph()->getCallerOfCallSite(csId);
         const FunObjVar* callee = getCallGraph()->getCalleeOfCallSite(csId);
         return inSameCallGraphSCC(caller, callee);
@@ -141,18 +148,10 @@ public:
     //@{
     virtual void updateCallGraphAndSVFG(const CxtLocDPItem& dpm,const CallICFGNode* cs,SVFGEdgeSet& svfgEdges) override
     {
+        std::unique_lock<std::mutex> lock = lockSharedGraphs();
         CallEdgeMap newEdges;
         resolveIndCalls(cs, getBVPointsTo(getCachedPointsTo(dpm)), newEdges);
-        for (CallEdgeMap::const_iterator iter = newEdges.begin(),eiter = newEdges.end(); iter != eiter; iter++)
-        {
-            const CallICFGNode* newcs = iter->first;
-            const FunctionSet & functions = iter->second;
-            for (FunctionSet::const_iterator func_iter = functions.begin(); func_iter != functions.end(); func_iter++)
-            {
-                const FunObjVar*  func = *func_iter;
-                getSVFG()->connectCallerAndCallee(newcs, func, svfgEdges);
-            }
-        }
+        connectIndCallEdges(newEdges, svfgEdges);
     }
     //@}
 
@@ -178,8 +177,11 @@ public:
     {
         NodeID srcID = addr->getPAGSrcNodeID();
         /// whether this object is set field-insensitive during pre-analysis
-        if (isFieldInsensitive(srcID))
-            srcID = getFIObjVar(srcID);
+        {
+            std::unique_lock<std::mutex> lock = lockSharedGraphs();
+            if (isFieldInsensitive(srcID))
+                srcID = getFIObjVar(srcID);
+        }
 
         CxtVar var(dpm.getCond(),srcID);
         addDDAPts(pts,var);
@@ -98,6 +98,11 @@ public:
 
     virtual inline void collectWPANum() {}
 protected:
+    /// Set the trial budget of the solver behind pta (adaptive budgets)
+    void setTrialBudget(PointerAnalysis* pta, u32_t budget);
+    /// Whether the last query of the solver behind pta ran out of budget
+    bool isOutOfBudgetQuery(PointerAnalysis* pta) const;
+
     void addCandidate(NodeID id)
     {
         if (pag->isValidTopLevelPtr(pag->getGNode(id)))
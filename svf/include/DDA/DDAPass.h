@@ -35,6 +35,8 @@
 #include "DDA/DDAClient.h"
 #include "Graphs/SCC.h"
 #include "MemoryModel/PointerAnalysisImpl.h"
+#include <mutex>
+#include <tuple>
 
 namespace SVF
 {
@@ -71,6 +73,10 @@ public:
     /// Select a client
     virtual void selectClient();
 
+    /// Query server (-dda-server): answer the points-to/alias requests read from in,
+    /// one per line, on a pool of worker threads sharing the loaded program
+    virtual void serveQueries(SVFIR* pag, std::istream& in, std::ostream& out);
+
     /// Pass name
     virtual inline std::string getPassName() const
     {
@@ -82,6 +88,30 @@ private:
     void printQueryPTS();
     /// Create pointer analysis according to specified kind and analyze the module.
     void runPointerAnalysis(SVFIR* module, u32_t kind);
+    /// Create a demand-driven pointer analysis of the given kind
+    PointerAnalysis* createDDA(SVFIR* pag, u32_t kind, DDAClient* client);
+    /// Answer one server request with a worker's own solver, return true if it ran out of budget
+    bool answerRequest(PointerAnalysis* pta, const std::string& request, std::string& response);
+    /// Initialise a solver of the query server, sharing the graphs under sharedGraphMutex if not null
+    /// and reading sharedSVFG instead of building its own SVFG if not null
+    void initServerSolver(PointerAnalysis* pta, std::mutex* sharedGraphMutex, SVFG* sharedSVFG);
+    /// Compare the answers of the query server with those of a single solver (-dda-server-check)
+    void checkAnswers(SVFIR* pag, u32_t kind, std::vector<std::tuple<u32_t, std::string, std::string>>& answers,
+                      std::ostream& out);
+    /// Mark the context-insensitive call/ret edges of a ContextDDA (-in-recur/-in-cycle),
+    /// reading them from Options::DDAInsenEdgeFile if it holds the edges of the same SVFG
+    void setupCxtInsensitiveEdges(PointerAnalysis* pta, SVFG* svfg, SVFGEdgeSet& insensitveEdges);
+    /// Read/write context-insensitive edges, identified by <src key, dst key, edge flag>
+    //@{
+    bool readCxtInsensitiveEdges(const std::string& fileName, const SVFG* svfg, SVFGEdgeSet& insensitveEdges);
+    void writeCxtInsensitiveEdges(const std::string& fileName, const SVFG* svfg, const SVFGEdgeSet& insensitveEdges);
+    //@}
+    /// Key of an SVFG node built from what it stands for (kind, ICFG node, SVFIR variables or
+    /// memory region), as node IDs are not stable across runs of the same program
+    static u64_t getSVFGNodeKey(const SVFGNode* node);
+    /// Hash of the node keys and edges of the SVFG, written with the context-insensitive
+    /// edges so that those of another SVFG are rejected
+    static u64_t fingerprintSVFG(const SVFG* svfg);
     /// Context insensitive Edge for DDA
     void initCxtInsensitiveEdges(PointerAnalysis* pta, const SVFG* svfg,const SVFGSCC* svfgSCC, SVFGEdgeSet& insensitveEdges);
     /// Return TRUE if this edge is inside a SVFG SCC, i.e., src node and dst node are in the same SCC on the SVFG.
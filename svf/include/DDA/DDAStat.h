@@ -65,6 +65,40 @@ public:
 
     NodeBS _StrongUpdateStores;
 
+    /// Reuse of resolved DPItems across queries
+    //@{
+    u64_t _NumOfPTLookups;
+    u64_t _NumOfCrossQueryHits;
+    u32_t _NumOfStaleInvalidations;
+    u32_t _NumOfRequeries;
+    u32_t _NumOfEvictedDPMs;
+    //@}
+
+    /// Adaptive budgets, queries re-run with the full budget and those of them resolved
+    //@{
+    u32_t _NumOfEscalatedQueries;
+    u32_t _NumOfResolvedEscalations;
+    //@}
+
+    /// Telemetry of one query, written by dumpQueryReport (Options::DDAQueryReport)
+    struct QueryRecord
+    {
+        NodeID ptr;
+        u64_t budget;
+        u64_t steps;
+        double time;
+        u32_t numOfDPM;
+        u32_t vmrss;
+        u32_t ptsSize;
+        bool outOfBudget;
+    };
+
+    /// Record the telemetry of the query of ptr that has just finished
+    void recordQuery(NodeID ptr, bool outOfBudget, u32_t ptsSize);
+
+    /// Write the recorded queries as CSV
+    void dumpQueryReport(const std::string& fileName) const;
+
     void performStatPerQuery(NodeID ptr) override;
 
     void performStat() override;
@@ -103,6 +137,8 @@ private:
 
     NUMStatMap NumPerQueryStatMap;
 
+    std::vector<QueryRecord> queryRecords;
+
     void initDefault();
 
 public:
@@ -35,7 +35,10 @@
 #include "MSSA/SVFGBuilder.h"
 #include "MemoryModel/PointsTo.h"
 #include "WPA/Andersen.h"
+#include "Util/Options.h"
 #include <algorithm>
+#include <deque>
+#include <mutex>
 
 namespace SVF
 {
@@ -62,7 +65,7 @@ public:
     typedef OrderedMap<const SVFGNode*, DPTItemSet> StoreToPMSetMap;
 
     ///Constructor
-    DDAVFSolver(): outOfBudgetQuery(false),_pag(nullptr),_svfg(nullptr),_ander(nullptr),_callGraph(nullptr), _callGraphSCC(nullptr), _svfgSCC(nullptr), ddaStat(nullptr)
+    DDAVFSolver(): outOfBudgetQuery(false),trialBudget(0),svfgUpdatedInQuery(false),crossQueryHitInQuery(false),_pag(nullptr),_svfg(nullptr),_ander(nullptr),_callGraph(nullptr), _callGraphSCC(nullptr), _svfgSCC(nullptr), ddaStat(nullptr), sharedGraphMutex(nullptr), sharedSVFG(false)
     {
     }
     /// Destructor
@@ -87,6 +90,24 @@ public:
         _callGraph = nullptr;
         _callGraphSCC = nullptr;
     }
+    /// Whether the last query has run out of its budget
+    inline bool isOutOfBudgetQuery() const
+    {
+        return outOfBudgetQuery;
+    }
+    /// Adaptive budgets (Options::DDATrialBudget)
+    /// A non-zero trial budget replaces the step budget of the analysis, and a query exceeding it
+    /// is left unresolved instead of falling back to a coarser analysis, to be re-run later
+    //@{
+    inline void setTrialBudget(u32_t budget)
+    {
+        trialBudget = budget;
+    }
+    inline u32_t getTrialBudget() const
+    {
+        return trialBudget;
+    }
+    //@}
     /// Return candidate pointers for DDA
     inline NodeBS& getCandidateQueries()
     {
@@ -138,8 +159,14 @@ public:
     virtual const CPtSet& findPT(const DPIm& dpm)
     {
 
+        DOSTAT(ddaStat->_NumOfPTLookups++);
         if(isbkVisited(dpm))
         {
+            if(!isVisitedInCurQuery(dpm))
+            {
+                DOSTAT(ddaStat->_NumOfCrossQueryHits++);
+                crossQueryHitInQuery = true;
+            }
             const CPtSet& cpts = getCachedPointsTo(dpm);
             DBOUT(DDDA, SVFUtil::outs() << "\t already backward visited dpm: ");
             DBOUT(DDDA, dpm.dump());
@@ -152,6 +179,8 @@ public:
         DBOUT(DDDA, dpm.dump());
         markbkVisited(dpm);
         addDpmToLoc(dpm);
+        if(Options::DDABatchQueries())
+            resolvedDpms.push_back(dpm);
 
         if(testOutOfBudget(dpm) == false)
         {
@@ -165,6 +194,21 @@ public:
         return getCachedPointsTo(dpm);
     }
 
+    /// Query server: solvers answering queries on different threads share the SVFIR and the
+    /// call site IDs of the call graphs, which they only update under this lock
+    virtual void setSharedGraphMutex(std::mutex* m)
+    {
+        sharedGraphMutex = m;
+    }
+    /// Query server: use an SVFG built once for all solvers instead of building one in initialize().
+    /// Its indirect calls are connected along Andersen's call graph and it is only read, the
+    /// call/ret edges of indirect calls this solver has not resolved are skipped instead.
+    virtual void setSharedSVFG(SVFG* svfg)
+    {
+        _svfg = svfg;
+        sharedSVFG = true;
+    }
+
 protected:
     /// Handle single statement
     virtual void handleSingleStatement(const DPIm& dpm, CPtSet& pts)
@@ -264,7 +308,10 @@ protected:
         }
         /// callgraph scc detection for local variable in recursion
         if(!newIndirectEdges.empty())
+        {
             _callGraphSCC->find();
+            svfgUpdatedInQuery = true;
+        }
         reComputeForEdges(dpm,newIndirectEdges,true);
 
         /// re-compute for transitive closures
@@ -317,7 +364,8 @@ protected:
     virtual inline void buildSVFG(SVFIR* pag)
     {
         _ander = AndersenWaveDiff::createAndersenWaveDiff(pag);
-        _svfg = svfgBuilder.buildPTROnlySVFG(_ander);
+        if (!sharedSVFG)
+            _svfg = svfgBuilder.buildPTROnlySVFG(_ander);
         _pag = _svfg->getPAG();
     }
     /// Reset visited map for next points-to query
@@ -330,8 +378,70 @@ protected:
         dpmToloadDpmMap.clear();
         loadToPTCVarMap.clear();
         outOfBudgetQuery = false;
+        svfgUpdatedInQuery = false;
+        crossQueryHitInQuery = false;
         ddaStat->_NumOfStep = 0;
     }
+    /// Whether dpm has been resolved by the current query rather than by an earlier one
+    inline bool isVisitedInCurQuery(const DPIm& dpm) const
+    {
+        typename LocToDPMVecMap::const_iterator it = locToDpmSetMap.find(dpm.getLoc()->getId());
+        return it != locToDpmSetMap.end() && it->second.find(dpm) != it->second.end();
+    }
+    /// Batch mode (Options::DDABatchQueries)
+    /// Resolved dpms are reused by later queries. Indirect call edges found by a query add
+    /// value-flows that the dpms resolved by earlier queries have not seen, so those dpms
+    /// are resolved again when they are next met. Return true if the current query itself
+    /// has reused such dpms, in which case it has to be recomputed.
+    //@{
+    bool invalidateStaleDpms()
+    {
+        if(!Options::DDABatchQueries() || !svfgUpdatedInQuery)
+            return false;
+        bool requery = crossQueryHitInQuery;
+        DPTItemSet staleDpms;
+        for(const DPIm& dpm : backwardVisited)
+        {
+            if(isOutOfBudgetDpm(dpm) == false && (requery || isVisitedInCurQuery(dpm) == false))
+                staleDpms.insert(dpm);
+        }
+        for(const DPIm& dpm : staleDpms)
+            clearbkVisited(dpm);
+        DOSTAT(ddaStat->_NumOfStaleInvalidations++);
+        if(requery)
+            DOSTAT(ddaStat->_NumOfRequeries++);
+        svfgUpdatedInQuery = false;
+        return requery;
+    }
+    /// Keep at most Options::DDAQueryCacheSize() dpms resolved across queries, the earliest resolved ones are dropped first
+    void evictResolvedDpms()
+    {
+        const u32_t limit = Options::DDAQueryCacheSize();
+        if(!Options::DDABatchQueries() || limit == 0)
+            return;
+        while(backwardVisited.size() > limit && !resolvedDpms.empty())
+        {
+            DPIm dpm = resolvedDpms.front();
+            resolvedDpms.pop_front();
+            if(isbkVisited(dpm) == false || isOutOfBudgetDpm(dpm))
+                continue;
+            clearbkVisited(dpm);
+            dpmToTLCPtSetMap.erase(dpm);
+            dpmToADCPtSetMap.erase(dpm);
+            DOSTAT(ddaStat->_NumOfEvictedDPMs++);
+        }
+        /// drop entries of dpms resolved more than once or no longer resolved
+        if(resolvedDpms.size() > 2 * backwardVisited.size())
+        {
+            DPTItemSet kept;
+            std::deque<DPIm> compacted;
+            for(const DPIm& dpm : resolvedDpms)
+                if(isbkVisited(dpm) && kept.insert(dpm).second)
+                    compacted.push_back(dpm);
+            resolvedDpms.swap(compacted);
+        }
+    }
+    //@}
     /// Reset visited map if the current query is out-of-budget
     inline void OOBResetVisited()
     {
@@ -425,6 +535,8 @@ protected:
     /// dpm transit during backward tracing
     virtual void backwardPropDpm(CPtSet& pts, NodeID ptr,const DPIm& oldDpm,const SVFGEdge* edge)
     {
+        if (isUnresolvedIndCallEdge(edge))
+            return;
         DPIm dpm(oldDpm);
         dpm.setLocVar(edge->getSrcNode(),ptr);
         DOTIMESTAT(double start = DDAStat::getClk(true));
@@ -633,6 +745,54 @@ protected:
     {
         _callGraphSCC = scc;
     }
+    /// Lock the graphs shared with solvers on other threads, if any
+    inline std::unique_lock<std::mutex> lockSharedGraphs() const
+    {
+        return sharedGraphMutex ? std::unique_lock<std::mutex>(*sharedGraphMutex) : std::unique_lock<std::mutex>();
+    }
+    /// Add the SVFG edges of newly resolved indirect calls, or collect them if the SVFG is shared.
+    /// Called under lockSharedGraphs().
+    void connectIndCallEdges(const PointerAnalysis::CallEdgeMap& newEdges, SVFGEdgeSet& svfgEdges)
+    {
+        for (const auto& item : newEdges)
+        {
+            for (const FunObjVar* callee : item.second)
+            {
+                if (sharedSVFG)
+                {
+                    assert(_ander->getCallGraph()->hasIndCSCallees(item.first) &&
+                           _ander->getCallGraph()->getIndCSCallees(item.first).count(callee) &&
+                           "callee not resolved by Andersen's analysis, missing on the shared SVFG");
+                    getSVFG()->getInterVFEdgesForIndirectCallSite(item.first, callee, svfgEdges);
+                }
+                else
+                    getSVFG()->connectCallerAndCallee(item.first, callee, svfgEdges);
+            }
+        }
+    }
+    /// Whether an edge of the shared SVFG is a call/ret edge of an indirect call not resolved by this solver
+    bool isUnresolvedIndCallEdge(const SVFGEdge* edge) const
+    {
+        if (!sharedSVFG)
+            return false;
+        CallSiteID csId = 0;
+        if (const CallDirSVFGEdge* callEdge = SVFUtil::dyn_cast<CallDirSVFGEdge>(edge))
+            csId = callEdge->getCallSiteId();
+        else if (const RetDirSVFGEdge* retEdge = SVFUtil::dyn_cast<RetDirSVFGEdge>(edge))
+            csId = retEdge->getCallSiteId();
+        else if (const CallIndSVFGEdge* callIndEdge = SVFUtil::dyn_cast<CallIndSVFGEdge>(edge))
+            csId = callIndEdge->getCallSiteId();
+        else if (const RetIndSVFGEdge* retIndEdge = SVFUtil::dyn_cast<RetIndSVFGEdge>(edge))
+            csId = retIndEdge->getCallSiteId();
+        else
+            return false;
+
+        std::unique_lock<std::mutex> lock = lockSharedGraphs();
+        const CallGraph::CallSitePair& cs = _callGraph->getCallSitePair(csId);
+        if (!_pag->isIndirectCallSites(cs.first))
+            return false;
+        return !_callGraph->hasIndCSCallees(cs.first) || _callGraph->getIndCSCallees(cs.first).count(cs.second) == 0;
+    }
     /// Check heap and array object
     //@{
     virtual inline bool isHeapCondMemObj(const CVar& var, const StoreSVFGNode*)
@@ -649,6 +809,7 @@ protected:
     }
     inline bool isFieldInsenCondMemObj(const CVar& var) const
     {
+        std::unique_lock<std::mutex> lock = lockSharedGraphs();
         const BaseObjVar* baseObj = _pag->getBaseObject(getPtrNodeID(var));
         return baseObj->isFieldInsensitive();
     }
@@ -728,10 +889,6 @@ protected:
             outOfBudgetQuery = true;
         return isOutOfBudgetDpm(dpm) || outOfBudgetQuery;
     }
-    inline bool isOutOfBudgetQuery() const
-    {
-        return outOfBudgetQuery;
-    }
     inline void addOutOfBudgetDpm(const DPIm& dpm)
     {
         outOfBudgetDpms.insert(dpm);
@@ -770,6 +927,10 @@ protected:
     }
 
     bool outOfBudgetQuery;			///< Whether the current query is out of step limits
+    u32_t trialBudget;				///< Step budget of trial queries, 0 if disabled
+    bool svfgUpdatedInQuery;		///< Whether the current query has added indirect call edges to the SVFG
+    bool crossQueryHitInQuery;		///< Whether the current query has reused dpms resolved by earlier queries
+    std::deque<DPIm> resolvedDpms;	///< dpms in the order they are resolved, in batch mode
     SVFIR* _pag;						///< SVFIR
     SVFG* _svfg;					///< SVFG
     AndersenWaveDiff* _ander;		///< Andersen's analysis
@@ -787,6 +948,8 @@ protected:
     StoreToPMSetMap storeToDPMs;	///< map store to set of DPM which have been stong updated there
     DDAStat* ddaStat;				///< DDA stat
     SVFGBuilder svfgBuilder;			///< SVFG Builder
+    std::mutex* sharedGraphMutex;	///< Lock of the graphs shared with solvers on other threads, if any
+    bool sharedSVFG;				///< Whether _svfg is shared with solvers on other threads (setSharedSVFG)
 };
 
 } // End namespace SVF
@@ -120,8 +120,11 @@ public:
     {
         NodeID srcID = addr->getPAGSrcNodeID();
         /// whether this object is set field-insensitive during pre-analysis
-        if (isFieldInsensitive(srcID))
-            srcID = getFIObjVar(srcID);
+        {
+            std::unique_lock<std::mutex> lock = lockSharedGraphs();
+            if (isFieldInsensitive(srcID))
+                srcID = getFIObjVar(srcID);
+        }
 
         addDDAPts(pts,srcID);
         DBOUT(DDDA, SVFUtil::outs() << "\t add points-to target " << srcID << " to dpm ");
@@ -134,18 +137,10 @@ public:
     //@{
     virtual void updateCallGraphAndSVFG(const LocDPItem& dpm,const CallICFGNode* cs,SVFGEdgeSet& svfgEdges) override
     {
+        std::unique_lock<std::mutex> lock = lockSharedGraphs();
         CallEdgeMap newEdges;
         resolveIndCalls(cs, getCachedPointsTo(dpm), newEdges);
-        for (CallEdgeMap::const_iterator iter = newEdges.begin(),eiter = newEdges.end(); iter != eiter; iter++)
-        {
-            const CallICFGNode* newcs = iter->first;
-            const FunctionSet & functions = iter->second;
-            for (FunctionSet::const_iterator func_iter = functions.begin(); func_iter != functions.end(); func_iter++)
-            {
-                const FunObjVar* func = *func_iter;
-                getSVFG()->connectCallerAndCallee(newcs, func, svfgEdges);
-            }
-        }
+        connectIndCallEdges(newEdges, svfgEdges);
     }
     //@}
 
@@ -82,70 +82,53 @@ public:
 
     ~CFLNode() override = default;
 
-    /// Different Kind(label) associated edges set
-    typedef std::map <GrammarBase::Symbol, CFLEdge::CFLEdgeSetTy> CFLEdgeDataTy;
+    /// Edges of one label. The edge sets of a node are ordered by (label, src, dst),
+    /// so the edges of a label are a contiguous range of them.
+    typedef iter_range<CFLEdge::CFLEdgeSetTy::const_iterator> CFLEdgeRange;
 
 private:
-    CFLEdgeDataTy inCFLEdges;
-    CFLEdgeDataTy outCFLEdges;
-
-public:
-    inline const CFLEdge::CFLEdgeSetTy& getInEdgeWithTy(GrammarBase::Symbol s)
+    /// Node of the smallest ID, the src/dst of the edges bounding a label's range
+    static inline CFLNode* getMinNode()
     {
-        return inCFLEdges[s];
+        static CFLNode minNode(0);
+        return &minNode;
     }
 
-    inline const CFLEdge::CFLEdgeSetTy& getOutEdgeWithTy(GrammarBase::Symbol s)
+public:
+    inline CFLEdgeRange getInEdgeWithTy(GrammarBase::Symbol s) const
     {
-        return outCFLEdges[s];
+        CFLNode* self = const_cast<CFLNode*>(this);
+        const CFLEdge first(getMinNode(), self, u32_t(s)), last(getMinNode(), self, u64_t(u32_t(s)) + 1);
+        return make_range(getInEdges().lower_bound(const_cast<CFLEdge*>(&first)), getInEdges().lower_bound(const_cast<CFLEdge*>(&last)));
     }
 
-    inline bool addInEdgeWithKind(CFLEdge* inEdge, GrammarBase::Symbol s)
+    inline CFLEdgeRange getOutEdgeWithTy(GrammarBase::Symbol s) const
     {
-        assert(inEdge->getDstID() == this->getId());
-        bool added1 = GenericNode::addIncomingEdge(inEdge);
-        bool added2 = inCFLEdges[s].insert(inEdge).second;
-
-        return added1 && added2;
+        CFLNode* self = const_cast<CFLNode*>(this);
+        const CFLEdge first(self, getMinNode(), u32_t(s)), last(self, getMinNode(), u64_t(u32_t(s)) + 1);
+        return make_range(getOutEdges().lower_bound(const_cast<CFLEdge*>(&first)), getOutEdges().lower_bound(const_cast<CFLEdge*>(&last)));
     }
 
     inline bool addIngoingEdge(CFLEdge* inEdge)
     {
-        return addInEdgeWithKind(inEdge, inEdge->getEdgeKind());
+        assert(inEdge->getDstID() == this->getId());
+        return GenericNode::addIncomingEdge(inEdge);
     }
 
-    inline bool addOutEdgeWithKind(CFLEdge* outEdge, GrammarBase::Symbol s)
+    inline bool addOutgoingEdge(CFLEdge* outEdge)
     {
         assert(outEdge->getSrcID() == this->getId());
-        bool added1 = GenericNode::addOutgoingEdge(outEdge);
-        bool added2 = outCFLEdges[s].insert(outEdge).second;
-
-        return added1 && added2;
-    }
-
-    inline bool addOutgoingEdge(CFLEdge* OutEdge)
-    {
-        return addOutEdgeWithKind(OutEdge, OutEdge->getEdgeKind());
+        return GenericNode::addOutgoingEdge(outEdge);
     }
 
     inline bool removeCFLInEdge(CFLEdge* inEdge)
     {
-        u32_t num1 = removeIncomingEdge(inEdge);
-
-        GrammarBase::Symbol s = inEdge->getEdgeKind();
-        u32_t num2 = inCFLEdges[s].erase(inEdge);
-
-        return num1 && num2;
+        return removeIncomingEdge(inEdge);
     }
 
     inline bool removeCFLOutEdge(CFLEdge* outEdge)
     {
-        u32_t num1 = removeOutgoingEdge(outEdge);
-
-        GrammarBase::Symbol s = outEdge->getEdgeKind();
-        u32_t num2 = outCFLEdges[s].erase(outEdge);
-
-        return num1 && num2;
+        return removeOutgoingEdge(outEdge);
     }
 
     /// Methods for support type inquiry through isa, cast, and dyn_cast:
@@ -195,13 +178,97 @@ public:
 
     void view();
 
-    inline const CFLEdgeSet& getCFLEdges() const
+    /// Iterator over the edges of the graph, i.e., the out edges of each node
+    class CFLEdgeIterator
     {
-        return cflEdgeSet;
-    }
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef CFLEdge* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef CFLEdge* const* pointer;
+        typedef CFLEdge* const& reference;
+
+        CFLEdgeIterator(const_iterator node, const_iterator nodeEnd) : nodeIt(node), nodeEnd(nodeEnd)
+        {
+            skipEmptyNodes();
+        }
+
+        inline reference operator*() const
+        {
+            return *edgeIt;
+        }
+
+        inline CFLEdgeIterator& operator++()
+        {
+            if (++edgeIt == nodeIt->second->getOutEdges().end())
+            {
+                ++nodeIt;
+                skipEmptyNodes();
+            }
+            return *this;
+        }
+
+        inline CFLEdgeIterator operator++(int)
+        {
+            CFLEdgeIterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        inline bool operator==(const CFLEdgeIterator& rhs) const
+        {
+            return nodeIt == rhs.nodeIt && (nodeIt == nodeEnd || edgeIt == rhs.edgeIt);
+        }
+
+        inline bool operator!=(const CFLEdgeIterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        inline void skipEmptyNodes()
+        {
+            while (nodeIt != nodeEnd && nodeIt->second->getOutEdges().empty())
+                ++nodeIt;
+            if (nodeIt != nodeEnd)
+                edgeIt = nodeIt->second->getOutEdges().begin();
+        }
+
+        const_iterator nodeIt;
+        const_iterator nodeEnd;
+        CFLEdge::CFLEdgeSetTy::const_iterator edgeIt;
+    };
+
+    /// Edges of the graph. An edge is only kept in the edge sets of its src and dst,
+    /// the range walks the out edges of each node.
+    class CFLEdgeRange
+    {
+    public:
+        CFLEdgeRange(const CFLGraph* g) : graph(g) {}
 
-private:
-    CFLEdgeSet cflEdgeSet;
+        inline CFLEdgeIterator begin() const
+        {
+            return CFLEdgeIterator(graph->begin(), graph->end());
+        }
+
+        inline CFLEdgeIterator end() const
+        {
+            return CFLEdgeIterator(graph->end(), graph->end());
+        }
+
+        inline u32_t size() const
+        {
+            return graph->getTotalEdgeNum();
+        }
+
+    private:
+        const CFLGraph* graph;
+    };
+
+    inline CFLEdgeRange getCFLEdges() const
+    {
+        return CFLEdgeRange(this);
+    }
 };
 
 }
@@ -267,31 +267,30 @@ private:
         return GTraits::getNodeID(node);
     }
 
-    void visit(NodeID v)
+    /// Record that the DFS from v has reached w (visited), merging their representatives if w is still open
+    inline void visitChild(NodeID v, NodeID w)
+    {
+        if (!this->inSCC(w))
+        {
+            NodeID rep;
+            rep = _D[this->rep(v)] < _D[this->rep(w)] ?
+                  this->rep(v) : this->rep(w);
+            this->rep(v,rep);
+        }
+    }
+
+    inline void enter(NodeID v)
     {
         // SVFUtil::outs() << "visit GNODE: " << Node_Index(v)<< "\n";
         _I += 1;
         _D[v] = _I;
         this->rep(v,v);
         this->setVisited(v,true);
+    }
 
-        child_iterator EI = GTraits::direct_child_begin(Node(v));
-        child_iterator EE = GTraits::direct_child_end(Node(v));
-
-        for (; EI != EE; ++EI)
-        {
-            NodeID w = Node_Index(*EI);
-
-            if (!this->visited(w))
-                visit(w);
-            if (!this->inSCC(w))
-            {
-                NodeID rep;
-                rep = _D[this->rep(v)] < _D[this->rep(w)] ?
-                      this->rep(v) : this->rep(w);
-                this->rep(v,rep);
-            }
-        }
+    /// Close v after all of its children are visited
+    inline void leave(NodeID v)
+    {
         if (this->rep(v) == v)
         {
             this->setInSCC(v,true);
@@ -313,6 +312,51 @@ private:
             _SS.push(v);
     }
 
+    /// Depth-first visit from root with an explicit stack, so that long
+    /// chains of nodes do not overflow the call stack
+    void visit(NodeID root)
+    {
+        struct Frame
+        {
+            NodeID v;
+            child_iterator it;
+            child_iterator end;
+        };
+        std::vector<Frame> dfs;
+
+        enter(root);
+        dfs.push_back({root, GTraits::direct_child_begin(Node(root)), GTraits::direct_child_end(Node(root))});
+        while (!dfs.empty())
+        {
+            Frame& frame = dfs.back();
+            if (frame.it != frame.end)
+            {
+                NodeID w = Node_Index(*frame.it);
+                if (!this->visited(w))
+                {
+                    /// the edge to w is handled once w is left
+                    enter(w);
+                    dfs.push_back({w, GTraits::direct_child_begin(Node(w)), GTraits::direct_child_end(Node(w))});
+                    continue;
+                }
+                visitChild(frame.v, w);
+                ++frame.it;
+            }
+            else
+            {
+                NodeID v = frame.v;
+                leave(v);
+                dfs.pop_back();
+                if (!dfs.empty())
+                {
+                    Frame& parent = dfs.back();
+                    visitChild(parent.v, v);
+                    ++parent.it;
+                }
+            }
+        }
+    }
+
     void clear()
     {
         _NodeSCCAuxInfo.clear();
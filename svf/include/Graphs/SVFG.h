@@ -307,10 +307,10 @@ protected:
 
     /// Get inter value flow edges between indirect call site and callee.
     //@{
-    virtual inline void getInterVFEdgeAtIndCSFromAPToFP(const PAGNode* cs_arg, const PAGNode* fun_arg, const CallICFGNode*, CallSiteID csId, SVFGEdgeSetTy& edges)
+    virtual inline void getInterVFEdgeAtIndCSFromAPToFP(const PAGNode* cs_arg, const PAGNode* fun_arg, const CallICFGNode* cs, CallSiteID csId, SVFGEdgeSetTy& edges)
     {
-        SVFGNode* actualParam = getSVFGNode(getDef(cs_arg));
-        SVFGNode* formalParam = getSVFGNode(getDef(fun_arg));
+        SVFGNode* actualParam = getActualParmVFGNode(cs_arg, cs);
+        SVFGNode* formalParam = getFormalParmVFGNode(fun_arg);
         SVFGEdge* edge = hasInterVFGEdge(actualParam, formalParam, SVFGEdge::CallDirVF, csId);
         assert(edge != nullptr && "Can not find inter value flow edge from aparam to fparam");
         edges.insert(edge);
@@ -318,8 +318,8 @@ protected:
 
     virtual inline void getInterVFEdgeAtIndCSFromFRToAR(const PAGNode* fun_ret, const PAGNode* cs_ret, CallSiteID csId, SVFGEdgeSetTy& edges)
     {
-        SVFGNode* formalRet = getSVFGNode(getDef(fun_ret));
-        SVFGNode* actualRet = getSVFGNode(getDef(cs_ret));
+        SVFGNode* formalRet = getFormalRetVFGNode(fun_ret);
+        SVFGNode* actualRet = getActualRetVFGNode(cs_ret);
         SVFGEdge* edge = hasInterVFGEdge(formalRet, actualRet, SVFGEdge::RetDirVF, csId);
         assert(edge != nullptr && "Can not find inter value flow edge from fret to aret");
         edges.insert(edge);
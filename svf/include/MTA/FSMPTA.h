@@ -0,0 +1,138 @@
+//===- FSMPTA.h -- Flow-sensitive analysis of multithreaded programs-------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+
+/*
+ * FSMPTA.h
+ *
+ * The SVFG of a sequential program misses the value-flows of memory from a
+ * store in one thread to a load or store in another thread. MTASVFGBuilder
+ * adds them as thread interference edges (ThreadMHPIndSVFGEdge) between a
+ * store and a load/store that may happen in parallel, are not protected by a
+ * common lock and whose pointers may alias, labelled with the objects they
+ * may both access. FSMPTA is the sparse flow-sensitive analysis solved on
+ * the SVFG with these edges.
+ *
+ * Two accesses under a common lock do not interleave, but the value written
+ * in one critical section may still be read in a later one. Such pairs are
+ * connected only with -fsmpta-locked-edges.
+ *
+ * The implementation is based on
+ * Yulei Sui, Peng Di, and Jingling Xue. "Sparse Flow-Sensitive Pointer Analysis for Multithreaded Programs".
+ * 2016 International Symposium on Code Generation and Optimization (CGO'16)
+ */
+
+#ifndef INCLUDE_MTA_FSMPTA_H_
+#define INCLUDE_MTA_FSMPTA_H_
+
+#include "MSSA/SVFGBuilder.h"
+#include "WPA/FlowSensitive.h"
+
+namespace SVF
+{
+
+class MHP;
+class LockAnalysis;
+
+/*!
+ * SVFG builder adding thread interference edges
+ */
+class MTASVFGBuilder : public SVFGBuilder
+{
+
+public:
+    /// Constructor
+    MTASVFGBuilder(MHP* m, LockAnalysis* la) : SVFGBuilder(), mhp(m), lsa(la), numOfInterferenceEdges(0)
+    {
+    }
+
+    /// Destructor
+    ~MTASVFGBuilder() override = default;
+
+    /// Number of thread interference edges added to the SVFG
+    inline u32_t getNumOfInterferenceEdges() const
+    {
+        return numOfInterferenceEdges;
+    }
+
+protected:
+    /// Build the sequential SVFG, then add the thread interference edges
+    void buildSVFG() override;
+
+private:
+    /// Connect stores to the loads and stores they may interfere with,
+    /// the pairs are checked on Options::FSMPTAThreads() threads
+    void connectMHPEdges(BVDataPTAImpl* pta);
+
+    MHP* mhp;
+    LockAnalysis* lsa;
+    u32_t numOfInterferenceEdges;
+};
+
+/*!
+ * Sparse flow-sensitive pointer analysis for multithreaded programs
+ */
+class FSMPTA : public FlowSensitive
+{
+
+public:
+    /// Constructor
+    FSMPTA(MHP* m, LockAnalysis* la) : FlowSensitive(PAG::getPAG()), mhp(m), lsa(la), mtaSVFGBuilder(m, la)
+    {
+    }
+
+    /// Destructor
+    ~FSMPTA() override = default;
+
+    /// Initialize analysis, the SVFG is built by MTASVFGBuilder
+    void initialize() override;
+
+    /// Get PTA name
+    const std::string PTAName() const override
+    {
+        return "FSMPTA";
+    }
+
+    inline MHP* getMHP() const
+    {
+        return mhp;
+    }
+
+    inline LockAnalysis* getLockAnalysis() const
+    {
+        return lsa;
+    }
+
+    /// Number of thread interference edges of the SVFG
+    inline u32_t getNumOfInterferenceEdges() const
+    {
+        return mtaSVFGBuilder.getNumOfInterferenceEdges();
+    }
+
+private:
+    MHP* mhp;
+    LockAnalysis* lsa;
+    MTASVFGBuilder mtaSVFGBuilder;
+};
+
+} // End namespace SVF
+
+#endif /* INCLUDE_MTA_FSMPTA_H_ */
@@ -97,6 +97,11 @@ public:
     void collectLockUnlocksites();
     void buildCandidateFuncSetforLock();
 
+    /// Number lock/unlock sites and compute which of them have aliased lock values
+    void buildLockAliasIndex();
+    /// Build the per-instruction lock-site bitsets used by isProtectedByCommonLock
+    void buildLockSetIndex();
+
     /// Intraprocedural locks
     //@{
     /// Return true if the lock is an intra-procedural lock
@@ -304,6 +309,9 @@ public:
     /// echo inst may have multiple cxt stmt
     /// we check whether every cxt stmt of instructions is protected by a common lock.
     bool isProtectedByCommonLock(const ICFGNode *i1, const ICFGNode *i2);
+    /// Same as isProtectedByCommonLock without updating the query statistics,
+    /// hence it can be called from multiple threads once the analysis finishes
+    bool isProtectedByCommonLockNoStat(const ICFGNode *i1, const ICFGNode *i2);
     bool isProtectedByCommonCxtLock(const ICFGNode *i1, const ICFGNode *i2);
     bool isProtectedByCommonCxtLock(const CxtStmt& cxtStmt1, const CxtStmt& cxtStmt2);
     bool isProtectedByCommonCILock(const ICFGNode *i1, const ICFGNode *i2);
@@ -349,7 +357,31 @@ private:
     bool isAliasedLocks(const ICFGNode* i1, const ICFGNode* i2)
     {
         /// todo: must alias
-        return tct->getPTA()->alias(getLockVal(i1)->getId(), getLockVal(i2)->getId());
+        return aliasedLockSites[getLockSiteIdx(i1)].test(getLockSiteIdx(i2));
+    }
+    inline u32_t getLockSiteIdx(const ICFGNode* site) const
+    {
+        Map<const ICFGNode*, u32_t>::const_iterator it = lockSiteToIdx.find(site);
+        assert(it != lockSiteToIdx.end() && "not a lock/unlock site?");
+        return it->second;
+    }
+
+    /// Lock sites of a lock set and the lock/unlock sites aliased with any of them
+    struct LockSiteSet
+    {
+        NodeBS lockSites;
+        NodeBS aliasedSites;
+    };
+    inline void addLockSite(LockSiteSet& lss, const ICFGNode* site) const
+    {
+        u32_t idx = getLockSiteIdx(site);
+        lss.lockSites.set(idx);
+        lss.aliasedSites |= aliasedLockSites[idx];
+    }
+    /// Whether a lock of a aliases a lock of b
+    inline bool hasAliasedLocks(const LockSiteSet& a, const LockSiteSet& b) const
+    {
+        return a.aliasedSites.intersects(b.lockSites);
     }
 
     /// Mark thread flags for cxtStmt
@@ -520,6 +552,18 @@ private:
     InstToInstSetMap instTocondCILocksMap;
     //@}
 
+    /// Lock/unlock sites are numbered so that aliasing of locks is a bit test
+    //@{
+    Map<const ICFGNode*, u32_t> lockSiteToIdx;
+    std::vector<NodeBS> aliasedLockSites; ///< sites whose lock value may alias that of a site
+    //@}
+
+    /// Lock-site bitsets of instructions, for the fast path of isProtectedByCommonLock
+    //@{
+    Map<const ICFGNode*, LockSiteSet> instToCILockSites; ///< intra-procedural locks of an instruction
+    Map<const ICFGNode*, std::vector<LockSiteSet>> instToCxtLockSites; ///< distinct lock sets of the context-sensitive statements of an instruction
+    //@}
+
 
 public:
     double lockTime;
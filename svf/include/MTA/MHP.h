@@ -32,6 +32,9 @@
 
 #include "MTA/TCT.h"
 #include "Util/SVFUtil.h"
+#include "Util/BitVector.h"
+#include <atomic>
+#include <mutex>
 namespace SVF
 {
 
@@ -58,6 +61,8 @@ public:
     typedef std::pair<const FunObjVar*,const FunObjVar*> FuncPair;
     typedef Map<FuncPair, bool> FuncPairToBool;
 
+    typedef Set<const ICFGNode*> InstSet;
+
     /// Constructor
     MHP(TCT* t);
 
@@ -92,11 +97,17 @@ public:
     virtual bool mayHappenInParallelInst(const ICFGNode* i1, const ICFGNode* i2);
     virtual bool executedByTheSameThread(const ICFGNode* i1, const ICFGNode* i2);
 
+    /// Number of pairs in instSet1 x instSet2 that may happen-in-parallel,
+    /// same as calling mayHappenInParallel on each pair but computed by bitset intersections
+    u32_t countMHPPairs(const InstSet& instSet1, const InstSet& instSet2);
+
     /// Get interleaving thread for statement inst
     //@{
-    inline const NodeBS& getInterleavingThreads(const CxtThreadStmt& cts)
+    inline const NodeBS& getInterleavingThreads(const CxtThreadStmt& cts) const
     {
-        return threadStmtToTheadInterLeav[cts];
+        ThreadStmtToThreadInterleav::const_iterator it = threadStmtToTheadInterLeav.find(cts);
+        assert(it!=threadStmtToTheadInterLeav.end() && "no interleaving of the thread statement?");
+        return it->second;
     }
     inline bool hasInterleavingThreads(const CxtThreadStmt& cts) const
     {
@@ -123,6 +134,28 @@ public:
 
 private:
 
+    /// Thread pairs of an instruction for all-pairs MHP.
+    /// Bit t*N+u of pairs is set if a thread statement of t (other than u) has u in its interleaving,
+    /// revPairs is the same relation with bit u*N+t, N being the number of TCT nodes.
+    struct InstThreadPairs
+    {
+        NodeBS pairs;
+        NodeBS revPairs;
+        NodeBS multiForkedTids;
+    };
+
+    /// Worker of the parallel interleaving analysis, sharing the TCT and ForkJoinAnalysis of master
+    MHP(const MHP* master);
+
+    /// Analyze the interleavings seeded by thread rootTid
+    void analyzeRootInterleaving(NodeID rootTid);
+
+    /// Analyze the thread roots on Options::MHPThreads() workers and merge their interleavings
+    void analyzeInterleavingInParallel();
+
+    /// Collect the thread pairs of inst
+    void collectInstThreadPairs(const ICFGNode* inst, InstThreadPairs& tp);
+
     inline const CallGraph::FunctionSet& getCallee(const CallICFGNode* inst, CallGraph::FunctionSet& callees)
     {
         tcg->getCallees(inst, callees);
@@ -252,6 +285,7 @@ private:
     ThreadCallGraph* tcg;				///< TCG
     TCT* tct;							///< TCT
     ForkJoinAnalysis* fja;				///< ForJoin Analysis
+    bool ownFJA;						///< Whether fja is deleted with this object (false for workers)
     CxtThreadStmtWorkList cxtStmtList;	///< CxtThreadStmt worklist
     ThreadStmtToThreadInterleav threadStmtToTheadInterLeav; /// Map a statement to its thread interleavings
     InstToThreadStmtSetMap instToTSMap; ///< Map an instruction to its ThreadStmtSet
@@ -259,8 +293,8 @@ private:
 
 
 public:
-    u32_t numOfTotalQueries;		///< Total number of queries
-    u32_t numOfMHPQueries;			///< Number of queries are answered as may-happen-in-parallel
+    std::atomic<u32_t> numOfTotalQueries;	///< Total number of queries
+    std::atomic<u32_t> numOfMHPQueries;	///< Number of queries are answered as may-happen-in-parallel
     double interleavingTime;
     double interleavingQueriesTime;
 };
@@ -286,12 +320,17 @@ public:
     typedef TCT::InstVec InstVec;
     typedef Map<CxtStmt,ValDomain> CxtStmtToAliveFlagMap;
     typedef Map<CxtStmt,NodeBS> CxtStmtToTIDMap;
-    typedef Set<NodePair> ThreadPairSet;
+    typedef std::vector<BitVector> ThreadMatrix; ///< a dense row of thread ids for each thread id
     typedef Map<CxtStmt, LoopBBs> CxtStmtToLoopMap;
     typedef FIFOWorkList<CxtStmt> CxtStmtWorkList;
 
     ForkJoinAnalysis(TCT* t) : tct(t)
     {
+        const u32_t threadNum = tct->getTCTNodeNum();
+        HBMatrix.resize(threadNum);
+        HPMatrix.resize(threadNum);
+        fullJoinMatrix.resize(threadNum);
+        partialJoinMatrix.resize(threadNum);
         collectSCEVInfo();
     }
     /// functions
@@ -308,6 +347,7 @@ public:
         return directJoinMap[cs];
     }
     /// Get directly and indirectly joined threadIDs based on a context-sensitive join site
+    /// (memoized, safe to call from the workers of the parallel MHP analysis)
     NodeBS getDirAndIndJoinedTid(const CxtStmt& cs);
 
     /// Whether a context-sensitive join satisfies symmetric loop pattern
@@ -323,18 +363,25 @@ public:
         return it!=cxtJoinInLoop.end();
     }
     /// Whether thread t1 happens-before thread t2
-    inline bool isHBPair(NodeID tid1, NodeID tid2)
+    inline bool isHBPair(NodeID tid1, NodeID tid2) const
     {
-        bool nonhp = HBPair.find(std::make_pair(tid1,tid2))!=HBPair.end();
-        bool hp = HPPair.find(std::make_pair(tid1,tid2))!=HPPair.end();
-        return nonhp && !hp;
+        return HBMatrix[tid1].test(tid2) && !HPMatrix[tid1].test(tid2);
     }
     /// Whether t1 fully joins t2
-    inline bool isFullJoin(NodeID tid1, NodeID tid2)
+    inline bool isFullJoin(NodeID tid1, NodeID tid2) const
+    {
+        return fullJoinMatrix[tid1].test(tid2) && !partialJoinMatrix[tid1].test(tid2);
+    }
+    /// Whether the chain of full joins from t2 up to t1 is known, see collectJoinClosures
+    inline bool hasRecurFullJoin(NodeID tid2) const
     {
-        bool full = fullJoin.find(std::make_pair(tid1,tid2))!=fullJoin.end();
-        bool partial = partialJoin.find(std::make_pair(tid1,tid2))!=partialJoin.end();
-        return full && !partial;
+        return hasRecurFullJoinRow.test(tid2);
+    }
+    /// Whether t1 fully joins t2 recursively, i.e., every thread on the TCT path from t1 to t2 fully joins its child
+    inline bool isRecurFullJoin(NodeID tid1, NodeID tid2) const
+    {
+        assert(hasRecurFullJoin(tid2) && "full join chain not collected!");
+        return recurFullJoinMatrix[tid2].test(tid1);
     }
 
     /// Get exit instruction of the start routine function of tid's parent thread
@@ -357,6 +404,9 @@ public:
     }
 private:
 
+    /// Collect the transitive full join relations once all fork join pairs are analyzed
+    void collectJoinClosures();
+
     /// Handle fork
     void handleFork(const CxtStmt& cts,NodeID rootTid);
 
@@ -503,12 +553,12 @@ private:
     //@{
     inline void addToHPPair(NodeID tid1, NodeID tid2)
     {
-        HPPair.insert(std::make_pair(tid1,tid2));
-        HPPair.insert(std::make_pair(tid2,tid1));
+        HPMatrix[tid1].set(tid2);
+        HPMatrix[tid2].set(tid1);
     }
     inline void addToHBPair(NodeID tid1, NodeID tid2)
     {
-        HBPair.insert(std::make_pair(tid1,tid2));
+        HBMatrix[tid1].set(tid2);
     }
     //@}
 
@@ -516,11 +566,11 @@ private:
     //@{
     inline void addToFullJoin(NodeID tid1, NodeID tid2)
     {
-        fullJoin.insert(std::make_pair(tid1,tid2));
+        fullJoinMatrix[tid1].set(tid2);
     }
     inline void addToPartial(NodeID tid1, NodeID tid2)
     {
-        partialJoin.insert(std::make_pair(tid1,tid2));
+        partialJoinMatrix[tid1].set(tid2);
     }
     //@}
 
@@ -534,11 +584,15 @@ private:
     CxtStmtWorkList cxtStmtList;	 ///< context-sensitive statement worklist
     CxtStmtToTIDMap directJoinMap; ///< maps a context-sensitive join site to directly joined thread ids
     CxtStmtToTIDMap dirAndIndJoinMap; ///< maps a context-sensitive join site to directly and indirectly joined thread ids
+    std::mutex joinedTidMutex; ///< guards dirAndIndJoinMap and directJoinMap in getDirAndIndJoinedTid
     CxtStmtToLoopMap cxtJoinInLoop;		///< a set of context-sensitive join inside loop
-    ThreadPairSet HBPair;		///< thread happens-before pair
-    ThreadPairSet HPPair;		///< threads happen-in-parallel
-    ThreadPairSet fullJoin;		///< t1 fully joins t2 along all program path
-    ThreadPairSet partialJoin;		///< t1 partially joins t2 along some program path(s)
+    ThreadMatrix HBMatrix;		///< t2 in row t1: t1 happens-before t2
+    ThreadMatrix HPMatrix;		///< t2 in row t1: t1 and t2 happen-in-parallel
+    ThreadMatrix fullJoinMatrix;		///< t2 in row t1: t1 fully joins t2 along all program path
+    ThreadMatrix partialJoinMatrix;		///< t2 in row t1: t1 partially joins t2 along some program path(s)
+    ThreadMatrix recurFullJoinMatrix;	///< t1 in row t2: t1 fully joins t2 recursively
+    BitVector hasRecurFullJoinRow;	///< threads whose row of recurFullJoinMatrix is collected
+    std::vector<NodeBS> fullJoinClosure;	///< threads fully joined by a thread directly or indirectly
 };
 
 } // End namespace SVF
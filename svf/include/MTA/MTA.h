@@ -37,6 +37,7 @@
 #include <set>
 #include <vector>
 #include "SVFIR/SVFValue.h"
+#include "Util/SVFBugReport.h"
 
 namespace SVF
 {
@@ -48,6 +49,7 @@ class MTAStat;
 class TCT;
 class MHP;
 class LockAnalysis;
+class FSMPTA;
 
 /*!
  * Base data race detector
@@ -84,12 +86,27 @@ public:
     {
         return lsa;
     }
+
+    /// Flow-sensitive pointer analysis on the thread-aware SVFG, nullptr without -fsmpta
+    FSMPTA* getFSMPTA()
+    {
+        return fsmpta.get();
+    }
+
+    /// Races found by detect()
+    inline const SVFBugReport& getBugReport() const
+    {
+        return report;
+    }
 private:
+    AndersenWaveDiff* pta; ///< Shared by the TCT, MHP and race detection
     ThreadCallGraph* tcg;
     std::unique_ptr<TCT> tct;
     std::unique_ptr<MTAStat> stat;
     MHP* mhp;
     LockAnalysis* lsa;
+    std::unique_ptr<FSMPTA> fsmpta;
+    SVFBugReport report; ///< Bug Reporter
 };
 
 } // End namespace SVF
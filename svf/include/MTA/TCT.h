@@ -34,6 +34,7 @@
 #include "Graphs/ThreadCallGraph.h"
 #include "Util/CxtStmt.h"
 #include "Util/SVFUtil.h"
+#include <atomic>
 #include <set>
 #include <vector>
 
@@ -320,42 +321,16 @@ public:
         return edge->getSrcID();
     }
     /// Get all ancestor threads
-    const NodeBS getAncestorThread(NodeID tid) const
+    inline const NodeBS& getAncestorThread(NodeID tid) const
     {
-        NodeBS tds;
-        if(hasParentThread(tid) == false)
-            return tds;
-
-        FIFOWorkList<NodeID> worklist;
-        worklist.push(getParentThread(tid));
-
-        while(!worklist.empty())
-        {
-            NodeID t = worklist.pop();
-            if(tds.test_and_set(t))
-            {
-                if(hasParentThread(t))
-                    worklist.push(getParentThread(t));
-            }
-        }
-        return tds;
+        assert(tid < ancestorRows.size() && "thread relations not collected!");
+        return ancestorRows[tid];
     }
     /// Get sibling threads
-    inline const NodeBS getSiblingThread(NodeID tid) const
+    inline const NodeBS& getSiblingThread(NodeID tid) const
     {
-        NodeBS tds;
-        if(hasParentThread(tid) == false)
-            return tds;
-
-        const TCTNode* node = getTCTNode(getParentThread(tid));
-        for(ThreadCreateEdgeSet::const_iterator it = getChildrenBegin(node), eit = getChildrenEnd(node); it!=eit; ++it)
-        {
-            NodeID child = (*it)->getDstNode()->getId();
-            if(child!=tid)
-                tds.set(child);
-        }
-
-        return tds;
+        assert(tid < siblingRows.size() && "thread relations not collected!");
+        return siblingRows[tid];
     }
     //@}
 
@@ -412,11 +387,14 @@ public:
     /// Match context
     bool matchCxt(CallStrCxt& cxt, const CallICFGNode* call, const FunObjVar* callee);
 
+    /// Also called by the workers of the parallel MHP analysis, hence the atomic MaxCxtSize
     inline void pushCxt(CallStrCxt& cxt, CallSiteID csId)
     {
         cxt.push_back(csId);
-        if (cxt.size() > MaxCxtSize)
-            MaxCxtSize = cxt.size();
+        u32_t size = cxt.size();
+        u32_t maxSize = MaxCxtSize;
+        while (size > maxSize && !MaxCxtSize.compare_exchange_weak(maxSize, size))
+            ;
     }
     /// Whether a join site is in recursion
     inline bool isJoinSiteInRecursion(const CallICFGNode* join) const
@@ -433,12 +411,18 @@ public:
     /// Print TCT information
     void print() const;
 
+    /// Store the threads and thread creation edges to a text file, -write-tct
+    void writeToFile(const std::string& filename) const;
+
+    /// Rebuild the tree from a file written by writeToFile on the same SVFIR, -read-tct
+    bool readFromFile(const std::string& filename);
+
 private:
     ThreadCallGraph* tcg;
     PointerAnalysis* pta;
     u32_t TCTNodeNum;
     u32_t TCTEdgeNum;
-    u32_t MaxCxtSize;
+    std::atomic<u32_t> MaxCxtSize;
 
     /// Add TCT node
     inline TCTNode* addTCTNode(const CxtThread& ct)
@@ -481,6 +465,9 @@ private:
     /// 2, parent thread is a multi-forked thread.
     void collectMultiForkedThreads();
 
+    /// Collect the ancestor and sibling threads of every thread
+    void collectThreadRelations();
+
     /// Handle join site in loop
     //@{
     /// collect loop info for join sites
@@ -502,6 +489,25 @@ private:
     /// Handle call relations
     void handleCallRelation(CxtThreadProc& ctp, const CallGraphEdge* cgEdge, const CallICFGNode* call);
 
+    /// Expand the contexts of all threads in ctpList
+    //@{
+    /// A fork site reached by a thread during parallel expansion
+    struct ForkEvent
+    {
+        CallStrCxt cxt;      ///< Context of the spawnee
+        CallStrCxt oldCxt;   ///< Context of the fork site
+        const CallICFGNode* fork;
+        const FunObjVar* routine;
+    };
+    void expandCTPs();
+    /// Threads of a wave are expanded by threadNum workers, their forks are
+    /// turned into TCT nodes in order of thread id before the next wave.
+    /// Node ids hence differ from expandCTPs, but not between worker counts
+    void expandCTPsInParallel(u32_t threadNum);
+    /// Expand the call relations of one thread from seeds, visited holds the ctps of that thread only
+    void expandThread(const std::vector<CxtThreadProc>& seeds, CxtThreadProcSet& visited, std::vector<ForkEvent>& forks);
+    //@}
+
     /// Get or create a tct node based on CxtThread
     //@{
     inline TCTNode* getOrCreateTCTNode(const CallStrCxt& cxt, const ICFGNode* fork,const CallStrCxt& oldCxt, const FunObjVar* routine)
@@ -587,6 +593,8 @@ private:
     CxtThreadToNodeMap ctpToNodeMap; /// Map a ctp to its graph node
     CxtThreadToForkCxt ctToForkCxtMap; /// Map a CxtThread to the context at its spawning site (fork site).
     CxtThreadToFun ctToRoutineFunMap; /// Map a CxtThread to its start routine function.
+    std::vector<NodeBS> ancestorRows; ///< ancestor threads indexed by thread id
+    std::vector<NodeBS> siblingRows; ///< sibling threads indexed by thread id
     InstToLoopMap joinSiteToLoopMap; ///< map an inloop join to its loop class
     Set<const ICFGNode*>  inRecurJoinSites;	///< Fork or Join sites in recursions
 };
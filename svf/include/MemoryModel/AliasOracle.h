@@ -0,0 +1,100 @@
+//===- AliasOracle.h -- Alias queries over finished points-to results---------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * AliasOracle.h
+ *
+ * Answers alias and "who may point to X" queries against the results of a
+ * BVDataPTAImpl whose solving has finished. Pointers are partitioned into
+ * classes by their (field-insensitively expanded) points-to sets, a class being
+ * the PersistentPointsToCache ID of that set, so that an alias query compares
+ * two classes and the result of a pair of classes is computed only once. The
+ * oracle does not observe later changes of the points-to results and is not
+ * thread-safe.
+ */
+
+#ifndef INCLUDE_MEMORYMODEL_ALIASORACLE_H_
+#define INCLUDE_MEMORYMODEL_ALIASORACLE_H_
+
+#include "MemoryModel/PointerAnalysisImpl.h"
+
+namespace SVF
+{
+
+class AliasOracle
+{
+public:
+    typedef PointsToID ClassID;
+
+    /// Build the pointer classes of all SVFIR nodes from the results of pta
+    explicit AliasOracle(BVDataPTAImpl* pta);
+
+    /// Same result as BVDataPTAImpl::alias
+    AliasResult alias(NodeID p, NodeID q);
+
+    /// Class of a pointer, the empty class if it points to nothing
+    inline ClassID getClass(NodeID p) const
+    {
+        auto it = ptrToClass.find(p);
+        return it == ptrToClass.end() ? PersistentPointsToCache<PointsTo>::emptyPointsToId() : it->second;
+    }
+
+    /// Expanded points-to set of a pointer
+    inline const PointsTo& getPts(NodeID p) const
+    {
+        return ptCache.getActualPts(getClass(p));
+    }
+
+    /// Pointers whose expanded points-to set contains obj, the index is built by the first call
+    const NodeBS& getPointersTo(NodeID obj);
+
+    /// Statistics
+    //@{
+    inline u32_t getClassNum() const
+    {
+        return classNum;
+    }
+    inline u64_t getQueryNum() const
+    {
+        return queryNum;
+    }
+    inline u64_t getPairCacheHitNum() const
+    {
+        return pairCacheHitNum;
+    }
+    //@}
+
+private:
+    BVDataPTAImpl* pta;
+    PersistentPointsToCache<PointsTo>& ptCache;
+    Map<NodeID, ClassID> ptrToClass;
+    Set<ClassID> blackHoleClasses; ///< classes containing the black hole object
+    Map<std::pair<ClassID, ClassID>, bool> pairCache; ///< whether two classes may alias
+    Map<NodeID, NodeBS> objToPtrs; ///< inverted index of the expanded points-to sets
+    bool indexBuilt;
+    u32_t classNum;
+    u64_t queryNum;
+    u64_t pairCacheHitNum;
+};
+
+} // End namespace SVF
+
+#endif /* INCLUDE_MEMORYMODEL_ALIASORACLE_H_ */
@@ -34,11 +34,73 @@
 #include "Util/WorkList.h"
 #include "Graphs/SVFG.h"
 #include "Util/Z3Expr.h"
+#include "Util/BDD.h"
 
 
 namespace SVF
 {
 
+/*!
+ * A branch or path condition of SaberCondAllocator: a Z3 expression, or a node
+ * of the allocator's BDD when the BDD backend is selected (-saber-cond=bdd).
+ * A default constructed condition is null, i.e., no condition.
+ */
+class SaberCondition
+{
+public:
+    typedef BDDManager::BDDRef BDDRef;
+
+    SaberCondition() : bdd(BDDManager::NullRef)
+    {
+    }
+    SaberCondition(const Z3Expr& expr) : expr(expr), bdd(BDDManager::NullRef)
+    {
+    }
+    explicit SaberCondition(BDDRef bdd) : bdd(bdd)
+    {
+    }
+
+    inline bool isBDD() const
+    {
+        return bdd != BDDManager::NullRef;
+    }
+    /// Whether this is the null condition
+    inline bool isNull() const
+    {
+        return !isBDD() && eq(expr.getExpr(), Z3Expr::nullExpr());
+    }
+    /// Z3 expression id or BDD node, unique per condition of one backend
+    inline u32_t id() const
+    {
+        return isBDD() ? bdd : expr.id();
+    }
+    inline const Z3Expr& getZ3Expr() const
+    {
+        return expr;
+    }
+    inline const z3::expr& getExpr() const
+    {
+        return expr.getExpr();
+    }
+    inline BDDRef getBDD() const
+    {
+        return bdd;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const SaberCondition& cond)
+    {
+        if (cond.isBDD())
+            out << "bdd" << cond.bdd;
+        else
+            out << cond.expr;
+        return out;
+    }
+
+private:
+    Z3Expr expr;
+    BDDRef bdd;
+};
+
 /**
  * SaberCondAllocator allocates conditions for each basic block of a certain CFG.
  */
@@ -47,7 +109,12 @@ class SaberCondAllocator
 
 public:
 
-    typedef Z3Expr Condition;   /// z3 condition
+    typedef SaberCondition Condition;   /// z3 or BDD condition
+    enum CondBackend
+    {
+        Z3_COND,
+        BDD_COND
+    };
     typedef Map<u32_t, const ICFGNode*> IndexToTermInstMap; /// id to instruction map for z3
     typedef Map<u32_t,Condition> CondPosMap;		///< map a branch to its Condition
     typedef Map<const SVFBasicBlock*, CondPosMap > BBCondMap;	/// map bb to a Condition
@@ -56,6 +123,7 @@ public:
     typedef Map<const SVFBasicBlock*, Condition> BBToCondMap;	///< map a basic block to its condition during control-flow guard computation
     typedef FIFOWorkList<const SVFBasicBlock*> CFWorkList;	///< worklist for control-flow guard computation
     typedef Map<const SVFGNode*, Set<const SVFGNode*>> SVFGNodeToSVFGNodeSetMap;
+    typedef std::vector<u64_t> TruthTable;	///< one bit per assignment of the branch conditions of a query
 
 
     /// Constructor
@@ -79,29 +147,61 @@ public:
     {
         return totalCondNum;
     }
+    /// Number of equivalence queries, and of those answered by the cache, by truth tables and by Z3
+    inline u32_t getEquivQueryNum() const
+    {
+        return equivQueryNum;
+    }
+    inline u32_t getEquivCacheHitNum() const
+    {
+        return equivCacheHitNum;
+    }
+    inline u32_t getEquivTableNum() const
+    {
+        return equivTableNum;
+    }
+    inline u32_t getEquivZ3Num() const
+    {
+        return equivZ3Num;
+    }
+    /// BDD manager of the BDD backend, nullptr for the Z3 backend
+    inline const BDDManager* getBDDManager() const
+    {
+        return bddManager.get();
+    }
     //@}
 
     /// Condition operations
     //@{
     inline Condition condAnd(const Condition& lhs, const Condition& rhs)
     {
-        return Condition::AND(lhs,rhs);
+        if (bddManager)
+            return Condition(bddManager->AND(lhs.getBDD(), rhs.getBDD()));
+        return Z3Expr::AND(lhs.getZ3Expr(), rhs.getZ3Expr());
     }
     inline Condition condOr(const Condition& lhs, const Condition& rhs)
     {
-        return Condition::OR(lhs,rhs);
+        if (bddManager)
+            return Condition(bddManager->OR(lhs.getBDD(), rhs.getBDD()));
+        return Z3Expr::OR(lhs.getZ3Expr(), rhs.getZ3Expr());
     }
     inline Condition condNeg(const Condition& cond)
     {
-        return Condition::NEG(cond);
+        if (bddManager)
+            return Condition(bddManager->NEG(cond.getBDD()));
+        return Z3Expr::NEG(cond.getZ3Expr());
     }
     inline Condition getTrueCond() const
     {
-        return Condition::getTrueCond();
+        if (bddManager)
+            return Condition(BDDManager::TrueRef);
+        return Z3Expr::getTrueCond();
     }
     inline Condition getFalseCond() const
     {
-        return Condition::getFalseCond();
+        if (bddManager)
+            return Condition(BDDManager::FalseRef);
+        return Z3Expr::getFalseCond();
     }
     /// Iterator every element of the condition
     inline NodeBS exactCondElem(const Condition& cond)
@@ -113,7 +213,9 @@ public:
 
     inline std::string dumpCond(const Condition& cond) const
     {
-        return Condition::dumpStr(cond);
+        if (bddManager)
+            return bddManager->toString(cond.getBDD());
+        return Z3Expr::dumpStr(cond.getZ3Expr());
     }
 
     /// Allocate a new condition
@@ -177,6 +279,12 @@ public:
     {
         bbToCondMap.clear();
     }
+
+    /// Drop the cached equivalence queries and the conditions they keep alive, called per source
+    inline void clearEquivQueryCache()
+    {
+        equivQueryCache.clear();
+    }
     /// Set current value for branch condition evaluation
     inline void setCurEvalSVFGNode(const SVFGNode* node)
     {
@@ -198,7 +306,7 @@ public:
     /// whether condition is satisfiable for all possible boolean guards
     inline bool isAllPathReachable(Condition& condition)
     {
-        return isEquivalentBranchCond(condition, Condition::getTrueCond());
+        return isEquivalentBranchCond(condition, getTrueCond());
     }
 
     /// Whether lhs and rhs are equivalent branch conditions
@@ -297,6 +405,37 @@ private:
     /// extract subexpression from a Z3 expression
     void extractSubConds(const Condition &condition, NodeBS &support) const;
 
+    /// Truth tables of boolean combinations of branch conditions
+    //@{
+    /// Collect the branch conditions of an expression, return false if it is not a boolean combination of them
+    bool collectTableVars(const z3::expr& expr, Map<u32_t, u32_t>& varToIdx) const;
+    /// Compute the truth tables of lhs and rhs, return false if there are too many branch conditions
+    bool computeTruthTables(const Condition& lhs, const Condition& rhs, TruthTable& lhsTable, TruthTable& rhsTable) const;
+    /// Truth table of an expression whose variables are indexed by varToIdx
+    const TruthTable& computeTruthTable(const z3::expr& expr, const Map<u32_t, u32_t>& varToIdx, u32_t numVars,
+                                        Map<u32_t, TruthTable>& memo) const;
+    //@}
+
+    /// Truth tables have 2^MaxTableVars bits at most, whatever Options::CondTableVars() asks for
+    static constexpr u32_t MaxTableVars = 20;
+    /// The cache is cleared when it reaches this many queries
+    static constexpr u32_t MaxEquivQueryCacheSize = 1u << 16;
+
+    /// Equivalence query result, holding both conditions so that their Z3 ids are not recycled
+    struct EquivQuery
+    {
+        Condition lhs;
+        Condition rhs;
+        bool equivalent;
+    };
+    mutable Map<std::pair<u32_t, u32_t>, EquivQuery> equivQueryCache; ///< key: ids of the two conditions, smaller first
+    mutable u32_t equivQueryNum{0};
+    mutable u32_t equivCacheHitNum{0};
+    mutable u32_t equivTableNum{0};
+    mutable u32_t equivZ3Num{0};
+
+    std::unique_ptr<BDDManager> bddManager; ///< set for the BDD backend only
+
 
     FunToExitBBsMap funToExitBBsMap;		///< map a function to all its basic blocks calling program exit
     BBToCondMap bbToCondMap;				///< map a basic block to its path condition starting from root
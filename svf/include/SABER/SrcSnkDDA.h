@@ -48,6 +48,8 @@ namespace SVF
 
 typedef GraphReachSolver<SVFG*,CxtDPItem> CFLSrcSnkSolver;
 
+class SrcSnkSlicer;
+
 /*!
  * General source-sink analysis, which serves as a base analysis to be extended for various clients
  */
@@ -201,6 +203,10 @@ public:
     /// report bug on the current analyzed slice
     virtual void reportBug(ProgSlice* slice) = 0;
 
+    /// Push (call edge) or match (return edge) the call site of an edge on the context of newItem,
+    /// return false if the context does not match
+    static bool propagateContext(const SVFGEdge* edge, DPIm& newItem);
+
     /// Get sources/sinks
     //@{
     inline const SVFGNodeSet& getSources() const
@@ -249,6 +255,10 @@ public:
     }
 
 protected:
+    /// Compute the slices of all sources with SrcSnkSlicers on Options::SaberThreads() threads,
+    /// then solve guards and report bugs in source order on the current thread
+    void analyzeInParallel();
+
     /// Forward traverse
     inline void FWProcessCurNode(const DPIm& item) override
     {
@@ -322,6 +332,90 @@ protected:
 
 };
 
+/*!
+ * Context-sensitive forward and backward slicing of one source, without path
+ * conditions. Every thread of SrcSnkDDA::analyzeInParallel owns a slicer with
+ * its own worklist and visited sets; guards are computed afterwards by the
+ * analysis, since all Z3 expressions share one global context.
+ *
+ * With forward summaries enabled, the forward closure of every item entering
+ * a callee through a call edge (callee node plus context) is computed once and
+ * reused by all later sources of the slicer that reach the same item, instead
+ * of re-exploring the callee and everything reachable after it.
+ */
+class SrcSnkSlicer : public CFLSrcSnkSolver
+{
+public:
+    typedef SrcSnkDDA::SVFGNodeSet SVFGNodeSet;
+    typedef SrcSnkDDA::DPIm DPIm;
+    typedef SrcSnkDDA::DPImSet DPImSet;
+
+    /// Slices of one source
+    struct Result
+    {
+        SVFGNodeSet forwardSlice;
+        SVFGNodeSet backwardSlice;
+        SVFGNodeSet sinks;
+        bool partialReachable{false};
+        bool reachGlobal{false};
+    };
+
+    /// Forward closure of an item
+    struct FWSummary
+    {
+        NodeBS nodes;  ///< SVFG nodes reached
+        NodeBS sinks;  ///< sinks among the reached nodes
+        bool reachGlobal{false};  ///< traversal stopped at a global SVFG node
+    };
+
+    SrcSnkSlicer(const SrcSnkDDA* dda, SVFG* svfg, bool useSummary = false) :
+        dda(dda), cur(nullptr), useSummary(useSummary)
+    {
+        setGraph(svfg);
+    }
+
+    /// Compute the slices of src into result
+    void slice(const SVFGNode* src, Result& result);
+
+    /// Number of forward summaries computed and reused
+    //@{
+    inline u32_t getSummaryNum() const
+    {
+        return summaries.size();
+    }
+    inline u32_t getSummaryHitNum() const
+    {
+        return summaryHitNum;
+    }
+    //@}
+
+protected:
+    /// Same propagation rules as SrcSnkDDA, recorded into the current result
+    //@{
+    void FWProcessCurNode(const DPIm& item) override;
+    void BWProcessCurNode(const DPIm& item) override;
+    void FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge) override;
+    void BWProcessIncomingEdge(const DPIm& item, SVFGEdge* edge) override;
+    //@}
+
+private:
+    /// Forward closure of start, using the summaries of the callee entries met on the way
+    void forwardClosure(const DPIm& start, FWSummary& summary);
+
+    /// Summary of a callee entry item, nullptr if it is being computed (recursion)
+    const FWSummary* getSummary(const DPIm& entry);
+
+    const SrcSnkDDA* dda;
+    Result* cur;
+    SrcSnkDDA::SVFGNodeToDPItemsMap nodeToDPItemsMap;
+    SVFGNodeSet visitedSet;
+
+    bool useSummary;
+    Map<DPIm, FWSummary> summaries;  ///< callee entry item to its forward closure
+    DPImSet inProgress;  ///< callee entry items whose summaries are being computed
+    u32_t summaryHitNum{0};
+};
+
 } // End namespace SVF
 
 #endif /* SRCSNKANALYSIS_H_ */
@@ -0,0 +1,175 @@
+//===- BDD.h -- Reduced ordered binary decision diagrams----------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * BDD.h
+ *
+ * A small ROBDD package for path conditions. Nodes are hash-consed in a unique
+ * table, so two equivalent functions are represented by the same node and an
+ * equivalence check is a comparison of two references. Boolean operations are
+ * implemented by ITE with a lossy direct-mapped operation cache. Variables are
+ * ordered by their index and nodes are never freed during a run.
+ *
+ * Reference: K. S. Brace, R. L. Rudell, R. E. Bryant. Efficient Implementation
+ * of a BDD Package. DAC'90.
+ */
+
+#ifndef SVF_UTIL_BDD_H
+#define SVF_UTIL_BDD_H
+
+#include "SVFIR/SVFType.h"
+
+namespace SVF
+{
+
+class BDDManager
+{
+public:
+    typedef u32_t BDDRef;
+
+    static constexpr BDDRef FalseRef = 0;
+    static constexpr BDDRef TrueRef = 1;
+    static constexpr BDDRef NullRef = std::numeric_limits<u32_t>::max();
+
+    /// One literal of a cube: <variable, polarity>
+    typedef std::pair<u32_t, bool> Literal;
+
+    /// Create a manager whose operation cache holds 2^cacheBits entries
+    explicit BDDManager(u32_t cacheBits = 18);
+
+    /// The function of a single variable
+    BDDRef getVar(u32_t var);
+
+    /// Boolean operations
+    //@{
+    BDDRef ITE(BDDRef f, BDDRef g, BDDRef h);
+
+    inline BDDRef AND(BDDRef f, BDDRef g)
+    {
+        return ITE(f, g, FalseRef);
+    }
+    inline BDDRef OR(BDDRef f, BDDRef g)
+    {
+        return ITE(f, TrueRef, g);
+    }
+    inline BDDRef NEG(BDDRef f)
+    {
+        return ITE(f, FalseRef, TrueRef);
+    }
+    //@}
+
+    inline bool isTerminal(BDDRef f) const
+    {
+        return f == FalseRef || f == TrueRef;
+    }
+
+    /// Top variable and cofactors of a non-terminal node
+    //@{
+    inline u32_t getVarOf(BDDRef f) const
+    {
+        return nodes[f].var;
+    }
+    inline BDDRef getLow(BDDRef f) const
+    {
+        return nodes[f].low;
+    }
+    inline BDDRef getHigh(BDDRef f) const
+    {
+        return nodes[f].high;
+    }
+    //@}
+
+    /// Variables f depends on
+    void getSupport(BDDRef f, Set<u32_t>& vars) const;
+
+    /// Literals of one satisfying path of f, return false if f is unsatisfiable
+    bool getOneCube(BDDRef f, std::vector<Literal>& cube) const;
+
+    /// Number of nodes reachable from f, terminals included
+    u32_t getDagSize(BDDRef f) const;
+
+    std::string toString(BDDRef f) const;
+
+    /// Statistics
+    //@{
+    inline u32_t getNodeNum() const
+    {
+        return nodes.size();
+    }
+    inline u32_t getUniqueHitNum() const
+    {
+        return uniqueHitNum;
+    }
+    inline u32_t getCacheHitNum() const
+    {
+        return cacheHitNum;
+    }
+    inline u32_t getCacheMissNum() const
+    {
+        return cacheMissNum;
+    }
+    //@}
+
+private:
+    struct Node
+    {
+        u32_t var;
+        BDDRef low;
+        BDDRef high;
+    };
+
+    struct CacheEntry
+    {
+        BDDRef f{NullRef};
+        BDDRef g{NullRef};
+        BDDRef h{NullRef};
+        BDDRef result{NullRef};
+    };
+
+    /// Find or create the node (var, low, high)
+    BDDRef makeNode(u32_t var, BDDRef low, BDDRef high);
+
+    /// Cofactor of f with respect to var, var being at or above the top variable of f
+    inline BDDRef cofactor(BDDRef f, u32_t var, bool positive) const
+    {
+        if (nodes[f].var != var)
+            return f;
+        return positive ? nodes[f].high : nodes[f].low;
+    }
+
+    inline size_t cacheSlot(BDDRef f, BDDRef g, BDDRef h) const
+    {
+        u64_t key = ((u64_t) f * 12582917ULL) ^ ((u64_t) g * 4256249ULL) ^ ((u64_t) h * 741457ULL);
+        return (key ^ (key >> 29)) & (cache.size() - 1);
+    }
+
+    std::vector<Node> nodes; ///< nodes[0] and nodes[1] are the terminals
+    Map<std::pair<u32_t, u64_t>, BDDRef> uniqueTable; ///< <var, low:high> to node
+    std::vector<CacheEntry> cache; ///< ITE results
+
+    u32_t uniqueHitNum{0};
+    u32_t cacheHitNum{0};
+    u32_t cacheMissNum{0};
+};
+
+} // End namespace SVF
+
+#endif // SVF_UTIL_BDD_H
@@ -0,0 +1,293 @@
+//===- CallStrCxt.h -- Hash-consed call string contexts-----------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * CallStrCxt.h
+ *
+ * Call string contexts are interned in a global trie whose root is the empty
+ * context. A CallStrCxt is the 32-bit ID of its trie node, so copying, equality
+ * and hashing are integer operations and push/pop are a lookup of the child or
+ * the parent node. A node only keeps its parent, last call site and depth, the
+ * call sites of a context are read by walking up the trie, whose depth is the
+ * context length. The children of the nodes are spread over independently
+ * locked shards, so that threads pushing different contexts rarely wait.
+ *
+ * Nodes are never freed during a run. The trie holds each distinct context
+ * once, with 16 bytes per node plus its entry in the children map, and the
+ * analyses keep the contexts they have met in their own maps anyway. A k-limited
+ * analysis (e.g., ContextDDA) therefore stops growing it once it has met all
+ * the k-limited contexts of its queries.
+ */
+
+#ifndef SVF_UTIL_CALLSTRCXT_H
+#define SVF_UTIL_CALLSTRCXT_H
+
+#include "SVFIR/SVFType.h"
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SVF
+{
+
+/*!
+ * Global trie of call strings, shared by all analyses (and threads) of a run
+ */
+class CallStrCxtTable
+{
+public:
+    struct Node
+    {
+        u32_t parent;   ///< Context without the last call site
+        u32_t callSite; ///< Last call site
+        u32_t depth;    ///< Number of call sites
+        std::atomic<u32_t> front{InvalidId}; ///< Context without the first call site, once computed
+    };
+
+    static constexpr u32_t InvalidId = std::numeric_limits<u32_t>::max();
+
+    static CallStrCxtTable& getTable()
+    {
+        static CallStrCxtTable table;
+        return table;
+    }
+
+    ~CallStrCxtTable();
+
+    /// Node of an interned context, ids handed out by the table are never invalidated
+    inline const Node& getNode(u32_t id) const
+    {
+        u32_t chunk, offset;
+        locate(id, chunk, offset);
+        return chunks[chunk].load(std::memory_order_acquire)[offset];
+    }
+
+    /// Context of id followed by callSite
+    u32_t getChild(u32_t id, u32_t callSite);
+
+    /// Context of id without its oldest call site
+    u32_t dropFront(u32_t id);
+
+    /// Prefix of id with depth call sites
+    inline u32_t getAncestor(u32_t id, u32_t depth) const
+    {
+        while (getNode(id).depth > depth)
+            id = getNode(id).parent;
+        return id;
+    }
+
+    /// Whether callSite is in the context id
+    bool contains(u32_t id, u32_t callSite) const;
+
+    /// Lexicographic order of the call strings of two contexts, the oldest call site first
+    bool less(u32_t lhs, u32_t rhs) const;
+
+    /// Number of interned contexts, the empty one included
+    inline u32_t getCxtNum() const
+    {
+        return cxtNum.load(std::memory_order_relaxed);
+    }
+
+private:
+    /// Chunk c holds 2^(ChunkBits+c) nodes, so ChunkNum chunks cover every 32-bit id
+    static constexpr u32_t ChunkBits = 10;
+    static constexpr u32_t ChunkNum = 33 - ChunkBits;
+    static constexpr u32_t ShardBits = 6;
+
+    /// Children of the nodes whose <parent, call site> hash into the shard
+    struct alignas(64) Shard
+    {
+        std::mutex mutex;
+        Map<u64_t, u32_t> children; ///< <parent, call site> to node
+    };
+
+    CallStrCxtTable();
+
+    /// Chunk of id and its offset in the chunk
+    static inline void locate(u32_t id, u32_t& chunk, u32_t& offset)
+    {
+        u64_t pos = (u64_t) id + (1u << ChunkBits);
+        u32_t bits = 63 - __builtin_clzll(pos);
+        chunk = bits - ChunkBits;
+        offset = (u32_t) (pos - ((u64_t) 1 << bits));
+    }
+
+    /// Create a node, the caller holds the lock of the shard of <parent, callSite>
+    u32_t addNode(u32_t parent, u32_t callSite);
+
+    /// Nodes are allocated in chunks of doubling size when first used. Chunks never
+    /// move, so that readers do not need a lock
+    std::atomic<Node*> chunks[ChunkNum];
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<u32_t> cxtNum;
+};
+
+/*!
+ * Calling context as a string of call site IDs, the oldest first
+ */
+class CallStrCxt
+{
+public:
+    /// Iterator over the call sites, the oldest first. The trie links a context to its
+    /// parent only, so begin() reads the call sites once into a path shared by the copies.
+    /// Iterators of the same context compare by position.
+    class const_iterator
+    {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef u32_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const u32_t* pointer;
+        typedef u32_t reference;
+
+        const_iterator(std::shared_ptr<const std::vector<u32_t>> path, u32_t index) : path(std::move(path)), index(index) {}
+
+        inline u32_t operator*() const
+        {
+            return (*path)[index];
+        }
+        inline const_iterator& operator++()
+        {
+            ++index;
+            return *this;
+        }
+        inline const_iterator operator++(int)
+        {
+            const_iterator it = *this;
+            ++index;
+            return it;
+        }
+        inline bool operator==(const const_iterator& rhs) const
+        {
+            return index == rhs.index;
+        }
+        inline bool operator!=(const const_iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        std::shared_ptr<const std::vector<u32_t>> path;
+        u32_t index;
+    };
+
+    /// Empty context
+    CallStrCxt() : id(0) {}
+
+    inline u32_t getId() const
+    {
+        return id;
+    }
+
+    inline bool empty() const
+    {
+        return id == 0;
+    }
+
+    inline u32_t size() const
+    {
+        return CallStrCxtTable::getTable().getNode(id).depth;
+    }
+
+    /// Last call site
+    inline u32_t back() const
+    {
+        assert(!empty() && "empty context!");
+        return CallStrCxtTable::getTable().getNode(id).callSite;
+    }
+
+    inline void push_back(u32_t callSite)
+    {
+        id = CallStrCxtTable::getTable().getChild(id, callSite);
+    }
+
+    inline void pop_back()
+    {
+        assert(!empty() && "empty context!");
+        id = CallStrCxtTable::getTable().getNode(id).parent;
+    }
+
+    /// Remove the oldest call site, used when a context exceeds its length limit
+    inline void pop_front()
+    {
+        assert(!empty() && "empty context!");
+        id = CallStrCxtTable::getTable().dropFront(id);
+    }
+
+    inline void clear()
+    {
+        id = 0;
+    }
+
+    /// Whether callSite is in the context
+    inline bool contains(u32_t callSite) const
+    {
+        return CallStrCxtTable::getTable().contains(id, callSite);
+    }
+
+    inline u32_t operator[](u32_t index) const
+    {
+        assert(index < size());
+        const CallStrCxtTable& table = CallStrCxtTable::getTable();
+        return table.getNode(table.getAncestor(id, index + 1)).callSite;
+    }
+
+    const_iterator begin() const;
+
+    inline const_iterator end() const
+    {
+        return const_iterator(nullptr, size());
+    }
+
+    inline bool operator==(const CallStrCxt& rhs) const
+    {
+        return id == rhs.id;
+    }
+
+    inline bool operator!=(const CallStrCxt& rhs) const
+    {
+        return id != rhs.id;
+    }
+
+    /// Lexicographic order of the call strings, so that ordered containers keep the order of their contents
+    inline bool operator<(const CallStrCxt& rhs) const
+    {
+        return id != rhs.id && CallStrCxtTable::getTable().less(id, rhs.id);
+    }
+
+private:
+    u32_t id; ///< Node of the context in CallStrCxtTable
+};
+
+} // End namespace SVF
+
+template <> struct std::hash<SVF::CallStrCxt>
+{
+    size_t operator()(const SVF::CallStrCxt& cxt) const
+    {
+        std::hash<SVF::u32_t> h;
+        return h(cxt.getId());
+    }
+};
+
+#endif // SVF_UTIL_CALLSTRCXT_H
@@ -31,6 +31,7 @@
 #define INCLUDE_UTIL_CXTSTMT_H_
 
 #include "SVFIR/SVFValue.h"
+#include "Util/CallStrCxt.h"
 
 namespace SVF
 {
@@ -469,25 +470,24 @@ template <> struct std::hash<SVF::CxtThreadProc>
 {
     size_t operator()(const SVF::CxtThreadProc& ctp) const
     {
-        std::hash<SVF::NodeID> h;
-        return h(ctp.getTid());
+        std::hash<SVF::NodePair> h;
+        return h(std::make_pair(ctp.getTid(), ctp.getContext().getId()));
     }
 };
 template <> struct std::hash<SVF::CxtThreadStmt>
 {
     size_t operator()(const SVF::CxtThreadStmt& cts) const
     {
-        std::hash<SVF::NodeID> h;
-        return h(cts.getTid());
+        std::hash<SVF::NodePair> h;
+        return h(std::make_pair(cts.getStmt()->getId(), cts.getContext().getId()));
     }
 };
 template <> struct std::hash<SVF::CxtStmt>
 {
     size_t operator()(const SVF::CxtStmt& cs) const
     {
-        std::hash<SVF::ICFGNode*> h;
-        SVF::ICFGNode* inst = const_cast<SVF::ICFGNode*> (cs.getStmt());
-        return h(inst);
+        std::hash<SVF::NodePair> h;
+        return h(std::make_pair(cs.getStmt()->getId(), cs.getContext().getId()));
     }
 };
 template <> struct std::hash<SVF::CxtProc>
@@ -31,7 +31,9 @@
 #define DPITEM_H_
 
 #include "MemoryModel/ConditionalPT.h"
+#include "Util/CallStrCxt.h"
 #include <algorithm>    // std::sort
+#include <atomic>
 
 namespace SVF
 {
@@ -45,7 +47,7 @@ class DPItem
 {
 protected:
     NodeID cur;
-    static u64_t maximumBudget;
+    static thread_local u64_t maximumBudget; ///< set per query by the solver running on this thread
 
 public:
     /// Constructor
@@ -254,7 +256,7 @@ public:
     /// Whether contains callstring cxt
     inline bool containCallStr(NodeID cxt) const
     {
-        return std::find(context.begin(),context.end(),cxt) != context.end();
+        return context.contains(cxt);
     }
     /// Get context size
     inline u32_t cxtSize() const
@@ -292,7 +294,7 @@ public:
             if(!context.empty())
             {
                 setNonConcreteCxt();
-                context.erase(context.begin());
+                context.pop_front();
                 context.push_back(ctx);
             }
             return false;
@@ -375,7 +377,7 @@ protected:
     static u32_t maximumPathLen;
     bool concreteCxt;
 public:
-    static u32_t maximumCxt;
+    static std::atomic<u32_t> maximumCxt; ///< updated by concurrent slicing threads
     static u32_t maximumPath;
 };
 
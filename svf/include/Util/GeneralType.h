@@ -119,7 +119,6 @@ template <typename Key, typename Value, typename Hash = Hash<Key>,
                     typedef std::list<NodeID> NodeList;
                     typedef std::deque<NodeID> NodeDeque;
                     typedef NodeSet EdgeSet;
-                    typedef std::vector<u32_t> CallStrCxt;
                     typedef unsigned Version;
                     typedef Set<Version> VersionSet;
                     typedef std::pair<NodeID, Version> VersionedVar;
@@ -84,14 +84,24 @@ public:
     static const Option<std::string> UserInputQuery;
     static const Option<bool> InsenRecur;
     static const Option<bool> InsenCycle;
+    static const Option<std::string> DDAInsenEdgeFile;
     static const Option<bool> PrintCPts;
     static const Option<bool> PrintQueryPts;
     static const Option<bool> WPANum;
     static OptionMultiple<PointerAnalysis::PTATY> DDASelected;
+    static const Option<bool> DDAServer;
+    static const Option<u32_t> DDAServerThreads;
+    static const Option<bool> DDAServerCheck;
 
     // FlowDDA.cpp
     static const Option<u32_t> FlowBudget;
 
+    // DDAVFSolver.h
+    static const Option<bool> DDABatchQueries;
+    static const Option<u32_t> DDAQueryCacheSize;
+    static const Option<u32_t> DDATrialBudget;
+    static const Option<std::string> DDAQueryReport;
+
     // Offline constraint graph (OfflineConsG.cpp)
     static const Option<bool> OCGDotGraph;
 
@@ -151,16 +161,30 @@ public:
     // LockAnalysis.cpp
     static const Option<bool> IntraLock;
     static const Option<bool> PrintLockSpan;
+    static const Option<u32_t> LockThreads;
 
     // MHP.cpp
     static const Option<bool> PrintInterLev;
     static const Option<bool> DoLockAnalysis;
+    static const Option<u32_t> MHPThreads;
 
     //MTAStat.cpp
     static const Option<bool> AllPairMHP;
 
+    // MTA.cpp
+    static const Option<u32_t> RaceThreads;
+    static const Option<std::string> RaceReport;
+    static const Option<bool> FSMPTA;
+
+    // FSMPTA.cpp
+    static const Option<u32_t> FSMPTAThreads;
+    static const Option<bool> FSMPTALockedEdges;
+
     // TCT.cpp
     static const Option<bool> TCTDotGraph;
+    static const Option<u32_t> TCTThreads;
+    static const Option<std::string> WriteTCT;
+    static const Option<std::string> ReadTCT;
 
     // LeakChecker.cpp
     static const Option<bool> ValidateTests;
@@ -168,6 +192,8 @@ public:
     // Source-sink analyzer (SrcSnkDDA.cpp)
     static const Option<bool> DumpSlice;
     static const Option<u32_t> CxtLimit;
+    static const Option<u32_t> SaberThreads;
+    static const Option<bool> SaberFWSummary;
 
     // CHG.cpp
     static const Option<bool> DumpCHA;
@@ -194,6 +220,8 @@ public:
 
     // SaberCondAllocator.cpp
     static const Option<bool> PrintPathCond;
+    static const Option<u32_t> CondTableVars;
+    static const OptionMap<u32_t> SaberCondBackend;
 
     // SaberSVFGBuilder.cpp
     static const Option<bool> CollectExtRetGlobals;
@@ -233,6 +261,10 @@ public:
     static const Option<bool>  CFLSVFG;
     static const Option<bool> POCRAlias;
     static const Option<bool> POCRHybrid;
+    static const Option<bool> CFLMatrix;
+    static const Option<u32_t> CFLThreads;
+    static const Option<std::string> CFLClosureIn;
+    static const Option<std::string> CFLClosureOut;
     static const Option<bool> Customized;
 
     // Loop Analysis
@@ -243,6 +275,8 @@ public:
     static const Option<u32_t> WidenDelay;
     /// recursion handling mode, Default: TOP
     static const OptionMap<u32_t> HandleRecur;
+    /// widening operator at cycle heads, Default: standard
+    static const OptionMap<u32_t> WidenStrategy;
     /// the max time consumptions (seconds). Default: 4 hours 14400s
     static const Option<u32_t> Timeout;
     /// bug info output file, Default: output.db
@@ -267,6 +301,18 @@ public:
 
     // float precision for symbolic abstraction
     static const Option<u32_t> AEPrecision;
+
+    /// relational zone (DBM) domain on packed variables, Default: false
+    static const Option<bool> ZoneDomain;
+    /// max number of variables in one zone pack, Default: 8
+    static const Option<u32_t> ZonePackSize;
+
+    /// reuse function summaries keyed by function content and entry state, Default: false
+    static const Option<bool> AESummary;
+    /// file to load summaries from and save them to across runs, Default: ""
+    static const Option<std::string> AESummaryFile;
+    /// drop dead abstract states once a callee has been analysed, Default: false
+    static const Option<bool> AEEvictStates;
 };
 }  // namespace SVF
 
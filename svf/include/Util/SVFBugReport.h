@@ -83,7 +83,7 @@ public:
     typedef std::vector<SVFBugEvent> EventStack;
 
 public:
-    enum BugType {FULLBUFOVERFLOW, PARTIALBUFOVERFLOW, NEVERFREE, PARTIALLEAK, DOUBLEFREE, FILENEVERCLOSE, FILEPARTIALCLOSE, FULLNULLPTRDEREFERENCE, PARTIALNULLPTRDEREFERENCE};
+    enum BugType {FULLBUFOVERFLOW, PARTIALBUFOVERFLOW, NEVERFREE, PARTIALLEAK, DOUBLEFREE, FILENEVERCLOSE, FILEPARTIALCLOSE, FULLNULLPTRDEREFERENCE, PARTIALNULLPTRDEREFERENCE, DATARACE};
     static const std::map<GenericBug::BugType, std::string> BugType2Str;
 
 protected:
@@ -285,6 +285,27 @@ public:
     }
 };
 
+/// A load and a store that may access the same object in parallel without a common lock.
+/// The event stack holds the load followed by the store, hence the bug location is the store.
+class DataRaceBug : public GenericBug
+{
+public:
+    DataRaceBug(const EventStack &bugEventStack):
+        GenericBug(GenericBug::DATARACE, bugEventStack)
+    {
+        assert(bugEventStack.size() == 2 && "a data race has a load and a store event!");
+    }
+
+    cJSON *getBugDescription() const;
+    void printBugToTerminal() const;
+
+    /// ClassOf
+    static inline bool classof(const GenericBug *bug)
+    {
+        return bug->getBugType() == GenericBug::DATARACE;
+    }
+};
+
 class SVFBugReport
 {
 public:
@@ -406,6 +427,34 @@ public:
         //newBug->printBugToTerminal();
     }
 
+    /*
+     * function: pass bug type (i.e., GenericBug::DATARACE) and eventStack as parameter,
+     *      it will add the bug into bugQueue.
+     * usage: addMTABug(GenericBug::DATARACE, eventStack)
+     */
+    void addMTABug(GenericBug::BugType bugType, const GenericBug::EventStack &eventStack)
+    {
+        /// create and add the bug
+        GenericBug *newBug = nullptr;
+        switch(bugType)
+        {
+        case GenericBug::DATARACE:
+        {
+            newBug = new DataRaceBug(eventStack);
+            bugSet.insert(newBug);
+            break;
+        }
+        default:
+        {
+            assert(false && "MTA does NOT have this bug type!");
+            break;
+        }
+        }
+
+        // when add a bug, also print it to terminal
+        newBug->printBugToTerminal();
+    }
+
     /*
      * function: pass file path, open the file and dump bug report as JSON format
      * usage: dumpToFile("/path/to/file")
@@ -57,6 +57,12 @@ u32_t AbstractState::hash() const
 }
 
 AbstractState AbstractState::widening(const AbstractState& other)
+{
+    // Without thresholds, unstable bounds go to infinity directly
+    return widening(other, OrderedSet<s64_t>());
+}
+
+AbstractState AbstractState::widening(const AbstractState& other, const OrderedSet<s64_t>& thresholds)
 {
     // widen interval
     AbstractState es = *this;
@@ -65,14 +71,28 @@ AbstractState AbstractState::widening(const AbstractState& other)
         auto key = it->first;
         if (other._varToAbsVal.find(key) != other._varToAbsVal.end())
             if (it->second.isInterval() && other._varToAbsVal.at(key).isInterval())
-                it->second.getInterval().widen_with(other._varToAbsVal.at(key).getInterval());
+                it->second.getInterval().widen_with(other._varToAbsVal.at(key).getInterval(), thresholds);
     }
     for (auto it = es._addrToAbsVal.begin(); it != es._addrToAbsVal.end(); ++it)
     {
         auto key = it->first;
         if (other._addrToAbsVal.find(key) != other._addrToAbsVal.end())
             if (it->second.isInterval() && other._addrToAbsVal.at(key).isInterval())
-                it->second.getInterval().widen_with(other._addrToAbsVal.at(key).getInterval());
+                it->second.getInterval().widen_with(other._addrToAbsVal.at(key).getInterval(), thresholds);
+    }
+    // A pack missing in other is unconstrained there, so widening drops it to top
+    for (auto it = es._packToDBM.begin(); it != es._packToDBM.end();)
+    {
+        auto oit = other._packToDBM.find(it->first);
+        if (oit == other._packToDBM.end())
+        {
+            it = es._packToDBM.erase(it);
+        }
+        else
+        {
+            it->second.widenWith(oit->second);
+            ++it;
+        }
     }
     return es;
 }
@@ -94,6 +114,12 @@ AbstractState AbstractState::narrowing(const AbstractState& other)
             if (it->second.isInterval() && other._addrToAbsVal.at(key).isInterval())
                 it->second.getInterval().narrow_with(other._addrToAbsVal.at(key).getInterval());
     }
+    for (auto it = es._packToDBM.begin(); it != es._packToDBM.end(); ++it)
+    {
+        auto oit = other._packToDBM.find(it->first);
+        if (oit != other._packToDBM.end())
+            it->second.narrowWith(oit->second);
+    }
     return es;
 
 }
@@ -128,6 +154,20 @@ void AbstractState::joinWith(const AbstractState& other)
         }
     }
     _freedAddrs.insert(other._freedAddrs.begin(), other._freedAddrs.end());
+    // A pack missing on either side is unconstrained (top), so it stays top after the join
+    for (auto it = _packToDBM.begin(); it != _packToDBM.end();)
+    {
+        auto oit = other._packToDBM.find(it->first);
+        if (oit == other._packToDBM.end())
+        {
+            it = _packToDBM.erase(it);
+        }
+        else
+        {
+            it->second.joinWith(oit->second);
+            ++it;
+        }
+    }
 }
 
 /// domain meet with other, important! other widen this.
@@ -151,6 +191,14 @@ void AbstractState::meetWith(const AbstractState& other)
             oit->second.meet_with(it->second);
         }
     }
+    for (auto it = other._packToDBM.begin(); it != other._packToDBM.end(); ++it)
+    {
+        auto oit = _packToDBM.find(it->first);
+        if (oit != _packToDBM.end())
+            oit->second.meetWith(it->second);
+        else
+            _packToDBM.emplace(it->first, it->second);
+    }
     Set<NodeID> intersection;
     std::set_intersection(_freedAddrs.begin(), _freedAddrs.end(),
                           other._freedAddrs.begin(), other._freedAddrs.end(),
@@ -0,0 +1,356 @@
+//===- ZoneDomain.cpp ----Zone (Difference-Bound Matrix) Domain-------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * ZoneDomain.cpp
+ *
+ */
+
+#include "AE/Core/ZoneDomain.h"
+#include <sstream>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+bool DBM::isTop() const
+{
+    if (_bottom)
+        return false;
+    for (u32_t i = 0; i < _dim; ++i)
+        for (u32_t j = 0; j < _dim; ++j)
+            if (i != j && get(i, j) != INF)
+                return false;
+    return true;
+}
+
+IntervalValue DBM::getInterval(u32_t k) const
+{
+    if (_bottom)
+        return IntervalValue::bottom();
+    Bound ub = get(0, k);
+    Bound negLb = get(k, 0);
+    return IntervalValue(negLb == INF ? IntervalValue::minus_infinity() : BoundedInt(-negLb),
+                         ub == INF ? IntervalValue::plus_infinity() : BoundedInt(ub));
+}
+
+void DBM::checkDiagonal()
+{
+    for (u32_t i = 0; i < _dim; ++i)
+    {
+        if (get(i, i) < 0)
+        {
+            _bottom = true;
+            return;
+        }
+        at(i, i) = 0;
+    }
+}
+
+void DBM::addConstraint(u32_t i, u32_t j, Bound c)
+{
+    if (_bottom || c >= get(i, j))
+        return;
+    // A negative cycle through the new edge means the DBM becomes empty
+    if (add(get(j, i), c) < 0)
+    {
+        _bottom = true;
+        return;
+    }
+    at(i, j) = c;
+    // Incremental closure: only paths going through the new edge (i,j) can be shortened
+    for (u32_t k = 0; k < _dim; ++k)
+    {
+        Bound ki = get(k, i);
+        if (ki == INF)
+            continue;
+        Bound kij = add(ki, c);
+        for (u32_t l = 0; l < _dim; ++l)
+        {
+            Bound viaNew = add(kij, get(j, l));
+            if (viaNew < get(k, l))
+                at(k, l) = viaNew;
+        }
+    }
+    checkDiagonal();
+}
+
+void DBM::meetInterval(u32_t k, const IntervalValue& itv)
+{
+    if (_bottom)
+        return;
+    if (itv.isBottom())
+    {
+        _bottom = true;
+        return;
+    }
+    if (!itv.ub().is_infinity())
+        addConstraint(0, k, itv.ub().getIntNumeral());
+    if (!itv.lb().is_infinity())
+        addConstraint(k, 0, -itv.lb().getIntNumeral());
+}
+
+void DBM::forget(u32_t k)
+{
+    if (_bottom)
+        return;
+    for (u32_t i = 0; i < _dim; ++i)
+    {
+        at(i, k) = INF;
+        at(k, i) = INF;
+    }
+    at(k, k) = 0;
+}
+
+void DBM::assign(u32_t x, u32_t y, Bound c)
+{
+    if (_bottom)
+        return;
+    if (x == y)
+    {
+        // x := x + c shifts every bound involving x
+        for (u32_t i = 0; i < _dim; ++i)
+        {
+            if (i == x)
+                continue;
+            at(i, x) = add(get(i, x), c);
+            at(x, i) = add(get(x, i), -c);
+        }
+        return;
+    }
+    forget(x);
+    // On a closed DBM, x = y + c inherits every bound of y shifted by c
+    for (u32_t i = 0; i < _dim; ++i)
+    {
+        if (i == x)
+            continue;
+        at(i, x) = add(get(i, y), c);
+        at(x, i) = add(get(y, i), -c);
+    }
+    at(y, x) = c;
+    at(x, y) = -c;
+}
+
+void DBM::close()
+{
+    if (_bottom)
+        return;
+    for (u32_t k = 0; k < _dim; ++k)
+    {
+        for (u32_t i = 0; i < _dim; ++i)
+        {
+            Bound ik = get(i, k);
+            if (ik == INF)
+                continue;
+            for (u32_t j = 0; j < _dim; ++j)
+            {
+                Bound viaK = add(ik, get(k, j));
+                if (viaK < get(i, j))
+                    at(i, j) = viaK;
+            }
+        }
+    }
+    checkDiagonal();
+}
+
+void DBM::joinWith(const DBM& other)
+{
+    assert(_dim == other._dim && "joining DBMs of different packs?");
+    if (other._bottom)
+        return;
+    if (_bottom)
+    {
+        *this = other;
+        return;
+    }
+    for (u32_t i = 0; i < _mat.size(); ++i)
+        _mat[i] = std::max(_mat[i], other._mat[i]);
+}
+
+void DBM::meetWith(const DBM& other)
+{
+    assert(_dim == other._dim && "meeting DBMs of different packs?");
+    if (_bottom)
+        return;
+    if (other._bottom)
+    {
+        _bottom = true;
+        return;
+    }
+    for (u32_t i = 0; i < _mat.size(); ++i)
+        _mat[i] = std::min(_mat[i], other._mat[i]);
+    close();
+}
+
+void DBM::widenWith(const DBM& other)
+{
+    assert(_dim == other._dim && "widening DBMs of different packs?");
+    if (other._bottom)
+        return;
+    if (_bottom)
+    {
+        *this = other;
+        return;
+    }
+    for (u32_t i = 0; i < _mat.size(); ++i)
+        _mat[i] = other._mat[i] <= _mat[i] ? _mat[i] : INF;
+}
+
+void DBM::narrowWith(const DBM& other)
+{
+    assert(_dim == other._dim && "narrowing DBMs of different packs?");
+    if (_bottom)
+        return;
+    if (other._bottom)
+    {
+        _bottom = true;
+        return;
+    }
+    for (u32_t i = 0; i < _mat.size(); ++i)
+        if (_mat[i] == INF)
+            _mat[i] = other._mat[i];
+    close();
+}
+
+bool DBM::leq(const DBM& other) const
+{
+    if (_bottom)
+        return true;
+    if (other._bottom)
+        return false;
+    for (u32_t i = 0; i < _mat.size(); ++i)
+        if (_mat[i] > other._mat[i])
+            return false;
+    return true;
+}
+
+bool DBM::equals(const DBM& other) const
+{
+    if (_bottom || other._bottom)
+        return _bottom == other._bottom;
+    return _dim == other._dim && _mat == other._mat;
+}
+
+std::string DBM::toString() const
+{
+    if (_bottom)
+        return "DBM: bottom";
+    std::stringstream rawstr;
+    rawstr << "DBM(" << _dim - 1 << " vars):";
+    for (u32_t i = 0; i < _dim; ++i)
+    {
+        for (u32_t j = 0; j < _dim; ++j)
+        {
+            if (i == j || get(i, j) == INF)
+                continue;
+            rawstr << " v" << j << "-v" << i << "<=" << get(i, j) << ";";
+        }
+    }
+    return rawstr.str();
+}
+
+bool ZonePacks::isPackable(const SVFVar* var) const
+{
+    if (!SVFUtil::isa<ValVar>(var) || var->isConstDataOrAggDataButNotNullPtr())
+        return false;
+    const SVFType* type = var->getType();
+    return type && SVFUtil::isa<SVFIntegerType>(type);
+}
+
+NodeID ZonePacks::find(NodeID var)
+{
+    auto it = parent.find(var);
+    if (it == parent.end())
+    {
+        parent[var] = var;
+        packSize[var] = 1;
+        return var;
+    }
+    if (it->second == var)
+        return var;
+    NodeID root = find(it->second);
+    parent[var] = root;
+    return root;
+}
+
+void ZonePacks::unite(NodeID v1, NodeID v2)
+{
+    NodeID r1 = find(v1), r2 = find(v2);
+    if (r1 == r2)
+        return;
+    // Keep packs small so that the cubic closure stays cheap
+    if (packSize[r1] + packSize[r2] > maxPackSize)
+        return;
+    if (packSize[r1] < packSize[r2])
+        std::swap(r1, r2);
+    parent[r2] = r1;
+    packSize[r1] += packSize[r2];
+}
+
+void ZonePacks::build(SVFIR* pag)
+{
+    auto relate = [&](NodeID v1, NodeID v2)
+    {
+        if (isPackable(pag->getGNode(v1)) && isPackable(pag->getGNode(v2)))
+            unite(v1, v2);
+    };
+
+    for (const SVFStmt* stmt : pag->getSVFStmtSet(SVFStmt::Cmp))
+    {
+        const CmpStmt* cmp = SVFUtil::cast<CmpStmt>(stmt);
+        relate(cmp->getOpVarID(0), cmp->getOpVarID(1));
+    }
+    for (const SVFStmt* stmt : pag->getSVFStmtSet(SVFStmt::BinaryOp))
+    {
+        const BinaryOPStmt* binary = SVFUtil::cast<BinaryOPStmt>(stmt);
+        // Only additive operations yield difference constraints
+        if (binary->getOpcode() != BinaryOPStmt::Add && binary->getOpcode() != BinaryOPStmt::Sub)
+            continue;
+        relate(binary->getResID(), binary->getOpVarID(0));
+        relate(binary->getResID(), binary->getOpVarID(1));
+    }
+    for (const SVFStmt* stmt : pag->getSVFStmtSet(SVFStmt::Copy))
+    {
+        const CopyStmt* copy = SVFUtil::cast<CopyStmt>(stmt);
+        if (copy->getCopyKind() == CopyStmt::COPYVAL || copy->getCopyKind() == CopyStmt::SEXT)
+            relate(copy->getLHSVarID(), copy->getRHSVarID());
+    }
+
+    // Materialise the packs; singleton packs carry no relation and are dropped
+    Map<NodeID, std::vector<NodeID>> rootToMembers;
+    OrderedSet<NodeID> vars;
+    for (const auto& it : parent)
+        vars.insert(it.first);
+    for (NodeID var : vars)
+        rootToMembers[find(var)].push_back(var);
+    OrderedSet<NodeID> roots;
+    for (const auto& it : rootToMembers)
+        roots.insert(it.first);
+    for (NodeID root : roots)
+    {
+        const std::vector<NodeID>& members = rootToMembers[root];
+        if (members.size() < 2)
+            continue;
+        u32_t packId = packs.size();
+        for (u32_t i = 0; i < members.size(); ++i)
+            varToSlot[members[i]] = std::make_pair(packId, i + 1);
+        packs.push_back(members);
+    }
+}
@@ -176,6 +176,23 @@ void BufOverflowDetector::handleStubFunctions(const SVF::CallICFGNode* callNode)
     }
 }
 
+/**
+ * @brief Replays the side effects recorded while a function summary was built.
+ *
+ * GEP object offsets are restored first since they are the inputs of later
+ * buffer checks; bugs are then reported again at their original locations.
+ *
+ * @param journal The journal recorded by a buffer overflow detector.
+ */
+void BufOverflowDetector::replayJournal(const AEDetectorJournal& journal)
+{
+    SVFIR* svfir = PAG::getPAG();
+    for (const auto& it : journal.gepObjOffsets)
+        addToGepObjOffsetFromBase(SVFUtil::cast<GepObjVar>(svfir->getGNode(it.first)), it.second);
+    for (const auto& it : journal.bugs)
+        addBugToReporter(AEException(it.second), svfir->getICFG()->getICFGNode(it.first));
+}
+
 /**
  * @brief Initializes external API buffer overflow check rules.
  *
@@ -565,6 +582,12 @@ void NullptrDerefDetector::detect(AbstractState& as, const ICFGNode* node)
     }
 }
 
+void NullptrDerefDetector::replayJournal(const AEDetectorJournal& journal)
+{
+    ICFG* icfg = PAG::getPAG()->getICFG();
+    for (const auto& it : journal.bugs)
+        addBugToReporter(AEException(it.second), icfg->getICFGNode(it.first));
+}
 
 void NullptrDerefDetector::handleStubFunctions(const CallICFGNode* callNode)
 {
@@ -0,0 +1,834 @@
+//===- AESummary.cpp -- Function summaries for Abstract Execution-------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * AESummary.cpp
+ *
+ */
+
+#include "AE/Svfexe/AESummary.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+namespace
+{
+
+/// splitmix64 finalizer
+inline u64_t fmix(u64_t h)
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+/// Order-dependent combination
+inline u64_t combine(u64_t seed, u64_t v)
+{
+    return fmix(seed ^ (v + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+inline u64_t hashString(const std::string& str)
+{
+    u64_t h = 0xcbf29ce484222325ULL;
+    for (char c : str)
+    {
+        h ^= (unsigned char) c;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+inline u64_t hashBound(const BoundedInt& b)
+{
+    if (b.is_plus_infinity())
+        return 0x7ff0000000000001ULL;
+    if (b.is_minus_infinity())
+        return 0xfff0000000000001ULL;
+    return (u64_t) b.getNumeral();
+}
+
+u64_t hashValue(const AbstractValue& val)
+{
+    u64_t h = combine(hashBound(val.getInterval().lb()), hashBound(val.getInterval().ub()));
+    const AddressValue addrs = val.getAddrs();
+    u64_t addrHash = 0;
+    for (u32_t addr : addrs.getVals())
+        addrHash += fmix(addr);
+    return combine(h, addrHash);
+}
+
+/// Hash of the constant, global or special variable an SVFVar stands for, 0 if it is local to a function
+u64_t hashContent(const SVFVar* var)
+{
+    NodeID id = var->getId();
+    if (IRGraph::isBlkPtr(id) || IRGraph::isNullPtr(id) || IRGraph::isBlkObjOrConstantObj(id))
+        return combine(var->getNodeKind(), id);
+    u64_t h = combine(var->getNodeKind(), var->getType() ? hashString(var->getType()->toString()) : 0);
+    if (const ConstIntValVar* intVar = dyn_cast<ConstIntValVar>(var))
+        return combine(h, (u64_t) intVar->getSExtValue());
+    if (const ConstIntObjVar* intObj = dyn_cast<ConstIntObjVar>(var))
+        return combine(h, (u64_t) intObj->getSExtValue());
+    double d;
+    if (const ConstFPValVar* fpVar = dyn_cast<ConstFPValVar>(var))
+        d = fpVar->getFPValue();
+    else if (const ConstFPObjVar* fpObj = dyn_cast<ConstFPObjVar>(var))
+        d = fpObj->getFPValue();
+    else
+    {
+        if (isa<FunObjVar>(var) || isa<FunValVar>(var) || (var->getFunction() == nullptr && !var->getName().empty()))
+            return combine(h, hashString(var->getName()));
+        return 0;
+    }
+    u64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    return combine(h, bits);
+}
+
+/// Print a bound in the format read back by readBound
+void writeBound(std::ostream& os, const BoundedInt& b)
+{
+    if (b.is_plus_infinity())
+        os << "+inf";
+    else if (b.is_minus_infinity())
+        os << "-inf";
+    else
+        os << b.getNumeral();
+}
+
+BoundedInt readBound(std::istream& is)
+{
+    std::string tok;
+    is >> tok;
+    if (tok == "+inf")
+        return BoundedInt::plus_infinity();
+    if (tok == "-inf")
+        return BoundedInt::minus_infinity();
+    return BoundedInt((s64_t) std::stoll(tok));
+}
+
+} // End anonymous namespace
+
+u64_t AESummaryCache::hashVar(const SVFVar* var, FunScope& scope)
+{
+    u64_t h = hashContent(var);
+    if (h != 0)
+        addVarName(var->getId(), h);
+    else if (const GepObjVar* gepObj = dyn_cast<GepObjVar>(var))
+    {
+        // Field objects are named after their base objects when written, see getVarName
+        const SVFVar* base = SVFIR::getPAG()->getGNode(gepObj->getBaseNode());
+        return combine(hashVar(base, scope), (u64_t) gepObj->getConstantFieldIdx());
+    }
+    else
+    {
+        u32_t idx = scope.vars.emplace(var->getId(), scope.vars.size()).first->second;
+        h = combine(var->getNodeKind(), idx);
+        addVarName(var->getId(), combine(scope.name, h));
+    }
+    if (const BaseObjVar* obj = dyn_cast<BaseObjVar>(var))
+    {
+        h = combine(h, obj->getByteSizeOfObj());
+        h = combine(h, obj->getNumOfElements());
+    }
+    return h;
+}
+
+u64_t AESummaryCache::hashStmt(const SVFStmt* stmt, FunScope& scope)
+{
+    u64_t h = combine(stmt->getEdgeKind(), hashVar(stmt->getSrcNode(), scope));
+    h = combine(h, hashVar(stmt->getDstNode(), scope));
+    if (const MultiOpndStmt* multi = dyn_cast<MultiOpndStmt>(stmt))
+    {
+        for (const SVFVar* op : multi->getOpndVars())
+            h = combine(h, hashVar(op, scope));
+        h = combine(h, hashVar(multi->getRes(), scope));
+    }
+    if (const CmpStmt* cmp = dyn_cast<CmpStmt>(stmt))
+        h = combine(h, cmp->getPredicate());
+    else if (const BinaryOPStmt* binary = dyn_cast<BinaryOPStmt>(stmt))
+        h = combine(h, binary->getOpcode());
+    else if (const UnaryOPStmt* unary = dyn_cast<UnaryOPStmt>(stmt))
+        h = combine(h, unary->getOpcode());
+    else if (const CopyStmt* copy = dyn_cast<CopyStmt>(stmt))
+        h = combine(h, copy->getCopyKind());
+    else if (const SelectStmt* select = dyn_cast<SelectStmt>(stmt))
+        h = combine(h, hashVar(select->getCondition(), scope));
+    else if (const PhiStmt* phi = dyn_cast<PhiStmt>(stmt))
+    {
+        for (u32_t i = 0; i < phi->getOpVarNum(); ++i)
+        {
+            auto it = scope.nodes.find(phi->getOpICFGNode(i));
+            h = combine(h, it == scope.nodes.end() ? 0 : it->second + 1);
+        }
+    }
+    else if (const GepStmt* gep = dyn_cast<GepStmt>(stmt))
+    {
+        h = combine(h, gep->isVariantFieldGep());
+        for (const auto& idx : gep->getOffsetVarAndGepTypePairVec())
+        {
+            h = combine(h, hashVar(idx.first, scope));
+            h = combine(h, idx.second ? idx.second->getByteSize() : 0);
+        }
+        if (gep->isConstantOffset())
+            h = combine(h, (u64_t) gep->accumulateConstantOffset());
+    }
+    return h;
+}
+
+/*!
+ * ICFG nodes are hashed by their position in the body and variables by their
+ * order of appearance (see hashVar), so that the hash does not depend on IDs.
+ * Only intra-procedural edges are covered, calls are covered by the call graph
+ * and the returns to the callers must not change the hash of a callee.
+ */
+u64_t AESummaryCache::hashFunBody(ICFG* icfg, const FunObjVar* fun)
+{
+    FunScope scope;
+    scope.name = hashString(fun->getName());
+    std::vector<const ICFGNode*> nodes;
+    nodes.push_back(icfg->getFunEntryICFGNode(fun));
+    for (const SVFBasicBlock* bb : fun->getReachableBBs())
+        for (const ICFGNode* node : bb->getICFGNodeList())
+            nodes.push_back(node);
+    nodes.push_back(icfg->getFunExitICFGNode(fun));
+    for (u32_t i = 0; i < nodes.size(); ++i)
+    {
+        if (scope.nodes.emplace(nodes[i], i).second)
+            addNodeName(nodes[i]->getId(), combine(scope.name, i));
+    }
+
+    u64_t h = scope.name;
+    for (const ICFGNode* node : nodes)
+    {
+        h = combine(h, combine(scope.nodes[node], node->getNodeKind()));
+        if (const FunEntryICFGNode* entry = dyn_cast<FunEntryICFGNode>(node))
+        {
+            for (const SVFVar* formal : entry->getFormalParms())
+                h = combine(h, hashVar(formal, scope));
+        }
+        else if (const FunExitICFGNode* exit = dyn_cast<FunExitICFGNode>(node))
+        {
+            if (exit->getFormalRet())
+                h = combine(h, hashVar(exit->getFormalRet(), scope));
+        }
+        for (const SVFStmt* stmt : node->getSVFStmts())
+            h = combine(h, hashStmt(stmt, scope));
+        // Edges are unordered, the branch conditions decide the feasibility of each of them
+        u64_t edges = 0;
+        for (const ICFGEdge* edge : node->getOutEdges())
+        {
+            const IntraCFGEdge* intraEdge = dyn_cast<IntraCFGEdge>(edge);
+            if (!intraEdge)
+                continue;
+            auto dst = scope.nodes.find(edge->getDstNode());
+            u64_t e = combine(dst == scope.nodes.end() ? 0 : dst->second + 1, edge->getEdgeKind());
+            if (intraEdge->getCondition())
+            {
+                e = combine(e, hashVar(intraEdge->getCondition(), scope));
+                e = combine(e, (u64_t) intraEdge->getSuccessorCondValue());
+            }
+            edges += fmix(e);
+        }
+        h = combine(h, edges);
+        // External calls are modelled by name and arguments
+        if (const CallICFGNode* call = dyn_cast<CallICFGNode>(node))
+        {
+            if (const FunObjVar* callee = call->getCalledFunction())
+                h = combine(h, hashString(callee->getName()));
+            for (const SVFVar* arg : call->getActualParms())
+                h = combine(h, hashVar(arg, scope));
+        }
+        else if (const RetICFGNode* ret = dyn_cast<RetICFGNode>(node))
+        {
+            if (ret->getActualRet())
+                h = combine(h, hashVar(ret->getActualRet(), scope));
+        }
+    }
+    return h;
+}
+
+void AESummaryCache::addVarName(NodeID id, u64_t name)
+{
+    if (!varToName.emplace(id, name).second)
+        return;
+    auto res = nameToVar.emplace(name, id);
+    if (!res.second && res.first->second != id)
+        ambiguousNames.insert(name);
+}
+
+void AESummaryCache::addNodeName(NodeID id, u64_t name)
+{
+    if (!nodeToName.emplace(id, name).second)
+        return;
+    auto res = nameToNode.emplace(name, id);
+    if (!res.second && res.first->second != id)
+        ambiguousNames.insert(name);
+}
+
+bool AESummaryCache::getVarName(NodeID id, u64_t& name, GepObjNames& gepObjNames) const
+{
+    auto it = varToName.find(id);
+    if (it != varToName.end())
+    {
+        name = it->second;
+        return !ambiguousNames.count(name);
+    }
+    // Field objects are created on demand by the analysis, they are named by their base objects
+    if (const GepObjVar* gepObj = dyn_cast<GepObjVar>(SVFIR::getPAG()->getGNode(id)))
+    {
+        u64_t baseName;
+        if (!getVarName(gepObj->getBaseNode(), baseName, gepObjNames))
+            return false;
+        name = combine(baseName, (u64_t) gepObj->getConstantFieldIdx());
+        gepObjNames[name] = std::make_pair(baseName, gepObj->getConstantFieldIdx());
+        return true;
+    }
+    return false;
+}
+
+bool AESummaryCache::getAddrName(u32_t addr, u64_t& name, GepObjNames& gepObjNames) const
+{
+    return AddressValue::isVirtualMemAddress(addr) &&
+           getVarName(addr & FlippedAddressMask, name, gepObjNames);
+}
+
+bool AESummaryCache::getNodeName(NodeID id, u64_t& name) const
+{
+    auto it = nodeToName.find(id);
+    if (it == nodeToName.end())
+        return false;
+    name = it->second;
+    return !ambiguousNames.count(name);
+}
+
+bool AESummaryCache::getNamedVar(u64_t name, NodeID& id) const
+{
+    auto it = nameToVar.find(name);
+    if (it == nameToVar.end() || ambiguousNames.count(name))
+        return false;
+    id = it->second;
+    return true;
+}
+
+bool AESummaryCache::getNamedNode(u64_t name, NodeID& id) const
+{
+    auto it = nameToNode.find(name);
+    if (it == nameToNode.end() || ambiguousNames.count(name))
+        return false;
+    id = it->second;
+    return true;
+}
+
+u64_t AESummaryCache::hashSCC(NodeID rep, CallGraph* callGraph, CallGraphSCC* callGraphScc,
+                              const Map<NodeID, u64_t>& ownHashes, Map<NodeID, u64_t>& sccHashes) const
+{
+    auto it = sccHashes.find(rep);
+    if (it != sccHashes.end())
+        return it->second;
+
+    OrderedSet<u64_t> members;
+    OrderedSet<u64_t> callees;
+    for (NodeID id : callGraphScc->subNodes(rep))
+    {
+        members.insert(ownHashes.at(id));
+        for (const CallGraphEdge* edge : callGraph->getGNode(id)->getOutEdges())
+        {
+            NodeID calleeRep = callGraphScc->repNode(edge->getDstID());
+            if (calleeRep != rep)
+                callees.insert(hashSCC(calleeRep, callGraph, callGraphScc, ownHashes, sccHashes));
+        }
+    }
+    u64_t h = members.size();
+    for (u64_t m : members)
+        h = combine(h, m);
+    for (u64_t c : callees)
+        h = combine(h, c);
+    sccHashes[rep] = h;
+    return h;
+}
+
+/*!
+ * A function hash is the hash of its own body combined with the hash of its
+ * call graph SCC, which transitively covers the bodies of all callees. A change
+ * in any callee thus invalidates the summaries of all its callers.
+ */
+void AESummaryCache::computeFunHashes(ICFG* icfg, CallGraph* callGraph, CallGraphSCC* callGraphScc)
+{
+    // Name the variables of the global initializers
+    FunScope globalScope;
+    globalScope.name = 0;
+    for (const SVFStmt* stmt : icfg->getGlobalICFGNode()->getSVFStmts())
+        hashStmt(stmt, globalScope);
+    addNodeName(icfg->getGlobalICFGNode()->getId(), 0);
+
+    Map<NodeID, u64_t> ownHashes;
+    for (const auto& it : *callGraph)
+    {
+        const FunObjVar* fun = it.second->getFunction();
+        ownHashes[it.first] = fun->isDeclaration() ? hashString(fun->getName()) : hashFunBody(icfg, fun);
+    }
+    Map<NodeID, u64_t> sccHashes;
+    for (const auto& it : *callGraph)
+    {
+        NodeID rep = callGraphScc->repNode(it.first);
+        u64_t sccHash = hashSCC(rep, callGraph, callGraphScc, ownHashes, sccHashes);
+        funToHash[it.second->getFunction()] = combine(ownHashes[it.first], sccHash);
+    }
+}
+
+u64_t AESummaryCache::hashState(const AbstractState& as)
+{
+    u64_t vars = 0, addrs = 0, freed = 0, zones = 0;
+    for (const auto& it : as.getVarToVal())
+        vars += fmix(combine(it.first, hashValue(it.second)));
+    for (const auto& it : as.getLocToVal())
+        addrs += fmix(combine(it.first, hashValue(it.second)));
+    for (NodeID addr : as._freedAddrs)
+        freed += fmix(addr);
+    for (const auto& it : as.getPackToDBM())
+    {
+        const DBM& dbm = it.second;
+        u64_t h = combine(it.first, dbm.isBottom());
+        if (!dbm.isBottom())
+            for (u32_t i = 0; i < dbm.dim(); ++i)
+                for (u32_t j = 0; j < dbm.dim(); ++j)
+                    h = combine(h, (u64_t) dbm.get(i, j));
+        zones += fmix(h);
+    }
+    return combine(combine(combine(vars, addrs), freed), zones);
+}
+
+void AESummaryCache::makeDelta(const AbstractState& entry, const AbstractState& exit, FunSummary& summary)
+{
+    summary.hasExit = true;
+    for (const auto& it : exit.getVarToVal())
+    {
+        auto entryIt = entry.getVarToVal().find(it.first);
+        if (entryIt == entry.getVarToVal().end() || !entryIt->second.equals(it.second))
+            summary.varDelta[it.first] = it.second;
+    }
+    for (const auto& it : entry.getVarToVal())
+        if (exit.getVarToVal().find(it.first) == exit.getVarToVal().end())
+            summary.removedVars.insert(it.first);
+    for (const auto& it : exit.getLocToVal())
+    {
+        auto entryIt = entry.getLocToVal().find(it.first);
+        if (entryIt == entry.getLocToVal().end() || !entryIt->second.equals(it.second))
+            summary.addrDelta[it.first] = it.second;
+    }
+    for (const auto& it : entry.getLocToVal())
+        if (exit.getLocToVal().find(it.first) == exit.getLocToVal().end())
+            summary.removedAddrs.insert(it.first);
+    for (NodeID addr : exit._freedAddrs)
+        if (!entry._freedAddrs.count(addr))
+            summary.freedAdded.insert(addr);
+    for (NodeID addr : entry._freedAddrs)
+        if (!exit._freedAddrs.count(addr))
+            summary.freedRemoved.insert(addr);
+    summary.exitDBMs = exit.getPackToDBM();
+}
+
+void AESummaryCache::applyDelta(const FunSummary& summary, AbstractState& as)
+{
+    assert(summary.hasExit && "no exit state to apply!");
+    for (u32_t id : summary.removedVars)
+        as._varToAbsVal.erase(id);
+    for (const auto& it : summary.varDelta)
+        as._varToAbsVal[it.first] = it.second;
+    for (u32_t addr : summary.removedAddrs)
+        as._addrToAbsVal.erase(addr);
+    for (const auto& it : summary.addrDelta)
+        as._addrToAbsVal[it.first] = it.second;
+    for (NodeID addr : summary.freedRemoved)
+        as._freedAddrs.erase(addr);
+    for (NodeID addr : summary.freedAdded)
+        as._freedAddrs.insert(addr);
+    as._packToDBM = summary.exitDBMs;
+}
+
+bool AESummaryCache::sameState(const AbstractState& lhs, const AbstractState& rhs)
+{
+    return lhs.equals(rhs) && lhs._freedAddrs == rhs._freedAddrs;
+}
+
+bool AESummaryCache::writeValue(std::ostream& os, const std::string& tag, u64_t name, const AbstractValue& val,
+                                GepObjNames& gepObjNames) const
+{
+    os << tag << " " << name << " ";
+    writeBound(os, val.getInterval().lb());
+    os << " ";
+    writeBound(os, val.getInterval().ub());
+    const AddressValue addrs = val.getAddrs();
+    os << " " << addrs.getVals().size();
+    for (u32_t addr : addrs.getVals())
+    {
+        u64_t addrName;
+        if (!getAddrName(addr, addrName, gepObjNames))
+            return false;
+        os << " " << addrName;
+    }
+    os << "\n";
+    return true;
+}
+
+bool AESummaryCache::readValue(std::istream& is, NodeID& id, AbstractValue& val) const
+{
+    u64_t name;
+    u32_t addrNum;
+    is >> name;
+    bool known = getNamedVar(name, id);
+    BoundedInt lb = readBound(is);
+    BoundedInt ub = readBound(is);
+    val.getInterval() = IntervalValue(lb, ub);
+    is >> addrNum;
+    for (u32_t i = 0; i < addrNum; ++i)
+    {
+        u64_t addrName;
+        NodeID obj;
+        is >> addrName;
+        if (getNamedVar(addrName, obj))
+            val.getAddrs().insert(AddressMask + obj);
+        else
+            known = false;
+    }
+    return known;
+}
+
+bool AESummaryCache::writeState(std::ostream& os, const std::string& tag, const AbstractState::VarToAbsValMap& vars,
+                                const AbstractState::AddrToAbsValMap& addrs, const AbstractState::PackToDBMMap& dbms,
+                                GepObjNames& gepObjNames) const
+{
+    u64_t name;
+    for (const auto& v : vars)
+    {
+        if (!getVarName(v.first, name, gepObjNames) || !writeValue(os, tag + "V", name, v.second, gepObjNames))
+            return false;
+    }
+    for (const auto& a : addrs)
+    {
+        if (!getVarName(a.first, name, gepObjNames) || !writeValue(os, tag + "A", name, a.second, gepObjNames))
+            return false;
+    }
+    // A pack is written as its member variables, since pack IDs depend on the order of packing
+    for (const auto& d : dbms)
+    {
+        const DBM& dbm = d.second;
+        assert(zonePacks && "zones without packs?");
+        const std::vector<NodeID>& members = zonePacks->getPackVars(d.first);
+        os << tag << "D " << members.size();
+        for (NodeID member : members)
+        {
+            if (!getVarName(member, name, gepObjNames))
+                return false;
+            os << " " << name;
+        }
+        os << " " << dbm.isBottom();
+        if (!dbm.isBottom())
+            for (u32_t i = 0; i < dbm.dim(); ++i)
+                for (u32_t j = 0; j < dbm.dim(); ++j)
+                    os << " " << dbm.get(i, j);
+        os << "\n";
+    }
+    return true;
+}
+
+bool AESummaryCache::readDBM(std::istream& is, u32_t& packId, DBM& dbm) const
+{
+    u32_t memberNum;
+    is >> memberNum;
+    bool known = zonePacks != nullptr;
+    std::vector<NodeID> members(memberNum);
+    for (u32_t i = 0; i < memberNum; ++i)
+    {
+        u64_t name;
+        is >> name;
+        if (!getNamedVar(name, members[i]))
+            known = false;
+    }
+    if (known && memberNum > 0 && zonePacks->inPack(members[0]))
+    {
+        packId = zonePacks->getSlot(members[0]).first;
+        known = zonePacks->getPackVars(packId) == members;
+    }
+    else
+        known = false;
+    bool bottom;
+    is >> bottom;
+    dbm = DBM(memberNum + 1);
+    if (bottom)
+        dbm.setToBottom();
+    else
+    {
+        for (u32_t i = 0; i <= memberNum; ++i)
+            for (u32_t j = 0; j <= memberNum; ++j)
+            {
+                DBM::Bound c;
+                is >> c;
+                dbm.set(i, j, c);
+            }
+    }
+    return known;
+}
+
+bool AESummaryCache::writeSummary(std::ostream& os, u64_t funHash, const FunSummary& summary,
+                                  GepObjNames& gepObjNames) const
+{
+    u64_t name;
+    os << "S " << funHash << " " << summary.hasExit << "\n";
+    if (!writeState(os, "E", summary.entry.getVarToVal(), summary.entry.getLocToVal(),
+                    summary.entry.getPackToDBM(), gepObjNames))
+        return false;
+    for (NodeID addr : summary.entry._freedAddrs)
+    {
+        if (!getAddrName(addr, name, gepObjNames))
+            return false;
+        os << "EF " << name << "\n";
+    }
+    if (!writeState(os, "", summary.varDelta, summary.addrDelta, summary.exitDBMs, gepObjNames))
+        return false;
+    for (u32_t id : summary.removedVars)
+    {
+        if (!getVarName(id, name, gepObjNames))
+            return false;
+        os << "RV " << name << "\n";
+    }
+    for (u32_t id : summary.removedAddrs)
+    {
+        if (!getVarName(id, name, gepObjNames))
+            return false;
+        os << "RA " << name << "\n";
+    }
+    for (NodeID addr : summary.freedAdded)
+    {
+        if (!getAddrName(addr, name, gepObjNames))
+            return false;
+        os << "F+ " << name << "\n";
+    }
+    for (NodeID addr : summary.freedRemoved)
+    {
+        if (!getAddrName(addr, name, gepObjNames))
+            return false;
+        os << "F- " << name << "\n";
+    }
+    for (const AEDetectorJournal& journal : summary.journals)
+    {
+        os << "J " << journal.kind << "\n";
+        for (const auto& bug : journal.bugs)
+        {
+            if (!getNodeName(bug.first, name))
+                return false;
+            os << "B " << name << " " << bug.second.size() << "\n" << bug.second << "\n";
+        }
+        for (const auto& gep : journal.gepObjOffsets)
+        {
+            if (!getVarName(gep.first, name, gepObjNames))
+                return false;
+            os << "G " << name << " ";
+            writeBound(os, gep.second.lb());
+            os << " ";
+            writeBound(os, gep.second.ub());
+            os << "\n";
+        }
+    }
+    for (NodeID id : summary.dischargedCheckpoints)
+    {
+        if (!getNodeName(id, name))
+            return false;
+        os << "C " << name << "\n";
+    }
+    os << "E\n";
+    return true;
+}
+
+/*!
+ * Text format, one record per line, variables and ICFG nodes are referred to by name:
+ *   AE_SUMMARY_V2
+ *   N <name> <base name> <offset>                field object, before the summaries using it
+ *   S <function hash> <has exit>
+ *   EV|EA <name> <lb> <ub> <#addrs> <addr names...>  variable/memory of the entry state
+ *   EF <name>                                    freed object of the entry state
+ *   ED <#members> <member names...> <bottom> <dim*dim entries>  zone of the entry state
+ *   V|A <name> <lb> <ub> <#addrs> <addr names...>  changed variable/memory
+ *   RV|RA <name>                                 removed variable/memory
+ *   F+|F- <name>                                 freed object added/removed
+ *   D <#members> <member names...> <bottom> <dim*dim entries>  zone at the exit
+ *   J <detector kind>                            starts a detector journal
+ *   B <node name> <length>\n<bug info>           bug of the current journal
+ *   G <gep obj name> <lb> <ub>                   GEP offset of the current journal
+ *   C <node name>                                discharged checkpoint
+ *   E                                            end of summary
+ * A summary referring to a name without a unique variable or ICFG node in this
+ * run is skipped.
+ */
+bool AESummaryCache::readFromFile(const std::string& fileName)
+{
+    std::ifstream is(fileName);
+    if (!is.is_open())
+        return false;
+    std::string tok;
+    is >> tok;
+    if (tok != "AE_SUMMARY_V2")
+    {
+        SVFUtil::writeWrnMsg("ignoring summary file " + fileName + " of an unknown format");
+        return false;
+    }
+    auto malformed = [&]()
+    {
+        SVFUtil::writeWrnMsg("ignoring malformed summary file " + fileName);
+        summaries.clear();
+        loadedNum = 0;
+        return false;
+    };
+    while (is >> tok)
+    {
+        if (tok == "N")
+        {
+            u64_t name, baseName;
+            APOffset offset;
+            is >> name >> baseName >> offset;
+            NodeID base;
+            if (getNamedVar(baseName, base) && isa<BaseObjVar>(SVFIR::getPAG()->getGNode(base)))
+                addVarName(SVFIR::getPAG()->getGepObjVar(base, offset), name);
+            continue;
+        }
+        if (tok != "S")
+            return malformed();
+        u64_t funHash;
+        FunSummary summary;
+        bool known = true;
+        is >> funHash >> summary.hasExit;
+        while (is >> tok && tok != "E")
+        {
+            NodeID id = 0;
+            u64_t name;
+            if (tok == "EV" || tok == "EA" || tok == "V" || tok == "A")
+            {
+                AbstractValue val;
+                known &= readValue(is, id, val);
+                if (tok == "EV")
+                    summary.entry._varToAbsVal[id] = val;
+                else if (tok == "EA")
+                    summary.entry._addrToAbsVal[id] = val;
+                else
+                    (tok == "V" ? summary.varDelta : summary.addrDelta)[id] = val;
+            }
+            else if (tok == "ED" || tok == "D")
+            {
+                u32_t packId = 0;
+                DBM dbm(1);
+                known &= readDBM(is, packId, dbm);
+                (tok == "ED" ? summary.entry._packToDBM : summary.exitDBMs)[packId] = dbm;
+            }
+            else if (tok == "RV" || tok == "RA")
+            {
+                is >> name;
+                known &= getNamedVar(name, id);
+                (tok == "RV" ? summary.removedVars : summary.removedAddrs).insert(id);
+            }
+            else if (tok == "EF" || tok == "F+" || tok == "F-")
+            {
+                is >> name;
+                known &= getNamedVar(name, id);
+                NodeID addr = AddressMask + id;
+                if (tok == "EF")
+                    summary.entry._freedAddrs.insert(addr);
+                else
+                    (tok == "F+" ? summary.freedAdded : summary.freedRemoved).insert(addr);
+            }
+            else if (tok == "J")
+            {
+                summary.journals.emplace_back();
+                is >> summary.journals.back().kind;
+            }
+            else if (tok == "B" && !summary.journals.empty())
+            {
+                u32_t len;
+                is >> name >> len;
+                known &= getNamedNode(name, id);
+                is.get();
+                std::string info(len, '\0');
+                is.read(&info[0], len);
+                summary.journals.back().bugs.emplace_back(id, info);
+            }
+            else if (tok == "G" && !summary.journals.empty())
+            {
+                is >> name;
+                known &= getNamedVar(name, id);
+                BoundedInt lb = readBound(is);
+                BoundedInt ub = readBound(is);
+                summary.journals.back().gepObjOffsets.emplace_back(id, IntervalValue(lb, ub));
+            }
+            else if (tok == "C")
+            {
+                is >> name;
+                known &= getNamedNode(name, id);
+                summary.dischargedCheckpoints.insert(id);
+            }
+            else
+                return malformed();
+        }
+        if (tok != "E")
+            return malformed();
+        if (!known)
+            continue;
+        SummaryKey key(funHash, hashState(summary.entry));
+        summaries[key] = std::move(summary);
+        loadedNum++;
+    }
+    return true;
+}
+
+void AESummaryCache::writeToFile(const std::string& fileName) const
+{
+    std::ofstream os(fileName);
+    if (!os.is_open())
+    {
+        SVFUtil::writeWrnMsg("cannot write summary file " + fileName);
+        return;
+    }
+    // Summaries of functions that no longer exist in this program are dropped
+    Set<u64_t> liveFunHashes;
+    for (const auto& it : funToHash)
+        liveFunHashes.insert(it.second);
+
+    // Field objects are written before the summaries, so that they are created before being referred to
+    GepObjNames gepObjNames;
+    std::ostringstream body;
+    for (const auto& it : summaries)
+    {
+        if (!liveFunHashes.count(it.first.first))
+            continue;
+        std::ostringstream record;
+        if (writeSummary(record, it.first.first, it.second, gepObjNames))
+            body << record.str();
+    }
+    os << "AE_SUMMARY_V2\n";
+    for (const auto& it : gepObjNames)
+        os << "N " << it.first << " " << it.second.first << " " << it.second.second << "\n";
+    os << body.str();
+}
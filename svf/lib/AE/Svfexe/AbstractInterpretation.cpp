@@ -46,11 +46,20 @@ void AbstractInterpretation::runOnModule(ICFG *_icfg)
     icfg = _icfg;
     svfir = PAG::getPAG();
     utils = new AbsExtAPI(abstractTrace);
+    if (Options::ZoneDomain())
+    {
+        zonePacks = new ZonePacks(Options::ZonePackSize());
+        zonePacks->build(svfir);
+    }
+    if (Options::AESummary() || !Options::AESummaryFile().empty())
+        summaries = new AESummaryCache(zonePacks);
 
     /// collect checkpoint
     collectCheckPoint();
 
     analyse();
+    if (summaries && !Options::AESummaryFile().empty())
+        summaries->writeToFile(Options::AESummaryFile());
     checkPointAllSet();
     stat->endClk();
     stat->finializeStat();
@@ -68,6 +77,8 @@ AbstractInterpretation::AbstractInterpretation()
 AbstractInterpretation::~AbstractInterpretation()
 {
     delete stat;
+    delete zonePacks;
+    delete summaries;
     for (auto it: funcToWTO)
         delete it.second;
 }
@@ -142,6 +153,13 @@ void AbstractInterpretation::initWTO()
             funcToWTO[it->second->getFunction()] = iwto;
         }
     }
+
+    if (summaries)
+    {
+        summaries->computeFunHashes(icfg, callGraph, callGraphScc);
+        if (!Options::AESummaryFile().empty())
+            summaries->readFromFile(Options::AESummaryFile());
+    }
 }
 
 /// Program entry
@@ -242,6 +260,9 @@ bool AbstractInterpretation::mergeStatesFromPredecessors(const ICFGNode * icfgNo
     }
     else
     {
+        // Start from the first incoming state, the join of an empty state would drop all zones
+        preAs = workList.back();
+        workList.pop_back();
         while (!workList.empty())
         {
             preAs.joinWith(workList.back());
@@ -346,8 +367,14 @@ bool AbstractInterpretation::isCmpBranchFeasible(const CmpStmt* cmpStmt, s64_t s
     else
     {
         // if var X var, we cannot preset the branch condition to infer the intervals of var0,var1
+        // unless both vars are related in the zone domain
         if (!b0 && !b1)
         {
+            if (zonePacks && zonePacks->inSamePack(op0, op1))
+            {
+                if (!refineZoneOnCmp(new_es, op0, op1, succ == 0 ? _reverse_predicate[predicate] : predicate))
+                    return false;
+            }
             as = new_es;
             return true;
         }
@@ -477,6 +504,16 @@ bool AbstractInterpretation::isCmpBranchFeasible(const CmpStmt* cmpStmt, s64_t s
         assert(false && "implement this part");
         abort();
     }
+    // propagate the refined bound of op0 to the vars related to it
+    if (zonePacks && zonePacks->inPack(op0))
+    {
+        u32_t packId = zonePacks->getSlot(op0).first;
+        DBM& dbm = getZone(new_es, packId);
+        dbm.meetInterval(zonePacks->getSlot(op0).second, new_es[op0].getInterval());
+        if (dbm.isBottom())
+            return false;
+        reduceZone(new_es, packId);
+    }
     as = new_es;
     return true;
 }
@@ -719,12 +756,8 @@ void AbstractInterpretation::directCallFunPass(const CallICFGNode *callNode)
         assert(false && "Recursion mode TOP should not reach here!");
     }
 
-    callSiteStack.push_back(callNode);
+    handleCallee(callNode, calleeFun);
 
-    const ICFGWTO* wto = funcToWTO[calleeFun];
-    handleWTOComponents(wto->getWTOComponents());
-
-    callSiteStack.pop_back();
     // handle Ret node
     const RetICFGNode *retNode = callNode->getRetICFGNode();
     // resume ES to callnode
@@ -759,18 +792,126 @@ void AbstractInterpretation::indirectCallFunPass(const CallICFGNode *callNode)
         }
 
         const FunObjVar* callfun = funObjVar->getFunction();
-        callSiteStack.push_back(callNode);
         abstractTrace[callNode] = as;
 
-        const ICFGWTO* wto = funcToWTO[callfun];
-        handleWTOComponents(wto->getWTOComponents());
-        callSiteStack.pop_back();
+        handleCallee(callNode, callfun);
         // handle Ret node
         const RetICFGNode* retNode = callNode->getRetICFGNode();
         abstractTrace[retNode] = abstractTrace[callNode];
     }
 }
 
+void AbstractInterpretation::handleCallee(const CallICFGNode* callNode, const FunObjVar* callee)
+{
+    callSiteStack.push_back(callNode);
+    // Recursive functions are analysed together with their whole SCC, there is no single entry state to key on
+    if (summaries && !isRecursiveFun(callee))
+        handleCalleeWithSummary(callee);
+    else
+        handleWTOComponents(funcToWTO[callee]->getWTOComponents());
+    callSiteStack.pop_back();
+    if (Options::AEEvictStates())
+        evictStates(funcToWTO[callee]);
+}
+
+void AbstractInterpretation::collectEvictableNodes(const std::list<const ICFGWTOComp*>& wtoComps,
+        std::vector<const ICFGNode*>& nodes) const
+{
+    for (const ICFGWTOComp* wtoComp : wtoComps)
+    {
+        if (const ICFGSingletonWTO* singleton = SVFUtil::dyn_cast<ICFGSingletonWTO>(wtoComp))
+        {
+            const ICFGNode* node = singleton->getICFGNode();
+            if (!SVFUtil::isa<CallICFGNode, RetICFGNode, FunExitICFGNode>(node))
+                nodes.push_back(node);
+        }
+        else if (const ICFGCycleWTO* cycle = SVFUtil::dyn_cast<ICFGCycleWTO>(wtoComp))
+        {
+            // The head is not one of the cycle components, hence its state is kept
+            collectEvictableNodes(cycle->getWTOComponents(), nodes);
+        }
+    }
+}
+
+void AbstractInterpretation::evictStates(const ICFGWTO* wto)
+{
+    auto it = wtoToEvictableNodes.find(wto);
+    if (it == wtoToEvictableNodes.end())
+    {
+        it = wtoToEvictableNodes.emplace(wto, std::vector<const ICFGNode*>()).first;
+        collectEvictableNodes(wto->getWTOComponents(), it->second);
+    }
+    for (const ICFGNode* node : it->second)
+        stat->getEvictedStateNum() += abstractTrace.erase(node);
+}
+
+/**
+ * The exit state of the callee is determined by its entry state, hence a summary
+ * is looked up by the content hash of the callee and the hash of its entry state,
+ * and used only if the entry state it was computed for equals the current one.
+ * On a hit, the exit state is rebuilt from the entry state and the recorded delta,
+ * and the recorded detector side effects are replayed at the current call site.
+ */
+void AbstractInterpretation::handleCalleeWithSummary(const FunObjVar* callee)
+{
+    const ICFGWTO* wto = funcToWTO[callee];
+    const FunEntryICFGNode* entry = icfg->getFunEntryICFGNode(callee);
+    const FunExitICFGNode* exit = icfg->getFunExitICFGNode(callee);
+    // An exit state left by an earlier call must not leak into this one
+    abstractTrace.erase(exit);
+    if (!mergeStatesFromPredecessors(entry))
+    {
+        handleWTOComponents(wto->getWTOComponents());
+        return;
+    }
+
+    AESummaryCache::SummaryKey key(summaries->getFunHash(callee),
+                                   AESummaryCache::hashState(abstractTrace[entry]));
+    if (const FunSummary* summary = summaries->getSummary(key, abstractTrace[entry]))
+    {
+        summaries->hitNum++;
+        for (const AEDetectorJournal& journal : summary->journals)
+        {
+            for (auto& detector : detectors)
+            {
+                if (detector->getKind() == journal.kind)
+                    detector->replayJournal(journal);
+            }
+        }
+        for (NodeID id : summary->dischargedCheckpoints)
+            checkpoints.erase(SVFUtil::cast<CallICFGNode>(icfg->getICFGNode(id)));
+        if (summary->hasExit)
+        {
+            AbstractState exitState = abstractTrace[entry];
+            AESummaryCache::applyDelta(*summary, exitState);
+            abstractTrace[exit] = exitState;
+        }
+        return;
+    }
+
+    summaries->missNum++;
+    FunSummary summary;
+    summary.journals.resize(detectors.size());
+    for (u32_t i = 0; i < detectors.size(); ++i)
+        detectors[i]->pushJournal(&summary.journals[i]);
+    Set<const CallICFGNode*> pendingCheckpoints = checkpoints;
+    AbstractState entryState = abstractTrace[entry];
+
+    handleWTOComponents(wto->getWTOComponents());
+
+    for (auto& detector : detectors)
+        detector->popJournal();
+    for (const CallICFGNode* call : pendingCheckpoints)
+    {
+        if (!checkpoints.count(call))
+            summary.dischargedCheckpoints.insert(call->getId());
+    }
+    if (hasAbsStateFromTrace(exit))
+        AESummaryCache::makeDelta(entryState, abstractTrace[exit], summary);
+    summary.entry = std::move(entryState);
+    summaries->addSummary(key, std::move(summary));
+}
+
 /// handle wto cycle (loop)
 void AbstractInterpretation::handleCycleWTO(const ICFGCycleWTO*cycle)
 {
@@ -800,7 +941,8 @@ void AbstractInterpretation::handleCycleWTO(const ICFGCycleWTO*cycle)
                 }
 
                 // Widening
-                abstractTrace[cycle_head] = prev_head_state.widening(cur_head_state);
+                stat->getWidenNum()++;
+                abstractTrace[cycle_head] = widenCycleHead(cycle_head, prev_head_state, cur_head_state);
 
                 if (abstractTrace[cycle_head] == prev_head_state)
                 {
@@ -822,6 +964,7 @@ void AbstractInterpretation::handleCycleWTO(const ICFGCycleWTO*cycle)
                     else if (Options::HandleRecur() == WIDEN_NARROW)
                     {
                         // Widening's fixpoint reached in the widening phase, switch to narrowing
+                        stat->getNarrowNum()++;
                         abstractTrace[cycle_head] = prev_head_state.narrowing(cur_head_state);
                         if (abstractTrace[cycle_head] == prev_head_state)
                         {
@@ -840,6 +983,7 @@ void AbstractInterpretation::handleCycleWTO(const ICFGCycleWTO*cycle)
                 else
                 {
                     // Widening's fixpoint reached in the widening phase, switch to narrowing
+                    stat->getNarrowNum()++;
                     abstractTrace[cycle_head] = prev_head_state.narrowing(cur_head_state);
                     if (abstractTrace[cycle_head] == prev_head_state)
                     {
@@ -859,6 +1003,76 @@ void AbstractInterpretation::handleCycleWTO(const ICFGCycleWTO*cycle)
     }
 }
 
+AbstractState AbstractInterpretation::widenCycleHead(const ICFGNode* cycleHead, const AbstractState& prev,
+        const AbstractState& cur)
+{
+    AbstractState widened = prev;
+    switch (Options::WidenStrategy())
+    {
+    case STANDARD_WIDEN:
+        return widened.widening(cur);
+    case THRESHOLD_WIDEN:
+        return widened.widening(cur, getWideningThresholds(cycleHead->getFun()));
+    default:
+        assert(false && "unknown widening strategy!");
+        abort();
+    }
+}
+
+/**
+ * Loop counters are usually bounded by a constant they are compared against
+ * (i < 10) or by the size of the array they index. Off-by-one neighbours of
+ * each compared constant are added as well, as strict and non-strict
+ * comparisons bound the counter at either of them.
+ */
+const OrderedSet<s64_t>& AbstractInterpretation::getWideningThresholds(const FunObjVar* fun)
+{
+    auto it = funToWideningThresholds.find(fun);
+    if (it != funToWideningThresholds.end())
+        return it->second;
+
+    OrderedSet<s64_t>& thresholds = funToWideningThresholds[fun];
+    for (const SVFBasicBlock* bb : fun->getReachableBBs())
+    {
+        for (const ICFGNode* node : bb->getICFGNodeList())
+        {
+            for (const SVFStmt* stmt : node->getSVFStmts())
+            {
+                if (const CmpStmt* cmp = SVFUtil::dyn_cast<CmpStmt>(stmt))
+                {
+                    for (u32_t i = 0; i < cmp->getOpVarNum(); ++i)
+                    {
+                        if (const ConstIntValVar* c = SVFUtil::dyn_cast<ConstIntValVar>(cmp->getOpVar(i)))
+                        {
+                            s64_t val = c->getSExtValue();
+                            thresholds.insert(val);
+                            if (val > std::numeric_limits<s64_t>::min())
+                                thresholds.insert(val - 1);
+                            if (val < std::numeric_limits<s64_t>::max())
+                                thresholds.insert(val + 1);
+                        }
+                    }
+                }
+                else if (const AddrStmt* addr = SVFUtil::dyn_cast<AddrStmt>(stmt))
+                {
+                    if (const BaseObjVar* obj = SVFUtil::dyn_cast<BaseObjVar>(addr->getRHSVar()))
+                    {
+                        for (s64_t size : {(s64_t) obj->getNumOfElements(), (s64_t) obj->getByteSizeOfObj()})
+                        {
+                            if (size > 0)
+                            {
+                                thresholds.insert(size);
+                                thresholds.insert(size - 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return thresholds;
+}
+
 void AbstractInterpretation::handleSVFStatement(const SVFStmt *stmt)
 {
     if (const AddrStmt *addr = SVFUtil::dyn_cast<AddrStmt>(stmt))
@@ -915,6 +1129,8 @@ void AbstractInterpretation::handleSVFStatement(const SVFStmt *stmt)
     }
     else
         assert(false && "implement this part");
+    if (zonePacks)
+        updateZoneOnStmt(stmt);
     // NullPtr is index 0, it should not be changed
     assert(!getAbsStateFromTrace(stmt->getICFGNode())[IRGraph::NullPtr].isInterval() &&
            !getAbsStateFromTrace(stmt->getICFGNode())[IRGraph::NullPtr].isAddr());
@@ -973,6 +1189,135 @@ void AbstractInterpretation::SkipRecursiveCall(const CallICFGNode *callNode)
     }
 }
 
+DBM& AbstractInterpretation::getZone(AbstractState& as, u32_t packId)
+{
+    bool fresh = !as.hasDBM(packId);
+    DBM& dbm = as.getDBM(packId, zonePacks->getPackDim(packId));
+    if (fresh)
+    {
+        const std::vector<NodeID>& vars = zonePacks->getPackVars(packId);
+        for (u32_t i = 0; i < vars.size(); ++i)
+        {
+            if (as.inVarToValTable(vars[i]))
+                dbm.meetInterval(i + 1, as[vars[i]].getInterval());
+        }
+    }
+    return dbm;
+}
+
+void AbstractInterpretation::reduceZone(AbstractState& as, u32_t packId)
+{
+    const DBM& dbm = as.getDBM(packId, zonePacks->getPackDim(packId));
+    if (dbm.isBottom())
+        return;
+    const std::vector<NodeID>& vars = zonePacks->getPackVars(packId);
+    for (u32_t i = 0; i < vars.size(); ++i)
+    {
+        if (as.inVarToValTable(vars[i]))
+            as[vars[i]].getInterval().meet_with(dbm.getInterval(i + 1));
+    }
+}
+
+void AbstractInterpretation::updateZoneOnStmt(const SVFStmt *stmt)
+{
+    NodeID res;
+    if (const AssignStmt *assign = SVFUtil::dyn_cast<AssignStmt>(stmt))
+        res = assign->getLHSVarID();
+    else if (const MultiOpndStmt *multi = SVFUtil::dyn_cast<MultiOpndStmt>(stmt))
+        res = multi->getResID();
+    else
+        return;
+    if (!zonePacks->inPack(res))
+        return;
+
+    AbstractState& as = getAbsStateFromTrace(stmt->getICFGNode());
+    u32_t packId = zonePacks->getSlot(res).first;
+    u32_t x = zonePacks->getSlot(res).second;
+    DBM& dbm = getZone(as, packId);
+
+    auto isConst = [&](NodeID id)
+    {
+        return as.inVarToValTable(id) && as[id].getInterval().is_numeral();
+    };
+    // res = y + c is exact in the zone domain when y lives in the same pack
+    bool assigned = false;
+    if (const BinaryOPStmt *binary = SVFUtil::dyn_cast<BinaryOPStmt>(stmt))
+    {
+        NodeID op0 = binary->getOpVarID(0), op1 = binary->getOpVarID(1);
+        bool isAdd = binary->getOpcode() == BinaryOPStmt::Add;
+        bool isSub = binary->getOpcode() == BinaryOPStmt::Sub;
+        if ((isAdd || isSub) && isConst(op1) && zonePacks->inSamePack(res, op0))
+        {
+            s64_t c = as[op1].getInterval().getIntNumeral();
+            dbm.assign(x, zonePacks->getSlot(op0).second, isAdd ? c : -c);
+            assigned = true;
+        }
+        else if (isAdd && isConst(op0) && zonePacks->inSamePack(res, op1))
+        {
+            dbm.assign(x, zonePacks->getSlot(op1).second, as[op0].getInterval().getIntNumeral());
+            assigned = true;
+        }
+    }
+    else if (const CopyStmt *copy = SVFUtil::dyn_cast<CopyStmt>(stmt))
+    {
+        if ((copy->getCopyKind() == CopyStmt::COPYVAL || copy->getCopyKind() == CopyStmt::SEXT) &&
+                zonePacks->inSamePack(res, copy->getRHSVarID()))
+        {
+            dbm.assign(x, zonePacks->getSlot(copy->getRHSVarID()).second, 0);
+            assigned = true;
+        }
+    }
+    // res is redefined (e.g. in the next loop iteration), its old relations are stale
+    if (!assigned)
+        dbm.forget(x);
+    if (as.inVarToValTable(res))
+        dbm.meetInterval(x, as[res].getInterval());
+    reduceZone(as, packId);
+}
+
+bool AbstractInterpretation::refineZoneOnCmp(AbstractState& as, NodeID op0, NodeID op1, s32_t predicate)
+{
+    u32_t packId = zonePacks->getSlot(op0).first;
+    u32_t i0 = zonePacks->getSlot(op0).second;
+    u32_t i1 = zonePacks->getSlot(op1).second;
+    DBM& dbm = getZone(as, packId);
+    // DBM entry (i, j) bounds v_j - v_i
+    switch (predicate)
+    {
+    case CmpStmt::Predicate::ICMP_EQ:
+        dbm.addConstraint(i1, i0, 0);
+        dbm.addConstraint(i0, i1, 0);
+        break;
+    case CmpStmt::Predicate::ICMP_UGT:
+    case CmpStmt::Predicate::ICMP_SGT:
+        // op1 - op0 <= -1
+        dbm.addConstraint(i0, i1, -1);
+        break;
+    case CmpStmt::Predicate::ICMP_UGE:
+    case CmpStmt::Predicate::ICMP_SGE:
+        // op1 - op0 <= 0
+        dbm.addConstraint(i0, i1, 0);
+        break;
+    case CmpStmt::Predicate::ICMP_ULT:
+    case CmpStmt::Predicate::ICMP_SLT:
+        // op0 - op1 <= -1
+        dbm.addConstraint(i1, i0, -1);
+        break;
+    case CmpStmt::Predicate::ICMP_ULE:
+    case CmpStmt::Predicate::ICMP_SLE:
+        // op0 - op1 <= 0
+        dbm.addConstraint(i1, i0, 0);
+        break;
+    default:
+        // != and floating point comparisons are not expressible as zones
+        break;
+    }
+    if (dbm.isBottom())
+        return false;
+    reduceZone(as, packId);
+    return true;
+}
+
 // count the size of memory map
 void AEStat::countStateSize()
 {
@@ -984,6 +1329,8 @@ void AEStat::countStateSize()
         generalNumMap["ES_Loc_Addr_AVG_Num"] = 0;
     }
     ++count;
+    if (_ae->abstractTrace.size() > getMaxTraceSize())
+        getMaxTraceSize() = _ae->abstractTrace.size();
 }
 
 void AEStat::finializeStat()
@@ -1022,6 +1369,15 @@ void AEStat::finializeStat()
     generalNumMap["Func_Num"] = funs.size();
     generalNumMap["EXT_CallSite_Num"] = extCallSiteNum;
     generalNumMap["NonEXT_CallSite_Num"] = callSiteNum;
+    if (_ae->zonePacks)
+        generalNumMap["Zone_Pack_Num"] = _ae->zonePacks->getPackNum();
+    if (_ae->summaries)
+    {
+        generalNumMap["Summary_Num"] = _ae->summaries->getSummaryNum();
+        generalNumMap["Summary_Loaded_Num"] = _ae->summaries->loadedNum;
+        generalNumMap["Summary_Hit_Num"] = _ae->summaries->hitNum;
+        generalNumMap["Summary_Miss_Num"] = _ae->summaries->missNum;
+    }
     timeStatMap["Total_Time(sec)"] = (double)(endTime - startTime) / TIMEINTERVAL;
 
 }
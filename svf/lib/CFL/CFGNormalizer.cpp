@@ -54,6 +54,7 @@ CFGrammar* CFGNormalizer::normalize(GrammarBase *generalGrammar)
     ebnfSignReplace('?', grammar);
     ebnf_bin(grammar);
     fillAttribute(grammar, grammar->getKindToAttrsMap());
+    grammar->compile();
     return grammar;
 }
 
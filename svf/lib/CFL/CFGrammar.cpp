@@ -343,6 +343,20 @@ CFGrammar::CFGrammar()
     newTerminalSubscript = 0;
 }
 
+void CFGrammar::compile()
+{
+    symToCompiledProds.clear();
+    for (const auto& it : singleRHSToProds)
+        for (const Production& prod : it.second)
+            symToCompiledProds[it.first].singleHeads.push_back(getLHSSymbol(prod));
+    for (const auto& it : firstRHSToProds)
+        for (const Production& prod : it.second)
+            symToCompiledProds[it.first].firstRHSProds.emplace_back(getLHSSymbol(prod), getSecondRHSSymbol(prod));
+    for (const auto& it : secondRHSToProds)
+        for (const Production& prod : it.second)
+            symToCompiledProds[it.first].secondRHSProds.emplace_back(getLHSSymbol(prod), getFirstRHSSymbol(prod));
+}
+
 void CFGrammar::dump() const
 {
     dump("Normailized_Grammar.txt");
@@ -207,7 +207,10 @@ void CFLAlias::initialize()
 
 void CFLAlias::initializeSolver()
 {
-    solver = new CFLSolver(graph, grammar);
+    if (CFLMatrixSolver::isRequested())
+        solver = new CFLMatrixSolver(graph, grammar, getNodeKeys());
+    else
+        solver = new CFLSolver(graph, grammar);
 }
 
 void CFLAlias::finalize()
@@ -246,10 +249,18 @@ void CFLAlias::solve()
 
 void POCRAlias::initializeSolver()
 {
-    solver = new POCRSolver(graph, grammar);
+    if (CFLMatrixSolver::isRequested())
+        solver = new CFLMatrixSolver(graph, grammar, getNodeKeys());
+    else
+        solver = new POCRSolver(graph, grammar);
 }
 
 void POCRHybrid::initializeSolver()
 {
     solver = new POCRHybridSolver(graph, grammar);
 }
+
+void CFLMatrixAlias::initializeSolver()
+{
+    solver = new CFLMatrixSolver(graph, grammar, getNodeKeys());
+}
@@ -139,6 +139,8 @@ void CFLBase::analyze()
 
     solve();
 
+    solver->finalize();
+
     finalize();
 }
 
@@ -147,6 +149,28 @@ CFLGraph* CFLBase::getCFLGraph()
     return graph;
 }
 
+/*!
+ * A node built from the SVFIR is keyed by the kind, function, name and source
+ * location of its variable, which survive a change of the program that shifts
+ * the node IDs
+ */
+CFLMatrixSolver::NodeKeys CFLBase::getNodeKeys() const
+{
+    CFLMatrixSolver::NodeKeys keys;
+    if (!Options::CFLGraph().empty() || (Options::CFLClosureIn().empty() && Options::CFLClosureOut().empty()))
+        return keys;
+    for (auto it = graph->begin(); it != graph->end(); it++)
+    {
+        if (!svfir->hasGNode(it->first))
+            continue;
+        const SVFVar* var = svfir->getGNode(it->first);
+        const FunObjVar* fun = var->getFunction();
+        keys[it->first] = std::to_string(var->getNodeKind()) + "\t" + (fun ? fun->getName() : "") + "\t" +
+                          var->getValueName() + "\t" + var->getSourceLoc();
+    }
+    return keys;
+}
+
 void CFLBase::countSumEdges()
 {
     numOfStartEdges = 0;
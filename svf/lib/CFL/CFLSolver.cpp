@@ -28,6 +28,10 @@
  */
 
 #include "CFL/CFLSolver.h"
+#include "Util/Options.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
 
 using namespace SVF;
 
@@ -63,56 +67,50 @@ void CFLSolver::processCFLEdge(const CFLEdge* Y_edge)
 {
     CFLNode* i = Y_edge->getSrcNode();
     CFLNode* j = Y_edge->getDstNode();
+    const CFGrammar::CompiledProds& prods = grammar->getCompiledProds(Y_edge->getEdgeKind());
 
     /// For each production X -> Y
     ///     add X(i,j) if not exist to E and to worklist
-    Symbol Y = Y_edge->getEdgeKind();
-    if (grammar->hasProdsFromSingleRHS(Y))
-        for(const Production& prod : grammar->getProdsFromSingleRHS(Y))
+    for (const Symbol& X : prods.singleHeads)
+    {
+        numOfChecks++;
+        if(const CFLEdge* newEdge = graph->addCFLEdge(i, j, X))
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            numOfChecks++;
-            if(const CFLEdge* newEdge = graph->addCFLEdge(i, j, X))
-            {
-                pushIntoWorklist(newEdge);
-            }
+            pushIntoWorklist(newEdge);
         }
+    }
 
     /// For each production X -> Y Z
     /// Foreach outgoing edge Z(j,k) from node j do
     ///     add X(i,k) if not exist to E and to worklist
-    if (grammar->hasProdsFromFirstRHS(Y))
-        for(const Production& prod : grammar->getProdsFromFirstRHS(Y))
+    for (const auto& XZ : prods.firstRHSProds)
+    {
+        for(const CFLEdge* Z_edge : j->getOutEdgeWithTy(XZ.second))
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            for(const CFLEdge* Z_edge : j->getOutEdgeWithTy(grammar->getSecondRHSSymbol(prod)))
+            CFLNode* k = Z_edge->getDstNode();
+            numOfChecks++;
+            if(const CFLEdge* newEdge = graph->addCFLEdge(i, k, XZ.first))
             {
-                CFLNode* k = Z_edge->getDstNode();
-                numOfChecks++;
-                if(const CFLEdge* newEdge = graph->addCFLEdge(i, k, X))
-                {
-                    pushIntoWorklist(newEdge);
-                }
+                pushIntoWorklist(newEdge);
             }
         }
+    }
 
     /// For each production X -> Z Y
     /// Foreach incoming edge Z(k,i) to node i do
     ///     add X(k,j) if not exist to E and to worklist
-    if(grammar->hasProdsFromSecondRHS(Y))
-        for(const Production& prod : grammar->getProdsFromSecondRHS(Y))
+    for (const auto& XZ : prods.secondRHSProds)
+    {
+        for(const CFLEdge* Z_edge : i->getInEdgeWithTy(XZ.second))
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            for(const CFLEdge* Z_edge : i->getInEdgeWithTy(grammar->getFirstRHSSymbol(prod)))
+            CFLNode* k = Z_edge->getSrcNode();
+            numOfChecks++;
+            if(const CFLEdge* newEdge = graph->addCFLEdge(k, j, XZ.first))
             {
-                CFLNode* k = Z_edge->getSrcNode();
-                numOfChecks++;
-                if(const CFLEdge* newEdge = graph->addCFLEdge(k, j, X))
-                {
-                    pushIntoWorklist(newEdge);
-                }
+                pushIntoWorklist(newEdge);
             }
         }
+    }
 }
 
 
@@ -139,54 +137,49 @@ void POCRSolver::processCFLEdge(const CFLEdge* Y_edge)
 {
     CFLNode* i = Y_edge->getSrcNode();
     CFLNode* j = Y_edge->getDstNode();
+    const CFGrammar::CompiledProds& prods = grammar->getCompiledProds(Y_edge->getEdgeKind());
 
     /// For each production X -> Y
     ///     add X(i,j) if not exist to E and to worklist
-    Symbol Y = Y_edge->getEdgeKind();
-    if (grammar->hasProdsFromSingleRHS(Y))
-        for(const Production& prod : grammar->getProdsFromSingleRHS(Y))
+    for (const Symbol& X : prods.singleHeads)
+    {
+        numOfChecks++;
+        if (addEdge(i->getId(), j->getId(), X))
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            numOfChecks++;
-            if (addEdge(i->getId(), j->getId(), X))
-            {
-                const CFLEdge* newEdge = graph->addCFLEdge(Y_edge->getSrcNode(), Y_edge->getDstNode(), X);
-                pushIntoWorklist(newEdge);
-            }
-
+            const CFLEdge* newEdge = graph->addCFLEdge(i, j, X);
+            pushIntoWorklist(newEdge);
         }
+    }
 
     /// For each production X -> Y Z
     /// Foreach outgoing edge Z(j,k) from node j do
     ///     add X(i,k) if not exist to E and to worklist
-    if (grammar->hasProdsFromFirstRHS(Y))
-        for(const Production& prod : grammar->getProdsFromFirstRHS(Y))
+    for (const auto& XZ : prods.firstRHSProds)
+    {
+        const NodeBS& zDsts = getSuccs(j->getId(), XZ.second);
+        numOfChecks += zDsts.count();
+        NodeBS diffDsts = addEdges(i->getId(), zDsts, XZ.first);
+        for (NodeID diffDst: diffDsts)
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            NodeBS diffDsts = addEdges(i->getId(), getSuccMap(j->getId())[grammar->getSecondRHSSymbol(prod)], X);
-            numOfChecks += getSuccMap(j->getId())[grammar->getSecondRHSSymbol(prod)].count();
-            for (NodeID diffDst: diffDsts)
-            {
-                const CFLEdge* newEdge = graph->addCFLEdge(i, graph->getGNode(diffDst), X);
-                pushIntoWorklist(newEdge);
-            }
+            const CFLEdge* newEdge = graph->addCFLEdge(i, graph->getGNode(diffDst), XZ.first);
+            pushIntoWorklist(newEdge);
         }
+    }
 
     /// For each production X -> Z Y
     /// Foreach incoming edge Z(k,i) to node i do
     ///     add X(k,j) if not exist to E and to worklist
-    if(grammar->hasProdsFromSecondRHS(Y))
-        for(const Production& prod : grammar->getProdsFromSecondRHS(Y))
+    for (const auto& XZ : prods.secondRHSProds)
+    {
+        const NodeBS& zSrcs = getPreds(i->getId(), XZ.second);
+        numOfChecks += zSrcs.count();
+        NodeBS diffSrcs = addEdges(zSrcs, j->getId(), XZ.first);
+        for (NodeID diffSrc: diffSrcs)
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            NodeBS diffSrcs = addEdges(getPredMap(i->getId())[grammar->getFirstRHSSymbol(prod)], j->getId(), X);
-            numOfChecks += getPredMap(i->getId())[grammar->getFirstRHSSymbol(prod)].count();
-            for (NodeID diffSrc: diffSrcs)
-            {
-                const CFLEdge* newEdge = graph->addCFLEdge(graph->getGNode(diffSrc), j, X);
-                pushIntoWorklist(newEdge);
-            }
+            const CFLEdge* newEdge = graph->addCFLEdge(graph->getGNode(diffSrc), j, XZ.first);
+            pushIntoWorklist(newEdge);
         }
+    }
 }
 
 void POCRSolver::initialize()
@@ -198,14 +191,17 @@ void POCRSolver::initialize()
 
     /// Foreach production X -> epsilon
     ///     add X(i,i) if not exist to E and to worklist
+    ///     on nodes with outgoing edges
     for(const Production& prod : grammar->getEpsilonProds())
     {
-        for(auto IDMap : getSuccMap())
+        for(auto it = graph->begin(); it!= graph->end(); it++)
         {
+            CFLNode* i = (*it).second;
+            if (!i->hasOutgoingEdge())
+                continue;
             Symbol X = grammar->getLHSSymbol(prod);
-            if (addEdge(IDMap.first, IDMap.first, X))
+            if (addEdge(i->getId(), i->getId(), X))
             {
-                CFLNode* i = graph->getGNode(IDMap.first);
                 const CFLEdge* newEdge = graph->addCFLEdge(i, i, X);
                 pushIntoWorklist(newEdge);
             }
@@ -217,68 +213,64 @@ void POCRHybridSolver::processCFLEdge(const CFLEdge* Y_edge)
 {
     CFLNode* i = Y_edge->getSrcNode();
     CFLNode* j = Y_edge->getDstNode();
+    Symbol Y = Y_edge->getEdgeKind();
+    const CFGrammar::CompiledProds& prods = grammar->getCompiledProds(Y);
 
     /// For each production X -> Y
     ///     add X(i,j) if not exist to E and to worklist
-    Symbol Y = Y_edge->getEdgeKind();
-    if (grammar->hasProdsFromSingleRHS(Y))
-        for(const Production& prod : grammar->getProdsFromSingleRHS(Y))
+    for (const Symbol& X : prods.singleHeads)
+    {
+        numOfChecks++;
+        if (addEdge(i->getId(), j->getId(), X))
         {
-            Symbol X = grammar->getLHSSymbol(prod);
-            numOfChecks++;
-            if (addEdge(i->getId(), j->getId(), X))
-            {
-                const CFLEdge* newEdge = graph->addCFLEdge(Y_edge->getSrcNode(), Y_edge->getDstNode(), X);
-                pushIntoWorklist(newEdge);
-            }
-
+            const CFLEdge* newEdge = graph->addCFLEdge(i, j, X);
+            pushIntoWorklist(newEdge);
         }
+    }
 
     /// For each production X -> Y Z
     /// Foreach outgoing edge Z(j,k) from node j do
     ///     add X(i,k) if not exist to E and to worklist
-    if (grammar->hasProdsFromFirstRHS(Y))
-        for(const Production& prod : grammar->getProdsFromFirstRHS(Y))
+    for (const auto& XZ : prods.firstRHSProds)
+    {
+        if (isTransitiveProd(XZ.first, Y, XZ.second))
         {
-            if ((grammar->getLHSSymbol(prod) == grammar->strToSymbol("F")) && (Y == grammar->strToSymbol("F")) && (grammar->getSecondRHSSymbol(prod) == grammar->strToSymbol("F")))
-            {
-                addArc(i->getId(), j->getId());
-            }
-            else
+            addArc(i->getId(), j->getId());
+        }
+        else
+        {
+            const NodeBS& zDsts = getSuccs(j->getId(), XZ.second);
+            numOfChecks += zDsts.count();
+            NodeBS diffDsts = addEdges(i->getId(), zDsts, XZ.first);
+            for (NodeID diffDst: diffDsts)
             {
-                Symbol X = grammar->getLHSSymbol(prod);
-                NodeBS diffDsts = addEdges(i->getId(), getSuccMap(j->getId())[grammar->getSecondRHSSymbol(prod)], X);
-                numOfChecks += getSuccMap(j->getId())[grammar->getSecondRHSSymbol(prod)].count();
-                for (NodeID diffDst: diffDsts)
-                {
-                    const CFLEdge* newEdge = graph->addCFLEdge(i, graph->getGNode(diffDst), X);
-                    pushIntoWorklist(newEdge);
-                }
+                const CFLEdge* newEdge = graph->addCFLEdge(i, graph->getGNode(diffDst), XZ.first);
+                pushIntoWorklist(newEdge);
             }
         }
+    }
 
     /// For each production X -> Z Y
     /// Foreach incoming edge Z(k,i) to node i do
     ///     add X(k,j) if not exist to E and to worklist
-    if(grammar->hasProdsFromSecondRHS(Y))
-        for(const Production& prod : grammar->getProdsFromSecondRHS(Y))
+    for (const auto& XZ : prods.secondRHSProds)
+    {
+        if (isTransitiveProd(XZ.first, XZ.second, Y))
         {
-            if ((grammar->getLHSSymbol(prod) == grammar->strToSymbol("F")) && (Y == grammar->strToSymbol("F")) && (grammar->getFirstRHSSymbol(prod) == grammar->strToSymbol("F")))
-            {
-                addArc(i->getId(), j->getId());
-            }
-            else
+            addArc(i->getId(), j->getId());
+        }
+        else
+        {
+            const NodeBS& zSrcs = getPreds(i->getId(), XZ.second);
+            numOfChecks += zSrcs.count();
+            NodeBS diffSrcs = addEdges(zSrcs, j->getId(), XZ.first);
+            for (NodeID diffSrc: diffSrcs)
             {
-                Symbol X = grammar->getLHSSymbol(prod);
-                NodeBS diffSrcs = addEdges(getPredMap(i->getId())[grammar->getFirstRHSSymbol(prod)], j->getId(), X);
-                numOfChecks += getPredMap(i->getId())[grammar->getFirstRHSSymbol(prod)].count();
-                for (NodeID diffSrc: diffSrcs)
-                {
-                    const CFLEdge* newEdge = graph->addCFLEdge(graph->getGNode(diffSrc), j, X);
-                    pushIntoWorklist(newEdge);
-                }
+                const CFLEdge* newEdge = graph->addCFLEdge(graph->getGNode(diffSrc), j, XZ.first);
+                pushIntoWorklist(newEdge);
             }
         }
+    }
 }
 
 void POCRHybridSolver::initialize()
@@ -296,14 +288,17 @@ void POCRHybridSolver::initialize()
     }
 
     ///     add X(i,i) if not exist to E and to worklist
+    ///     on nodes with outgoing edges
     for(const Production& prod : grammar->getEpsilonProds())
     {
-        for(auto IDMap : getSuccMap())
+        for(auto it = graph->begin(); it!= graph->end(); it++)
         {
+            CFLNode* i = (*it).second;
+            if (!i->hasOutgoingEdge())
+                continue;
             Symbol X = grammar->getLHSSymbol(prod);
-            if (addEdge(IDMap.first, IDMap.first, X))
+            if (addEdge(i->getId(), i->getId(), X))
             {
-                CFLNode* i = graph->getGNode(IDMap.first);
                 const CFLEdge* newEdge = graph->addCFLEdge(i, i, X);
                 pushIntoWorklist(newEdge);
             }
@@ -313,7 +308,7 @@ void POCRHybridSolver::initialize()
 
 void POCRHybridSolver::addArc(NodeID src, NodeID dst)
 {
-    if(hasEdge(src, dst, grammar->strToSymbol("F")))
+    if(hasEdge(src, dst, transitiveSym))
         return;
 
     for (auto& iter: indMap[src])
@@ -378,4 +373,638 @@ void POCRHybridSolver::meld_h(NodeID x, TreeNode* uNode, TreeNode* vNode)
     {
         meld_h(x, newVNode, vChild);
     }
-}
\ No newline at end of file
+}
+CFLMatrixSolver::CFLMatrixSolver(CFLGraph* _graph, CFGrammar* _grammar, const NodeKeys& keys)
+    : CFLSolver(_graph, _grammar), nodeKeys(keys), closureLoaded(false), shardNum(std::max<u32_t>(Options::CFLThreads(), 1)), numOfRounds(0)
+{
+    /// Number the nodes sharing a key (e.g. the unnamed temporaries of a function) in
+    /// the order of their IDs, which does not change if their function does not
+    std::vector<NodeID> ids;
+    for (const auto& it : nodeKeys)
+        ids.push_back(it.first);
+    std::sort(ids.begin(), ids.end());
+    Map<std::string, u32_t> keyNum;
+    for (const NodeID id : ids)
+    {
+        std::string& key = nodeKeys[id];
+        const u32_t num = keyNum[key]++;
+        key += "\t#" + std::to_string(num);
+    }
+
+    if (!Options::CFLClosureIn().empty())
+        loadClosure(Options::CFLClosureIn());
+}
+
+bool CFLMatrixSolver::isRequested()
+{
+    return Options::CFLMatrix() || Options::CFLThreads() > 1 || !Options::CFLClosureIn().empty() || !Options::CFLClosureOut().empty();
+}
+
+bool CFLMatrixSolver::addEdges(const u32_t ty, const NodeID src, const NodeBS& dsts, NodeBS& newDsts)
+{
+    u32_t shard = getShard(src);
+    NodeBS& row = getMatrix(succMatrices, ty)[shard][src];
+    newDsts.intersectWithComplement(dsts, row);
+    if (newDsts.empty())
+        return false;
+    row |= newDsts;
+    ShardedMatrix& cols = getMatrix(predMatrices, ty);
+    for (NodeID dst : newDsts)
+        cols[getShard(dst)][dst].set(src);
+    getMatrix(delta, ty)[shard][src] |= newDsts;
+    return true;
+}
+
+void CFLMatrixSolver::initialize()
+{
+    /// Edges already in the matrices are derived ones copied into the graph
+    for (const CFLEdge* edge : graph->getCFLEdges())
+    {
+        NodeBS dst, newDst;
+        dst.set(edge->getDstID());
+        if (addEdges(edge->getEdgeKind(), edge->getSrcID(), dst, newDst))
+            baseEdges[edge->getEdgeKind()][edge->getSrcID()].set(edge->getDstID());
+    }
+
+    /// Foreach production X -> epsilon
+    ///     add X(i,i) if not exist
+    for (const Production& prod : grammar->getEpsilonProds())
+    {
+        Symbol X = grammar->getLHSSymbol(prod);
+        for (auto it = graph->begin(); it != graph->end(); it++)
+        {
+            NodeID i = it->first;
+            NodeBS self, newSelf;
+            self.set(i);
+            if (addEdges(X, i, self, newSelf))
+            {
+                baseEdges[X][i].set(i);
+                graph->addCFLEdge(it->second, it->second, X);
+            }
+        }
+    }
+
+    /// Edges pushed by the clients are already in the graph
+    while (!isWorklistEmpty())
+        popFromWorklist();
+}
+
+void CFLMatrixSolver::processDelta(u32_t shard, LabelToMatrix& candidates)
+{
+    double checks = 0;
+    for (const auto& labelIt : delta)
+    {
+        const Matrix& deltaRows = labelIt.second[shard];
+        if (deltaRows.empty())
+            continue;
+        const CFGrammar::CompiledProds& prods = grammar->getCompiledProds(labelIt.first);
+
+        /// For each production X -> Y
+        ///     X(i,_) |= delta Y(i,_)
+        for (const Symbol& head : prods.singleHeads)
+        {
+            ShardedMatrix& X = getMatrix(candidates, head);
+            for (const auto& rowIt : deltaRows)
+            {
+                checks += rowIt.second.count();
+                X[shard][rowIt.first] |= rowIt.second;
+            }
+        }
+
+        /// For each production X -> Y Z
+        ///     X(i,_) |= Z(j,_) for each j in delta Y(i,_)
+        for (const auto& XZ : prods.firstRHSProds)
+        {
+            auto zIt = succMatrices.find(XZ.second);
+            if (zIt == succMatrices.end())
+                continue;
+            const ShardedMatrix& Z = zIt->second;
+            ShardedMatrix& X = getMatrix(candidates, XZ.first);
+            for (const auto& rowIt : deltaRows)
+            {
+                NodeBS& row = X[shard][rowIt.first];
+                for (NodeID j : rowIt.second)
+                {
+                    const Matrix& zRows = Z[getShard(j)];
+                    auto zRow = zRows.find(j);
+                    if (zRow == zRows.end())
+                        continue;
+                    checks += zRow->second.count();
+                    row |= zRow->second;
+                }
+            }
+        }
+
+        /// For each production X -> Z Y
+        ///     X(k,_) |= delta Y(i,_) for each k in Z(_,i)
+        for (const auto& XZ : prods.secondRHSProds)
+        {
+            auto zIt = predMatrices.find(XZ.second);
+            if (zIt == predMatrices.end())
+                continue;
+            const Matrix& zCols = zIt->second[shard];
+            ShardedMatrix& X = getMatrix(candidates, XZ.first);
+            for (const auto& rowIt : deltaRows)
+            {
+                auto zCol = zCols.find(rowIt.first);
+                if (zCol == zCols.end())
+                    continue;
+                for (NodeID k : zCol->second)
+                {
+                    checks += rowIt.second.count();
+                    X[getShard(k)][k] |= rowIt.second;
+                }
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(checksMutex);
+    numOfChecks += checks;
+}
+
+bool CFLMatrixSolver::addRows(u32_t shard, const std::vector<LabelToMatrix>& candidates, std::vector<ColumnUpdates>& updates)
+{
+    bool changed = false;
+    for (const LabelToMatrix& threadCandidates : candidates)
+    {
+        for (const auto& labelIt : threadCandidates)
+        {
+            Matrix& rows = succMatrices.at(labelIt.first)[shard];
+            Matrix& deltaRows = delta.at(labelIt.first)[shard];
+            for (const auto& rowIt : labelIt.second[shard])
+            {
+                NodeBS& row = rows[rowIt.first];
+                NodeBS newDsts;
+                newDsts.intersectWithComplement(rowIt.second, row);
+                if (newDsts.empty())
+                    continue;
+                row |= newDsts;
+                deltaRows[rowIt.first] |= newDsts;
+                for (NodeID dst : newDsts)
+                    updates[getShard(dst)].push_back({labelIt.first, rowIt.first, dst});
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+/// Run work(0) .. work(threadNum-1) on threadNum threads, the calling one included
+template<typename Work>
+static void runOnShards(u32_t threadNum, Work work)
+{
+    std::vector<std::thread> threads;
+    for (u32_t t = 1; t < threadNum; ++t)
+        threads.emplace_back(work, t);
+    work(0);
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+void CFLMatrixSolver::solve()
+{
+    if (closureLoaded)
+    {
+        solveIncrementally();
+    }
+    else
+    {
+        /// initial delta
+        initialize();
+        runRounds();
+    }
+}
+
+void CFLMatrixSolver::finalize()
+{
+    if (!Options::CFLClosureOut().empty())
+        saveClosure(Options::CFLClosureOut());
+}
+
+void CFLMatrixSolver::runRounds()
+{
+    bool changed = true;
+    while (changed)
+    {
+        numOfRounds++;
+
+        /// Candidates are computed from the matrices as they were at the end of the last round
+        std::vector<LabelToMatrix> candidates(shardNum);
+        runOnShards(shardNum, [&](u32_t shard)
+        {
+            processDelta(shard, candidates[shard]);
+        });
+
+        /// Create the matrices of new labels before the threads write into their shards
+        delta.clear();
+        for (const LabelToMatrix& threadCandidates : candidates)
+        {
+            for (const auto& labelIt : threadCandidates)
+            {
+                getMatrix(succMatrices, labelIt.first);
+                getMatrix(predMatrices, labelIt.first);
+                getMatrix(delta, labelIt.first);
+            }
+        }
+
+        /// updates[s][d]: columns in shard d of the rows added by shard s
+        std::vector<std::vector<ColumnUpdates>> updates(shardNum, std::vector<ColumnUpdates>(shardNum));
+        std::vector<u8_t> shardChanged(shardNum, 0);
+        runOnShards(shardNum, [&](u32_t shard)
+        {
+            shardChanged[shard] = addRows(shard, candidates, updates[shard]);
+        });
+        runOnShards(shardNum, [&](u32_t shard)
+        {
+            for (const std::vector<ColumnUpdates>& shardUpdates : updates)
+            {
+                for (const ColumnUpdate& update : shardUpdates[shard])
+                    predMatrices.at(update.label)[shard][update.dst].set(update.src);
+            }
+        });
+        changed = std::find(shardChanged.begin(), shardChanged.end(), 1) != shardChanged.end();
+
+        /// The CFL graph is not thread-safe, copy the new edges sequentially
+        for (const auto& labelIt : delta)
+        {
+            for (const Matrix& deltaRows : labelIt.second)
+            {
+                for (const auto& rowIt : deltaRows)
+                {
+                    CFLNode* src = graph->getGNode(rowIt.first);
+                    for (NodeID dst : rowIt.second)
+                        graph->addCFLEdge(src, graph->getGNode(dst), labelIt.first);
+                }
+            }
+        }
+    }
+}
+
+void CFLMatrixSolver::collectBaseEdges(Map<u32_t, Matrix>& edges)
+{
+    for (const CFLEdge* edge : graph->getCFLEdges())
+        edges[edge->getEdgeKind()][edge->getSrcID()].set(edge->getDstID());
+    for (const Production& prod : grammar->getEpsilonProds())
+    {
+        Matrix& rows = edges[grammar->getLHSSymbol(prod)];
+        for (auto it = graph->begin(); it != graph->end(); it++)
+            rows[it->first].set(it->first);
+    }
+}
+
+bool CFLMatrixSolver::isDerivable(const u32_t ty, const NodeID src, const NodeID dst) const
+{
+    /// X -> Y
+    auto singleIt = headToSingleBodies.find(ty);
+    if (singleIt != headToSingleBodies.end())
+        for (const Symbol& Y : singleIt->second)
+            if (hasEdge(src, dst, Y))
+                return true;
+
+    /// X -> Y Z, some Y(src,j) and Z(j,dst)
+    auto binaryIt = headToBinaryBodies.find(ty);
+    if (binaryIt != headToBinaryBodies.end())
+        for (const auto& YZ : binaryIt->second)
+        {
+            auto yIt = succMatrices.find(YZ.first);
+            auto zIt = predMatrices.find(YZ.second);
+            if (yIt == succMatrices.end() || zIt == predMatrices.end())
+                continue;
+            const Matrix& yRows = yIt->second[getShard(src)];
+            const Matrix& zCols = zIt->second[getShard(dst)];
+            auto yRow = yRows.find(src);
+            auto zCol = zCols.find(dst);
+            if (yRow != yRows.end() && zCol != zCols.end() && yRow->second.intersects(zCol->second))
+                return true;
+        }
+    return false;
+}
+
+void CFLMatrixSolver::solveIncrementally()
+{
+    closureLoaded = false;
+    while (!isWorklistEmpty())
+        popFromWorklist();
+
+    if (headToSingleBodies.empty() && headToBinaryBodies.empty())
+    {
+        for (const auto& it : grammar->getSingleRHSToProds())
+            for (const Production& prod : it.second)
+                headToSingleBodies[grammar->getLHSSymbol(prod)].push_back(it.first);
+        for (const auto& it : grammar->getFirstRHSToProds())
+            for (const Production& prod : it.second)
+                headToBinaryBodies[grammar->getLHSSymbol(prod)].emplace_back(it.first, grammar->getSecondRHSSymbol(prod));
+    }
+
+    Map<u32_t, Matrix> newBaseEdges;
+    collectBaseEdges(newBaseEdges);
+
+    /// Over-delete: the removed base edges and every edge derived with one of them
+    delta.clear();
+    LabelToMatrix deleted;
+    for (const auto& labelIt : baseEdges)
+    {
+        const Matrix* newRows = nullptr;
+        auto newIt = newBaseEdges.find(labelIt.first);
+        if (newIt != newBaseEdges.end())
+            newRows = &newIt->second;
+        for (const auto& rowIt : labelIt.second)
+        {
+            NodeBS removed = rowIt.second;
+            if (newRows)
+            {
+                auto newRow = newRows->find(rowIt.first);
+                if (newRow != newRows->end())
+                    removed.intersectWithComplement(newRow->second);
+            }
+            if (removed.empty())
+                continue;
+            getMatrix(delta, labelIt.first)[getShard(rowIt.first)][rowIt.first] |= removed;
+            getMatrix(deleted, labelIt.first)[getShard(rowIt.first)][rowIt.first] |= removed;
+        }
+    }
+    bool changed = !delta.empty();
+    while (changed)
+    {
+        std::vector<LabelToMatrix> candidates(shardNum);
+        runOnShards(shardNum, [&](u32_t shard)
+        {
+            processDelta(shard, candidates[shard]);
+        });
+        delta.clear();
+        changed = false;
+        for (const LabelToMatrix& threadCandidates : candidates)
+        {
+            for (const auto& labelIt : threadCandidates)
+            {
+                auto succIt = succMatrices.find(labelIt.first);
+                if (succIt == succMatrices.end())
+                    continue;
+                for (u32_t shard = 0; shard < shardNum; ++shard)
+                {
+                    for (const auto& rowIt : labelIt.second[shard])
+                    {
+                        auto row = succIt->second[shard].find(rowIt.first);
+                        if (row == succIt->second[shard].end())
+                            continue;
+                        NodeBS& deletedRow = getMatrix(deleted, labelIt.first)[shard][rowIt.first];
+                        NodeBS newDeleted = rowIt.second & row->second;
+                        newDeleted.intersectWithComplement(deletedRow);
+                        if (newDeleted.empty())
+                            continue;
+                        deletedRow |= newDeleted;
+                        getMatrix(delta, labelIt.first)[shard][rowIt.first] |= newDeleted;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    delta.clear();
+
+    for (const auto& labelIt : deleted)
+    {
+        ShardedMatrix& rows = succMatrices.at(labelIt.first);
+        ShardedMatrix& cols = predMatrices.at(labelIt.first);
+        for (u32_t shard = 0; shard < shardNum; ++shard)
+        {
+            for (const auto& rowIt : labelIt.second[shard])
+            {
+                rows[shard][rowIt.first].intersectWithComplement(rowIt.second);
+                for (NodeID dst : rowIt.second)
+                    cols[getShard(dst)][dst].reset(rowIt.first);
+            }
+        }
+    }
+
+    /// Rederive the deleted edges with a derivation in one step from the remaining ones
+    std::vector<std::tuple<u32_t, NodeID, NodeID>> rederived;
+    for (const auto& labelIt : deleted)
+        for (const Matrix& rows : labelIt.second)
+            for (const auto& rowIt : rows)
+                for (NodeID dst : rowIt.second)
+                    if (isDerivable(labelIt.first, rowIt.first, dst))
+                        rederived.emplace_back(labelIt.first, rowIt.first, dst);
+
+    /// Insert the rederived and the new base edges and propagate them
+    baseEdges = newBaseEdges;
+    for (const auto& labelIt : baseEdges)
+        for (const auto& rowIt : labelIt.second)
+        {
+            NodeBS newDsts;
+            addEdges(labelIt.first, rowIt.first, rowIt.second, newDsts);
+        }
+    for (const auto& edge : rederived)
+    {
+        NodeBS dst, newDst;
+        dst.set(std::get<2>(edge));
+        addEdges(std::get<0>(edge), std::get<1>(edge), dst, newDst);
+    }
+    runRounds();
+
+    /// The graph only has the base edges of this run
+    for (const auto& labelIt : succMatrices)
+    {
+        for (const Matrix& rows : labelIt.second)
+        {
+            for (const auto& rowIt : rows)
+            {
+                if (rowIt.second.empty())
+                    continue;
+                CFLNode* src = graph->getGNode(rowIt.first);
+                for (NodeID dst : rowIt.second)
+                    graph->addCFLEdge(src, graph->getGNode(dst), labelIt.first);
+            }
+        }
+    }
+}
+
+std::string CFLMatrixSolver::getNodeKey(const NodeID id) const
+{
+    auto it = nodeKeys.find(id);
+    if (it == nodeKeys.end())
+        return "#" + std::to_string(id);
+    std::string key = it->second;
+    std::replace(key.begin(), key.end(), '\n', ' ');
+    return key;
+}
+
+std::string CFLMatrixSolver::getGrammarHash() const
+{
+    std::vector<std::string> prods;
+    auto addProd = [&](const Production& prod)
+    {
+        std::string str;
+        for (const Symbol& sym : prod)
+            str += std::to_string(u32_t(sym)) + ":" + grammar->symToStrDump(sym) + " ";
+        prods.push_back(str);
+    };
+    for (const Production& prod : grammar->getEpsilonProds())
+        addProd(prod);
+    for (const auto& it : grammar->getSingleRHSToProds())
+        for (const Production& prod : it.second)
+            addProd(prod);
+    for (const auto& it : grammar->getFirstRHSToProds())
+        for (const Production& prod : it.second)
+            addProd(prod);
+    std::sort(prods.begin(), prods.end());
+
+    /// FNV-1a, so that the hash does not depend on the standard library
+    u64_t hash = 0xcbf29ce484222325ULL;
+    for (const std::string& prod : prods)
+        for (const char c : prod + "\n")
+            hash = (hash ^ u8_t(c)) * 0x100000001b3ULL;
+    std::ostringstream ss;
+    ss << std::hex << hash;
+    return ss.str();
+}
+
+void CFLMatrixSolver::saveClosure(const std::string& fileName) const
+{
+    std::ofstream outFile(fileName);
+    if (!outFile.is_open())
+    {
+        SVFUtil::outs() << "Storing the closure to '" << fileName << "'...  error opening file for writing!\n";
+        return;
+    }
+    outFile << "CFLClosure\t" << getGrammarHash() << "\n";
+    for (auto it = graph->begin(); it != graph->end(); it++)
+        outFile << "node\t" << it->first << '\t' << getNodeKey(it->first) << "\n";
+    for (const auto& labelIt : succMatrices)
+    {
+        auto baseIt = baseEdges.find(labelIt.first);
+        for (const Matrix& rows : labelIt.second)
+        {
+            for (const auto& rowIt : rows)
+            {
+                const NodeBS* baseRow = nullptr;
+                if (baseIt != baseEdges.end())
+                {
+                    auto it = baseIt->second.find(rowIt.first);
+                    if (it != baseIt->second.end())
+                        baseRow = &it->second;
+                }
+                for (NodeID dst : rowIt.second)
+                    outFile << rowIt.first << '\t' << dst << '\t' << labelIt.first << '\t' << (baseRow && baseRow->test(dst)) << "\n";
+            }
+        }
+    }
+}
+
+/*!
+ * The whole file is checked before any edge is added. If it cannot be read or
+ * was solved with another grammar, false is returned and the next solve() starts
+ * from scratch. The saved nodes are mapped to the nodes of the graph with the
+ * same key, the others to IDs after the last node of the graph.
+ */
+bool CFLMatrixSolver::loadClosure(const std::string& fileName)
+{
+    SVFUtil::outs() << "Loading the closure from '" << fileName << "'...";
+
+    std::ifstream inFile(fileName);
+    if (!inFile.is_open())
+    {
+        SVFUtil::outs() << "  error opening file for reading!\n";
+        return false;
+    }
+    std::string line;
+    const std::string magic = "CFLClosure\t";
+    if (!std::getline(inFile, line) || line.compare(0, magic.size(), magic) != 0)
+    {
+        SVFUtil::outs() << "  not a closure file, solving from scratch\n";
+        return false;
+    }
+    if (line.substr(magic.size()) != getGrammarHash())
+    {
+        SVFUtil::outs() << "  solved with another grammar, solving from scratch\n";
+        return false;
+    }
+
+    /// Keys of the saved nodes
+    const std::string nodeTag = "node\t";
+    Map<NodeID, std::string> savedKeys;
+    Map<std::string, u32_t> savedKeyNum;
+    while (std::getline(inFile, line) && line.compare(0, nodeTag.size(), nodeTag) == 0)
+    {
+        std::istringstream ss(line.substr(nodeTag.size()));
+        NodeID id;
+        std::string key;
+        if (!(ss >> id) || ss.get() != '\t' || !std::getline(ss, key) || !savedKeys.emplace(id, key).second)
+        {
+            SVFUtil::outs() << "  malformed node " << line << ", solving from scratch\n";
+            return false;
+        }
+        savedKeyNum[key]++;
+    }
+
+    struct ClosureEdge
+    {
+        NodeID src;
+        NodeID dst;
+        u32_t ty;
+        bool isBase;
+    };
+    std::vector<ClosureEdge> edges;
+    const GrammarBase::Kind totalKind = grammar->getTotalKind();
+    for (bool hasLine = !inFile.fail(); hasLine; hasLine = bool(std::getline(inFile, line)))
+    {
+        std::istringstream ss(line);
+        NodeID src, dst;
+        u32_t ty, isBase;
+        std::string rest;
+        if (!(ss >> src >> dst >> ty >> isBase) || (ss >> rest) || isBase > 1 ||
+                !savedKeys.count(src) || !savedKeys.count(dst) || Symbol(ty).kind >= totalKind)
+        {
+            SVFUtil::outs() << "  malformed edge " << line << ", solving from scratch\n";
+            return false;
+        }
+        edges.push_back({src, dst, ty, isBase == 1});
+    }
+
+    /// Map each saved node to the node with its key if the key is unique in both graphs,
+    /// otherwise to a new ID, so that the mapping is one-to-one
+    Map<std::string, NodeID> keyToNode;
+    NodeID freeID = 0;
+    for (auto it = graph->begin(); it != graph->end(); it++)
+    {
+        auto keyIt = keyToNode.emplace(getNodeKey(it->first), it->first);
+        if (!keyIt.second)
+            keyIt.first->second = UINT_MAX;
+        freeID = std::max(freeID, it->first + 1);
+    }
+    Map<NodeID, NodeID> savedToNode;
+    u32_t numOfMapped = 0;
+    for (const auto& it : savedKeys)
+    {
+        auto keyIt = keyToNode.find(it.second);
+        if (keyIt != keyToNode.end() && keyIt->second != UINT_MAX && savedKeyNum[it.second] == 1)
+        {
+            savedToNode[it.first] = keyIt->second;
+            numOfMapped++;
+        }
+        else
+            savedToNode[it.first] = freeID++;
+    }
+
+    /// saveClosure writes the edges row by row, add each run of edges of a row at once
+    for (auto it = edges.begin(); it != edges.end();)
+    {
+        const u32_t ty = it->ty;
+        const NodeID savedSrc = it->src;
+        NodeBS dsts, baseDsts, newDsts;
+        for (; it != edges.end() && it->ty == ty && it->src == savedSrc; ++it)
+        {
+            dsts.set(savedToNode[it->dst]);
+            if (it->isBase)
+                baseDsts.set(savedToNode[it->dst]);
+        }
+        const NodeID src = savedToNode[savedSrc];
+        addEdges(ty, src, dsts, newDsts);
+        if (!baseDsts.empty())
+            baseEdges[ty][src] |= baseDsts;
+    }
+    SVFUtil::outs() << "  " << numOfMapped << " of " << savedKeys.size() << " nodes mapped";
+    delta.clear();
+    closureLoaded = true;
+    SVFUtil::outs() << "\n";
+    return true;
+}
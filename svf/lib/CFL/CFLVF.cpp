@@ -66,7 +66,31 @@ void CFLVF::initialize()
     normalizeCFLGrammar();
 
     // Initialize solver
-    solver = new CFLSolver(graph, grammar);
+    if (CFLMatrixSolver::isRequested())
+        solver = new CFLMatrixSolver(graph, grammar, getNodeKeys());
+    else
+        solver = new CFLSolver(graph, grammar);
+}
+
+/*!
+ * An SVFG node is keyed by its kind, function and the variable it defines, if any
+ */
+CFLMatrixSolver::NodeKeys CFLVF::getNodeKeys() const
+{
+    CFLMatrixSolver::NodeKeys keys;
+    if (!Options::CFLGraph().empty() || (Options::CFLClosureIn().empty() && Options::CFLClosureOut().empty()))
+        return keys;
+    for (auto it = graph->begin(); it != graph->end(); it++)
+    {
+        if (!svfg->hasGNode(it->first))
+            continue;
+        const SVFGNode* node = svfg->getGNode(it->first);
+        const FunObjVar* fun = node->getICFGNode() ? node->getFun() : nullptr;
+        const SVFVar* var = node->getValue();
+        keys[it->first] = std::to_string(node->getNodeKind()) + "\t" + (fun ? fun->getName() : "") + "\t" +
+                          (var ? var->getValueName() + "\t" + var->getSourceLoc() : "");
+    }
+    return keys;
 }
 
 void CFLVF::checkParameter()
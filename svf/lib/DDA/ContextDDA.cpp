@@ -69,14 +69,27 @@ void ContextDDA::initialize()
     flowDDA->initialize();
 }
 
+void ContextDDA::setSharedGraphMutex(std::mutex* m)
+{
+    DDAVFSolver<CxtVar,CxtPtSet,CxtLocDPItem>::setSharedGraphMutex(m);
+    flowDDA->setSharedGraphMutex(m);
+}
+
+void ContextDDA::setSharedSVFG(SVFG* svfg)
+{
+    DDAVFSolver<CxtVar,CxtPtSet,CxtLocDPItem>::setSharedSVFG(svfg);
+    flowDDA->setSharedSVFG(svfg);
+}
+
 /*!
  * Compute points-to set for a context-sensitive pointer
  */
 const CxtPtSet& ContextDDA::computeDDAPts(const CxtVar& var)
 {
 
+    evictResolvedDpms();
     resetQuery();
-    LocDPItem::setMaxBudget(Options::CxtBudget());
+    LocDPItem::setMaxBudget(getTrialBudget() ? getTrialBudget() : Options::CxtBudget());
 
     NodeID id = var.get_id();
     PAGNode* node = getPAG()->getGNode(id);
@@ -84,13 +97,21 @@ const CxtPtSet& ContextDDA::computeDDAPts(const CxtVar& var)
 
     // start DDA analysis
     DOTIMESTAT(double start = DDAStat::getClk(true));
-    const CxtPtSet& cpts = findPT(dpm);
+    const CxtPtSet* cpts = &findPT(dpm);
+    /// A requery may find further indirect call edges, so repeat until no stale dpm is reused
+    while(invalidateStaleDpms())
+    {
+        resetQuery();
+        cpts = &findPT(dpm);
+    }
     DOTIMESTAT(ddaStat->_AnaTimePerQuery = DDAStat::getClk(true) - start);
     DOTIMESTAT(ddaStat->_TotalTimeOfQueries += ddaStat->_AnaTimePerQuery);
+    if (!Options::DDAQueryReport().empty())
+        ddaStat->recordQuery(id, isOutOfBudgetQuery(), cpts->count());
 
     if(isOutOfBudgetQuery() == false)
-        unionPts(var,cpts);
-    else
+        unionPts(var,*cpts);
+    else if(getTrialBudget() == 0)
         handleOutOfBudgetDpm(dpm);
 
     if (this->printStat())
@@ -154,6 +175,8 @@ bool ContextDDA::isCondCompatible(const ContextCond& cxt1, const ContextCond& cx
 CxtPtSet ContextDDA::processGepPts(const GepSVFGNode* gep, const CxtPtSet& srcPts)
 {
     CxtPtSet tmpDstPts;
+    /// Field objects are created in the SVFIR on demand
+    std::unique_lock<std::mutex> lock = lockSharedGraphs();
     for (CxtPtSet::iterator piter = srcPts.begin(); piter != srcPts.end(); ++piter)
     {
 
@@ -216,6 +239,7 @@ CallSiteID ContextDDA::getCSIDAtCall(CxtLocDPItem&, const SVFGEdge* edge)
     else
         svfg_csId = SVFUtil::cast<CallIndSVFGEdge>(edge)->getCallSiteId();
 
+    std::unique_lock<std::mutex> lock = lockSharedGraphs();
     const CallICFGNode* cbn = getSVFG()->getCallSite(svfg_csId);
     const FunObjVar* callee = edge->getDstNode()->getFun();
 
@@ -240,6 +264,7 @@ CallSiteID ContextDDA::getCSIDAtRet(CxtLocDPItem&, const SVFGEdge* edge)
     else
         svfg_csId = SVFUtil::cast<RetIndSVFGEdge>(edge)->getCallSiteId();
 
+    std::unique_lock<std::mutex> lock = lockSharedGraphs();
     const CallICFGNode* cbn = getSVFG()->getCallSite(svfg_csId);
     const FunObjVar* callee = edge->getSrcNode()->getFun();
 
@@ -263,7 +288,7 @@ bool ContextDDA::handleBKCondition(CxtLocDPItem& dpm, const SVFGEdge* edge)
         if(CallSiteID csId = getCSIDAtCall(dpm,edge))
         {
 
-            if(isEdgeInRecursion(csId))
+            if(isEdgeInRecursion(csId) || isInsensitiveCallRet(edge))
             {
                 DBOUT(DDDA,outs() << "\t\t call edge " << getCallGraph()->getCallerOfCallSite(csId)->getName() <<
                       "=>" << getCallGraph()->getCalleeOfCallSite(csId)->getName() << "in recursion \n");
@@ -291,7 +316,7 @@ bool ContextDDA::handleBKCondition(CxtLocDPItem& dpm, const SVFGEdge* edge)
         if(CallSiteID csId = getCSIDAtRet(dpm,edge))
         {
 
-            if(isEdgeInRecursion(csId))
+            if(isEdgeInRecursion(csId) || isInsensitiveCallRet(edge))
             {
                 DBOUT(DDDA,outs() << "\t\t return edge " << getCallGraph()->getCalleeOfCallSite(csId)->getName() <<
                       "=>" << getCallGraph()->getCallerOfCallSite(csId)->getName() << "in recursion \n");
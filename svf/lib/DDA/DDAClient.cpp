@@ -36,6 +36,7 @@
 
 #include "DDA/DDAClient.h"
 #include "DDA/FlowDDA.h"
+#include "DDA/ContextDDA.h"
 #include <iostream>
 #include <iomanip>	// for std::setw
 
@@ -54,6 +55,12 @@ void DDAClient::answerQueries(PointerAnalysis* pta)
 
     collectCandidateQueries(pta->getPAG());
 
+    /// Adaptive budgets: every query is answered with the trial budget first,
+    /// the out-of-budget ones are re-run with the full budget once all others are answered
+    const u32_t trialBudget = Options::DDATrialBudget();
+    setTrialBudget(pta, trialBudget);
+    OrderedNodeSet escalated;
+
     u32_t count = 0;
     for (OrderedNodeSet::iterator nIter = candidateQueries.begin();
             nIter != candidateQueries.end(); ++nIter,++count)
@@ -67,14 +74,50 @@ void DDAClient::answerQueries(PointerAnalysis* pta)
                   " [" << count + 1<< "/" << candidateQueries.size() << "]" << " \n");
             setCurrentQueryPtr(node->getId());
             pta->computeDDAPts(node->getId());
+            if(trialBudget && isOutOfBudgetQuery(pta))
+                escalated.insert(node->getId());
         }
     }
 
+    if (!escalated.empty())
+    {
+        setTrialBudget(pta, 0);
+        stat->_NumOfEscalatedQueries = escalated.size();
+        for (NodeID ptr : escalated)
+        {
+            DBOUT(DGENERAL,outs() << "\n@@Escalating PointsTo for :" << ptr << " \n");
+            setCurrentQueryPtr(ptr);
+            pta->computeDDAPts(ptr);
+            if(!isOutOfBudgetQuery(pta))
+                stat->_NumOfResolvedEscalations++;
+        }
+    }
+
+    if (!Options::DDAQueryReport().empty())
+        stat->dumpQueryReport(Options::DDAQueryReport());
+
     vmrss = vmsize = 0;
     SVFUtil::getMemoryUsageKB(&vmrss, &vmsize);
     stat->setMemUsageAfter(vmrss, vmsize);
 }
 
+void DDAClient::setTrialBudget(PointerAnalysis* pta, u32_t budget)
+{
+    if (pta->getAnalysisTy() == PointerAnalysis::Cxt_DDA)
+        static_cast<ContextDDA*>(pta)->setTrialBudget(budget);
+    else if (pta->getAnalysisTy() == PointerAnalysis::FlowS_DDA)
+        static_cast<FlowDDA*>(pta)->setTrialBudget(budget);
+}
+
+bool DDAClient::isOutOfBudgetQuery(PointerAnalysis* pta) const
+{
+    if (pta->getAnalysisTy() == PointerAnalysis::Cxt_DDA)
+        return static_cast<ContextDDA*>(pta)->isOutOfBudgetQuery();
+    else if (pta->getAnalysisTy() == PointerAnalysis::FlowS_DDA)
+        return static_cast<FlowDDA*>(pta)->isOutOfBudgetQuery();
+    return false;
+}
+
 OrderedNodeSet& FunptrDDAClient::collectCandidateQueries(SVFIR* p)
 {
     setPAG(p);
@@ -36,7 +36,14 @@
 #include "DDA/DDAClient.h"
 
 #include <sstream>
+#include <fstream>
 #include <limits.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -57,6 +64,12 @@ void DDAPass::runOnModule(SVFIR* pag)
     /// initialization for llvm alias analyzer
     //InitializeAliasAnalysis(this, getDataLayout(&module));
 
+    if (Options::DDAServer())
+    {
+        serveQueries(pag, std::cin, outs());
+        return;
+    }
+
     selectClient();
 
     for (u32_t i = PointerAnalysis::FlowS_DDA;
@@ -112,22 +125,7 @@ void DDAPass::runPointerAnalysis(SVFIR* pag, u32_t kind)
     ContextCond::setMaxCxtLen(Options::MaxContextLen());
 
     /// Initialize pointer analysis.
-    switch (kind)
-    {
-    case PointerAnalysis::Cxt_DDA:
-    {
-        _pta = std::make_unique<ContextDDA>(pag, _client);
-        break;
-    }
-    case PointerAnalysis::FlowS_DDA:
-    {
-        _pta = std::make_unique<FlowDDA>(pag, _client);
-        break;
-    }
-    default:
-        outs() << "This pointer analysis has not been implemented yet.\n";
-        break;
-    }
+    _pta.reset(createDDA(pag, kind, _client));
 
     if(Options::WPANum())
     {
@@ -137,6 +135,11 @@ void DDAPass::runPointerAnalysis(SVFIR* pag, u32_t kind)
     {
         ///initialize
         _pta->initialize();
+        if (kind == PointerAnalysis::Cxt_DDA)
+        {
+            ContextDDA* cxtDDA = static_cast<ContextDDA*>(_pta.get());
+            setupCxtInsensitiveEdges(cxtDDA, cxtDDA->getSVFG(), cxtDDA->getInsensitiveEdgeSet());
+        }
         ///compute points-to
         _client->answerQueries(_pta.get());
         ///finalize
@@ -153,6 +156,462 @@ void DDAPass::runPointerAnalysis(SVFIR* pag, u32_t kind)
 }
 
 
+/// Create a demand-driven pointer analysis of the given kind
+PointerAnalysis* DDAPass::createDDA(SVFIR* pag, u32_t kind, DDAClient* client)
+{
+    switch (kind)
+    {
+    case PointerAnalysis::Cxt_DDA:
+        return new ContextDDA(pag, client);
+    case PointerAnalysis::FlowS_DDA:
+        return new FlowDDA(pag, client);
+    default:
+        outs() << "This pointer analysis has not been implemented yet.\n";
+        return nullptr;
+    }
+}
+
+/*!
+ * Query server.
+ * The program is loaded once. The SVFIR, Andersen's pre-analysis and one SVFG are shared
+ * by all workers, while each worker owns a ContextDDA/FlowDDA solver with its own call
+ * graph, which on-the-fly call graph resolution adds edges to. The SVFG is only read by
+ * the workers. The shared parts updated by the solvers, i.e., the field objects of the
+ * SVFIR and the call site IDs of the call graphs, are only accessed under one lock.
+ * Requests (one per line):
+ *   pts <ptr>            -> <seq> pts <ptr> <latency(us)> [oob] : <objs...>
+ *   alias <ptr1> <ptr2>  -> <seq> alias <ptr1> <ptr2> <latency(us)> [oob] : <NoAlias|MayAlias|MustAlias>
+ *   stats                -> counters of the requests answered so far
+ *   quit
+ * Answers are written once ready and carry the sequence number of their request.
+ * With -dda-server-check, the requests are answered again one at a time at the end
+ * and the answers differing from the concurrent ones are reported.
+ */
+void DDAPass::serveQueries(SVFIR* pag, std::istream& in, std::ostream& out)
+{
+    ContextCond::setMaxPathLen(Options::MaxPathLen());
+    ContextCond::setMaxCxtLen(Options::MaxContextLen());
+
+    u32_t kind = PointerAnalysis::Cxt_DDA;
+    if (Options::DDASelected(PointerAnalysis::FlowS_DDA) && !Options::DDASelected(PointerAnalysis::Cxt_DDA))
+        kind = PointerAnalysis::FlowS_DDA;
+
+    /// One SVFG is built for all solvers, with the indirect calls of Andersen's call graph
+    /// connected, so that the solvers only read it and skip the indirect calls they have not
+    /// resolved. The callees resolved by the solvers are within those of Andersen's analysis.
+    /// Its edges of an indirect call are looked up as connected on an SVFG without -opt-svfg.
+    AndersenWaveDiff* ander = AndersenWaveDiff::createAndersenWaveDiff(pag);
+    SVFGBuilder svfgBuilder(true, false);
+    SVFG* svfg = svfgBuilder.buildPTROnlySVFG(ander);
+
+    /// Processing a gep creates its field objects in the SVFIR on demand. The points-to sets
+    /// of the solvers are within Andersen's ones, so create the field objects of Andersen's
+    /// points-to sets up front, and the workers only look them up. Those not found are still
+    /// created under sharedGraphMutex.
+    for (const SVFStmt* stmt : pag->getSVFStmtSet(SVFStmt::Gep))
+    {
+        const GepStmt* gep = SVFUtil::cast<GepStmt>(stmt);
+        if (gep->isVariantFieldGep())
+            continue;
+        for (NodeID obj : ander->getPts(gep->getRHSVarID()))
+        {
+            if (!pag->isBlkObjOrConstantObj(obj))
+                pag->getGepObjVar(obj, gep->getAccessPath().getConstantStructFldIdx());
+        }
+    }
+
+    /// Looking up Andersen's points-to set of a node without one inserts an entry,
+    /// so create the entries of all nodes before the workers share the analysis
+    for (SVFIR::iterator it = pag->begin(), eit = pag->end(); it != eit; ++it)
+        ander->getPts(it->first);
+
+    /// Solvers are initialised sequentially before the workers start
+    u32_t threadNum = Options::DDAServerThreads() ? Options::DDAServerThreads() : 1;
+    std::vector<std::unique_ptr<DDAClient>> clients;
+    std::vector<std::unique_ptr<PointerAnalysis>> solvers;
+    std::mutex sharedGraphMutex;
+    for (u32_t i = 0; i < threadNum; i++)
+    {
+        clients.push_back(std::make_unique<DDAClient>());
+        solvers.push_back(std::unique_ptr<PointerAnalysis>(createDDA(pag, kind, clients.back().get())));
+        initServerSolver(solvers.back().get(), threadNum > 1 ? &sharedGraphMutex : nullptr, svfg);
+    }
+
+    std::deque<std::pair<u32_t, std::string>> requests;
+    std::mutex requestMutex;
+    std::condition_variable requestCond;
+    bool closed = false;
+
+    /// Counters and answers below are guarded by outMutex
+    std::mutex outMutex;
+    u64_t answeredNum = 0;
+    u64_t oobNum = 0;
+    u64_t totalLatency = 0;
+    u64_t maxLatency = 0;
+    /// <seq, request, response> of the answers within budget, kept for Options::DDAServerCheck
+    std::vector<std::tuple<u32_t, std::string, std::string>> answers;
+
+    auto printStats = [&]()
+    {
+        out << "stats answered " << answeredNum << " out-of-budget " << oobNum
+            << " avg-latency(us) " << (answeredNum ? totalLatency / answeredNum : 0)
+            << " max-latency(us) " << maxLatency << std::endl;
+    };
+
+    auto worker = [&](PointerAnalysis* pta)
+    {
+        while (true)
+        {
+            std::pair<u32_t, std::string> request;
+            {
+                std::unique_lock<std::mutex> lock(requestMutex);
+                requestCond.wait(lock, [&]()
+                {
+                    return closed || !requests.empty();
+                });
+                if (requests.empty())
+                    return;
+                request = std::move(requests.front());
+                requests.pop_front();
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            std::string response;
+            bool oob = answerRequest(pta, request.second, response);
+            u64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            answeredNum++;
+            if (oob)
+                oobNum++;
+            totalLatency += latency;
+            maxLatency = std::max(maxLatency, latency);
+            if (Options::DDAServerCheck() && !oob)
+                answers.emplace_back(request.first, request.second, response);
+            out << request.first << " " << request.second << " " << latency
+                << (oob ? " oob" : "") << " : " << response << std::endl;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (u32_t i = 0; i < threadNum; i++)
+        workers.emplace_back(worker, solvers[i].get());
+
+    u32_t seq = 0;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::string cmd;
+        std::istringstream ss(line);
+        if (!(ss >> cmd))
+            continue;
+        if (cmd == "quit")
+            break;
+        if (cmd == "stats")
+        {
+            std::lock_guard<std::mutex> lock(outMutex);
+            printStats();
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            requests.emplace_back(seq++, line);
+        }
+        requestCond.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        closed = true;
+    }
+    requestCond.notify_all();
+    for (std::thread& t : workers)
+        t.join();
+
+    printStats();
+
+    if (Options::DDAServerCheck())
+        checkAnswers(pag, kind, answers, out);
+}
+
+/*!
+ * Answer the requests again in order of arrival with a new solver on this thread and
+ * report the concurrent answers that differ. Answers out of budget on either side fall
+ * back to Andersen's analysis at different points and are not compared.
+ */
+void DDAPass::checkAnswers(SVFIR* pag, u32_t kind, std::vector<std::tuple<u32_t, std::string, std::string>>& answers,
+                           std::ostream& out)
+{
+    std::sort(answers.begin(), answers.end());
+    DDAClient client;
+    std::unique_ptr<PointerAnalysis> solver(createDDA(pag, kind, &client));
+    initServerSolver(solver.get(), nullptr, nullptr);
+
+    u32_t comparedNum = 0;
+    u32_t mismatchNum = 0;
+    for (const auto& answer : answers)
+    {
+        std::string response;
+        if (answerRequest(solver.get(), std::get<1>(answer), response))
+            continue;
+        comparedNum++;
+        if (response != std::get<2>(answer))
+        {
+            mismatchNum++;
+            out << "check mismatch " << std::get<0>(answer) << " " << std::get<1>(answer)
+                << " : concurrent " << std::get<2>(answer) << " serial " << response << std::endl;
+        }
+    }
+    out << "check compared " << comparedNum << " mismatches " << mismatchNum << std::endl;
+}
+
+/*!
+ * Initialise a solver of the query server
+ */
+void DDAPass::initServerSolver(PointerAnalysis* pta, std::mutex* sharedGraphMutex, SVFG* sharedSVFG)
+{
+    pta->disablePrintStat();
+    if (pta->getAnalysisTy() == PointerAnalysis::Cxt_DDA)
+    {
+        ContextDDA* cxtDDA = static_cast<ContextDDA*>(pta);
+        cxtDDA->setSharedGraphMutex(sharedGraphMutex);
+        if (sharedSVFG)
+            cxtDDA->setSharedSVFG(sharedSVFG);
+        cxtDDA->initialize();
+        setupCxtInsensitiveEdges(cxtDDA, cxtDDA->getSVFG(), cxtDDA->getInsensitiveEdgeSet());
+    }
+    else
+    {
+        FlowDDA* flowDDA = static_cast<FlowDDA*>(pta);
+        flowDDA->setSharedGraphMutex(sharedGraphMutex);
+        if (sharedSVFG)
+            flowDDA->setSharedSVFG(sharedSVFG);
+        flowDDA->initialize();
+    }
+}
+
+/*!
+ * Answer one server request with the solver of a worker
+ */
+bool DDAPass::answerRequest(PointerAnalysis* pta, const std::string& request, std::string& response)
+{
+    SVFIR* pag = pta->getPAG();
+    std::istringstream ss(request);
+    std::string cmd;
+    ss >> cmd;
+
+    std::vector<NodeID> ptrs;
+    NodeID id;
+    while (ss >> id)
+        ptrs.push_back(id);
+
+    if ((cmd == "pts" && ptrs.size() != 1) || (cmd == "alias" && ptrs.size() != 2) || (cmd != "pts" && cmd != "alias"))
+    {
+        response = "error: expect 'pts <ptr>' or 'alias <ptr1> <ptr2>'";
+        return false;
+    }
+
+    bool oob = false;
+    PointsTo pts;
+    std::vector<CxtPtSet> cxtPts;
+    for (NodeID ptr : ptrs)
+    {
+        if (!pag->hasGNode(ptr) || !pag->isValidTopLevelPtr(pag->getGNode(ptr)))
+        {
+            response = "error: " + std::to_string(ptr) + " is not a top-level pointer";
+            return false;
+        }
+        if (pta->getAnalysisTy() == PointerAnalysis::Cxt_DDA)
+        {
+            ContextDDA* cxtDDA = static_cast<ContextDDA*>(pta);
+            ContextCond cxt;
+            CxtVar var(cxt, ptr);
+            cxtPts.push_back(cxtDDA->computeDDAPts(var));
+            pts = cxtDDA->getBVPointsTo(cxtPts.back());
+            oob |= cxtDDA->isOutOfBudgetQuery();
+        }
+        else
+        {
+            FlowDDA* flowDDA = static_cast<FlowDDA*>(pta);
+            flowDDA->computeDDAPts(ptr);
+            pts = flowDDA->getPts(ptr);
+            oob |= flowDDA->isOutOfBudgetQuery();
+        }
+    }
+
+    std::stringstream rawstr;
+    if (cmd == "pts")
+    {
+        for (NodeID obj : pts)
+            rawstr << obj << " ";
+    }
+    else
+    {
+        /// The points-to sets of a ContextDDA are only normalized by finalize(), so
+        /// its alias result is computed from the sets of the two queries instead
+        AliasResult result = cxtPts.empty() ? pta->alias(ptrs[0], ptrs[1]) :
+                             static_cast<ContextDDA*>(pta)->alias(cxtPts[0], cxtPts[1]);
+        rawstr << (result == AliasResult::NoAlias ? "NoAlias" : result == AliasResult::MustAlias ? "MustAlias" : "MayAlias");
+    }
+    response = rawstr.str();
+    return oob;
+}
+
+/*!
+ * Mark context insensitive edges of a ContextDDA.
+ * The SVFG SCC detection and the scan of all edges are skipped when the edges
+ * are read from Options::DDAInsenEdgeFile, which is written by the first run.
+ */
+void DDAPass::setupCxtInsensitiveEdges(PointerAnalysis* pta, SVFG* svfg, SVFGEdgeSet& insensitveEdges)
+{
+    if (!Options::InsenRecur() && !Options::InsenCycle())
+        return;
+
+    const std::string& fileName = Options::DDAInsenEdgeFile();
+    if (!fileName.empty() && readCxtInsensitiveEdges(fileName, svfg, insensitveEdges))
+        return;
+
+    std::unique_ptr<SVFGSCC> svfgSCC;
+    if (Options::InsenCycle())
+    {
+        svfgSCC = std::make_unique<SVFGSCC>(svfg);
+        svfgSCC->find();
+    }
+    initCxtInsensitiveEdges(pta, svfg, svfgSCC.get(), insensitveEdges);
+
+    if (!fileName.empty())
+        writeCxtInsensitiveEdges(fileName, svfg, insensitveEdges);
+}
+
+/*!
+ * Read context insensitive edges written for an SVFG with the same fingerprint.
+ * The edges are resolved through the node keys, which are unique in the SVFG
+ * except for the keys of nodes sharing all of their contents.
+ */
+bool DDAPass::readCxtInsensitiveEdges(const std::string& fileName, const SVFG* svfg, SVFGEdgeSet& insensitveEdges)
+{
+    std::ifstream in(fileName);
+    if (!in.is_open())
+        return false;
+
+    std::string mode;
+    u32_t nodeNum = 0;
+    u64_t fingerprint = 0;
+    if (!(in >> mode >> nodeNum >> fingerprint) || mode != (Options::InsenRecur() ? "recur" : "cycle")
+            || nodeNum != svfg->getTotalNodeNum() || fingerprint != fingerprintSVFG(svfg))
+    {
+        outs() << "context-insensitive edges in " << fileName << " are of another SVFG, recomputing them\n";
+        return false;
+    }
+
+    /// nullptr marks a key shared by several nodes
+    Map<u64_t, const SVFGNode*> keyToNode;
+    for (const auto& item : *svfg)
+    {
+        auto res = keyToNode.emplace(getSVFGNodeKey(item.second), item.second);
+        if (!res.second)
+            res.first->second = nullptr;
+    }
+
+    SVFGEdgeSet edges;
+    u64_t srcKey, dstKey;
+    SVFGEdge::GEdgeKind flag;
+    while (in >> srcKey >> dstKey >> flag)
+    {
+        const SVFGEdge* found = nullptr;
+        auto srcIt = keyToNode.find(srcKey);
+        auto dstIt = keyToNode.find(dstKey);
+        if (srcIt != keyToNode.end() && srcIt->second && dstIt != keyToNode.end() && dstIt->second)
+        {
+            for (const SVFGEdge* edge : srcIt->second->getOutEdges())
+            {
+                if (edge->getDstNode() == dstIt->second && edge->getEdgeKindWithoutMask() == flag)
+                {
+                    found = edge;
+                    break;
+                }
+            }
+        }
+        if (found == nullptr)
+        {
+            outs() << "context-insensitive edge not found in the SVFG, recomputing them\n";
+            return false;
+        }
+        edges.insert(found);
+    }
+    if (!in.eof())
+    {
+        outs() << "malformed context-insensitive edges in " << fileName << ", recomputing them\n";
+        return false;
+    }
+    insensitveEdges.insert(edges.begin(), edges.end());
+    return true;
+}
+
+void DDAPass::writeCxtInsensitiveEdges(const std::string& fileName, const SVFG* svfg, const SVFGEdgeSet& insensitveEdges)
+{
+    std::ofstream out(fileName);
+    if (!out.is_open())
+    {
+        writeWrnMsg("cannot write context-insensitive edges to " + fileName);
+        return;
+    }
+    out << (Options::InsenRecur() ? "recur" : "cycle") << " " << svfg->getTotalNodeNum() << " " << fingerprintSVFG(svfg) << "\n";
+    for (const SVFGEdge* edge : insensitveEdges)
+        out << getSVFGNodeKey(edge->getSrcNode()) << " " << getSVFGNodeKey(edge->getDstNode()) << " "
+            << edge->getEdgeKindWithoutMask() << "\n";
+}
+
+static inline u64_t mixHash(u64_t h, u64_t v)
+{
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+u64_t DDAPass::getSVFGNodeKey(const SVFGNode* node)
+{
+    u64_t key = mixHash(node->getNodeKind(), node->getICFGNode() ? node->getICFGNode()->getId() + 1 : 0);
+    if (const StmtVFGNode* stmt = SVFUtil::dyn_cast<StmtVFGNode>(node))
+        key = mixHash(mixHash(key, stmt->getPAGSrcNodeID()), stmt->getPAGDstNodeID());
+    else if (const SVFVar* var = node->getValue())
+        key = mixHash(key, var->getId() + 1);
+
+    if (const MRSVFGNode* mr = SVFUtil::dyn_cast<MRSVFGNode>(node))
+    {
+        for (NodeID obj : mr->getPointsTo())
+            key = mixHash(key, obj);
+    }
+    if (const InterMSSAPHISVFGNode* phi = SVFUtil::dyn_cast<InterMSSAPHISVFGNode>(node))
+        key = mixHash(key, phi->isFormalINPHI() ? phi->getFun()->getId() : phi->getCallSite()->getId());
+    else if (const InterPHIVFGNode* phi = SVFUtil::dyn_cast<InterPHIVFGNode>(node))
+        key = mixHash(key, phi->isFormalParmPHI() ? phi->getFun()->getId() : phi->getCallSite()->getId());
+    return key;
+}
+
+/*!
+ * The hashes of the nodes and edges are summed, so that the fingerprint does not
+ * depend on the order of iterating the graph
+ */
+u64_t DDAPass::fingerprintSVFG(const SVFG* svfg)
+{
+    Map<NodeID, u64_t> keys;
+    for (const auto& item : *svfg)
+        keys[item.first] = getSVFGNodeKey(item.second);
+
+    u64_t fingerprint = 0;
+    for (const auto& item : *svfg)
+    {
+        fingerprint += keys[item.first];
+        for (const SVFGEdge* edge : item.second->getOutEdges())
+            fingerprint += mixHash(mixHash(keys[edge->getSrcID()], keys[edge->getDstID()]), edge->getEdgeKindWithoutMask());
+    }
+    return fingerprint;
+}
+
 /*!
  * Initialize context insensitive Edge for DDA
  */
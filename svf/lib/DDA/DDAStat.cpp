@@ -34,6 +34,7 @@
 #include "MemoryModel/PointsTo.h"
 
 #include <iomanip>
+#include <fstream>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -82,6 +83,14 @@ void DDAStat::initDefault()
     _AnaTimePerQuery = 0;
     _AnaTimeCyclePerQuery = 0;
     _TotalTimeOfQueries = 0;
+
+    _NumOfPTLookups = 0;
+    _NumOfCrossQueryHits = 0;
+    _NumOfStaleInvalidations = 0;
+    _NumOfRequeries = 0;
+    _NumOfEvictedDPMs = 0;
+    _NumOfEscalatedQueries = 0;
+    _NumOfResolvedEscalations = 0;
 }
 
 SVFG* DDAStat::getSVFG() const
@@ -206,6 +215,41 @@ void DDAStat::performStatPerQuery(NodeID ptr)
     _NumOfIndCallEdgeSolved = getPTA()->getNumOfResolvedIndCallEdge();
 }
 
+void DDAStat::recordQuery(NodeID ptr, bool outOfBudget, u32_t ptsSize)
+{
+    u32_t numOfDPM = 0;
+    if(flowDDA)
+    {
+        for(const auto& it : flowDDA->getLocToDPMVecMap())
+            numOfDPM += it.second.size();
+    }
+    else if(contextDDA)
+    {
+        for(const auto& it : contextDDA->getLocToDPMVecMap())
+            numOfDPM += it.second.size();
+    }
+    u32_t vmrss = 0;
+    u32_t vmsize = 0;
+    SVFUtil::getMemoryUsageKB(&vmrss, &vmsize);
+
+    queryRecords.push_back({ptr, LocDPItem::getMaxBudget(), _NumOfStep, _AnaTimePerQuery/TIMEINTERVAL,
+                            numOfDPM, vmrss, ptsSize, outOfBudget});
+}
+
+void DDAStat::dumpQueryReport(const std::string& fileName) const
+{
+    std::ofstream out(fileName);
+    if (!out.is_open())
+    {
+        SVFUtil::errs() << "Cannot write the DDA query report to " << fileName << "\n";
+        return;
+    }
+    out << "ptr,budget,steps,time,dpms,vmrss_kb,pts,out_of_budget\n";
+    for (const QueryRecord& r : queryRecords)
+        out << r.ptr << "," << r.budget << "," << r.steps << "," << r.time << "," << r.numOfDPM << ","
+            << r.vmrss << "," << r.ptsSize << "," << r.outOfBudget << "\n";
+}
+
 void DDAStat::getNumOfOOBQuery()
 {
     if (flowDDA)
@@ -263,6 +307,13 @@ void DDAStat::performStat()
     PTNumStatMap["NumOfMustAA"] = _TotalNumOfMustAliases;
     PTNumStatMap["NumOfInfePath"] = _TotalNumOfInfeasiblePath;
     PTNumStatMap["NumOfStore"] = SVFIR::getPAG()->getPTASVFStmtSet(SVFStmt::Store).size();
+    PTNumStatMap["CrossQueryHits"] = _NumOfCrossQueryHits;
+    PTNumStatMap["StaleInvalidations"] = _NumOfStaleInvalidations;
+    PTNumStatMap["Requeries"] = _NumOfRequeries;
+    PTNumStatMap["EvictedDPM"] = _NumOfEvictedDPMs;
+    PTNumStatMap["EscalatedQueries"] = _NumOfEscalatedQueries;
+    PTNumStatMap["ResolvedEscalations"] = _NumOfResolvedEscalations;
+    timeStatMap["CrossQueryHitRate"] = _NumOfPTLookups ? (double)_NumOfCrossQueryHits/_NumOfPTLookups : 0;
     timeStatMap["MemoryUsageVmrss"] = _vmrssUsageAfter - _vmrssUsageBefore;
     timeStatMap["MemoryUsageVmsize"] = _vmsizeUsageAfter - _vmsizeUsageBefore;
 
@@ -42,21 +42,30 @@ using namespace SVFUtil;
  */
 void FlowDDA::computeDDAPts(NodeID id)
 {
+    evictResolvedDpms();
     resetQuery();
-    LocDPItem::setMaxBudget(Options::FlowBudget());
+    LocDPItem::setMaxBudget(getTrialBudget() ? getTrialBudget() : Options::FlowBudget());
 
     PAGNode* node = getPAG()->getGNode(id);
     LocDPItem dpm = getDPIm(node->getId(),getDefSVFGNode(node));
 
     /// start DDA analysis
     DOTIMESTAT(double start = DDAStat::getClk(true));
-    const PointsTo& pts = findPT(dpm);
+    const PointsTo* pts = &findPT(dpm);
+    /// A requery may find further indirect call edges, so repeat until no stale dpm is reused
+    while(invalidateStaleDpms())
+    {
+        resetQuery();
+        pts = &findPT(dpm);
+    }
     DOTIMESTAT(ddaStat->_AnaTimePerQuery = DDAStat::getClk(true) - start);
     DOTIMESTAT(ddaStat->_TotalTimeOfQueries += ddaStat->_AnaTimePerQuery);
+    if (!Options::DDAQueryReport().empty())
+        ddaStat->recordQuery(id, isOutOfBudgetQuery(), pts->count());
 
     if(isOutOfBudgetQuery() == false)
-        unionPts(node->getId(),pts);
-    else
+        unionPts(node->getId(),*pts);
+    else if(getTrialBudget() == 0)
         handleOutOfBudgetDpm(dpm);
 
     if(this->printStat())
@@ -141,6 +150,8 @@ bool FlowDDA::handleBKCondition(LocDPItem& dpm, const SVFGEdge* edge)
 PointsTo FlowDDA::processGepPts(const GepSVFGNode* gep, const PointsTo& srcPts)
 {
     PointsTo tmpDstPts;
+    /// Field objects are created in the SVFIR on demand
+    std::unique_lock<std::mutex> lock = lockSharedGraphs();
     for (PointsTo::iterator piter = srcPts.begin(); piter != srcPts.end(); ++piter)
     {
         NodeID ptd = *piter;
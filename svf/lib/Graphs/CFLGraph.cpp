@@ -46,25 +46,20 @@ void CFLGraph::addCFLNode(NodeID id, CFLNode* node)
 
 const CFLEdge* CFLGraph::addCFLEdge(CFLNode* src, CFLNode* dst, CFLEdge::GEdgeFlag label)
 {
-    CFLEdge* edge = new CFLEdge(src,dst,label);
-    if(cflEdgeSet.insert(edge).second)
-    {
-        src->addOutgoingEdge(edge);
-        dst->addIngoingEdge(edge);
-        return edge;
-    }
-    else
-    {
-        delete edge;
+    if (hasEdge(src, dst, label))
         return nullptr;
-    }
+    CFLEdge* edge = new CFLEdge(src,dst,label);
+    src->addOutgoingEdge(edge);
+    dst->addIngoingEdge(edge);
+    incEdgeNum();
+    return edge;
 }
 
 const CFLEdge* CFLGraph::hasEdge(CFLNode* src, CFLNode* dst, CFLEdge::GEdgeFlag label)
 {
     CFLEdge edge(src,dst,label);
-    auto it = cflEdgeSet.find(&edge);
-    if(it !=cflEdgeSet.end())
+    auto it = src->getOutEdges().find(&edge);
+    if(it != src->getOutEdges().end())
         return *it;
     else
         return nullptr;
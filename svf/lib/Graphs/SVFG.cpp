@@ -587,7 +587,8 @@ void SVFG::getInterVFEdgesForIndirectCallSite(const CallICFGNode* callICFGNode,
     const RetICFGNode* retICFGNode = callICFGNode->getRetICFGNode();
 
     // Find inter direct call edges between actual param and formal param.
-    if (pag->hasCallSiteArgsMap(callICFGNode) && pag->hasFunArgsList(callee))
+    if (pag->hasCallSiteArgsMap(callICFGNode) && pag->hasFunArgsList(callee) &&
+            matchArgs(callICFGNode, callee))
     {
         const SVFIR::SVFVarList& csArgList = pag->getCallSiteArgsList(callICFGNode);
         const SVFIR::SVFVarList& funArgList = pag->getFunArgsList(callee);
@@ -0,0 +1,159 @@
+//===- FSMPTA.cpp -- Flow-sensitive analysis of multithreaded programs---------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+
+/*
+ * FSMPTA.cpp
+ *
+ */
+
+#include "Util/Options.h"
+#include "MTA/FSMPTA.h"
+#include "MTA/MHP.h"
+#include "MTA/LockAnalysis.h"
+#include "MemoryModel/AliasOracle.h"
+#include "WPA/Andersen.h"
+#include "WPA/WPAStat.h"
+#include <atomic>
+#include <thread>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+void MTASVFGBuilder::buildSVFG()
+{
+    SVFGBuilder::buildSVFG();
+    connectMHPEdges(svfg->getMSSA()->getPTA());
+}
+
+/*!
+ * A store s interferes with a load or store d of another thread if
+ * (1) the pointers of s and d may alias,
+ * (2) s and d may happen in parallel, and
+ * (3) s and d are not protected by a common lock, unless -fsmpta-locked-edges
+ * in which case the edge s --> d carries the objects both may access.
+ * As in MTA::detect, the candidate stores of d are found through an index from
+ * objects to stores, and the MHP and lock checks of different d run in parallel.
+ */
+void MTASVFGBuilder::connectMHPEdges(BVDataPTAImpl* pta)
+{
+    DBOUT(DGENERAL, outs() << pasMsg("Add thread interference edges to SVFG\n"));
+
+    std::vector<const StoreSVFGNode*> stores;
+    std::vector<const StmtSVFGNode*> accesses; ///< loads and stores
+    for (const auto& item : *svfg)
+    {
+        if (const StoreSVFGNode* store = dyn_cast<StoreSVFGNode>(item.second))
+        {
+            stores.push_back(store);
+            accesses.push_back(store);
+        }
+        else if (const LoadSVFGNode* load = dyn_cast<LoadSVFGNode>(item.second))
+            accesses.push_back(load);
+    }
+
+    /// The oracle computes every points-to set up front, so that the PTA is only read by the threads below
+    AliasOracle oracle(pta);
+    auto getPointer = [](const StmtSVFGNode* node)
+    {
+        return isa<StoreSVFGNode>(node) ? node->getPAGDstNodeID() : node->getPAGSrcNodeID();
+    };
+    Map<NodeID, NodeBS> objToStores;
+    for (u32_t i = 0; i < stores.size(); ++i)
+    {
+        for (const NodeID o : oracle.getPts(getPointer(stores[i])))
+            objToStores[o].set(i);
+    }
+
+    const bool lockedEdges = Options::FSMPTALockedEdges();
+    std::vector<std::vector<std::pair<u32_t, NodeBS>>> interferences(accesses.size());
+    std::atomic<u32_t> next(0);
+    auto work = [&]()
+    {
+        for (u32_t i = next++; i < accesses.size(); i = next++)
+        {
+            const StmtSVFGNode* dst = accesses[i];
+            const PointsTo& dstPts = oracle.getPts(getPointer(dst));
+            NodeBS candidates;
+            for (const NodeID o : dstPts)
+            {
+                Map<NodeID, NodeBS>::const_iterator it = objToStores.find(o);
+                if (it != objToStores.end())
+                    candidates |= it->second;
+            }
+
+            for (const u32_t s : candidates)
+            {
+                const StoreSVFGNode* src = stores[s];
+                if (src == dst)
+                    continue;
+                if (!mhp->mayHappenInParallelInst(src->getICFGNode(), dst->getICFGNode()))
+                    continue;
+                if (!lockedEdges && lsa->isProtectedByCommonLockNoStat(src->getICFGNode(), dst->getICFGNode()))
+                    continue;
+
+                NodeBS cpts;
+                const PointsTo& srcPts = oracle.getPts(getPointer(src));
+                for (const NodeID o : dstPts)
+                {
+                    if (srcPts.test(o))
+                        cpts.set(o);
+                }
+                interferences[i].push_back(std::make_pair(s, cpts));
+            }
+        }
+    };
+    const u32_t numThreads = std::max<u32_t>(Options::FSMPTAThreads(), 1);
+    std::vector<std::thread> threads;
+    for (u32_t t = 1; t < numThreads; ++t)
+        threads.push_back(std::thread(work));
+    work();
+    for (std::thread& t : threads)
+        t.join();
+
+    for (u32_t i = 0; i < accesses.size(); ++i)
+    {
+        for (const std::pair<u32_t, NodeBS>& interference : interferences[i])
+        {
+            if (svfg->addThreadMHPIndirectVFEdge(stores[interference.first]->getId(), accesses[i]->getId(), interference.second))
+                numOfInterferenceEdges++;
+        }
+    }
+
+    DBOUT(DGENERAL, outs() << pasMsg("Added " + std::to_string(numOfInterferenceEdges) + " thread interference edges\n"));
+}
+
+/*!
+ * Same as FlowSensitive::initialize except that the SVFG has thread interference edges
+ */
+void FSMPTA::initialize()
+{
+    PointerAnalysis::initialize();
+
+    stat = new FlowSensitiveStat(this);
+
+    assert(!Options::ClusterFs() && !Options::PlainMappingFs() && "FSMPTA::initialize: points-to set mappings unsupported.");
+    ander = AndersenWaveDiff::createAndersenWaveDiff(getPAG());
+
+    svfg = mtaSVFGBuilder.buildPTROnlySVFG(ander);
+
+    setGraph(svfg);
+}
@@ -32,6 +32,9 @@
 #include "MTA/MTA.h"
 #include "Util/SVFUtil.h"
 #include "Util/PTAStat.h"
+#include "MemoryModel/PointerAnalysisImpl.h"
+#include <atomic>
+#include <thread>
 
 
 using namespace SVF;
@@ -43,6 +46,7 @@ void LockAnalysis::analyze()
 
     collectLockUnlocksites();
     buildCandidateFuncSetforLock();
+    buildLockAliasIndex();
 
     DOTIMESTAT(double lockStart = PTAStat::getClk(true));
 
@@ -58,6 +62,8 @@ void LockAnalysis::analyze()
     DBOUT(DMTA, outs() << "\tInter-procedural LockAnalysis\n");
     analyzeLockSpanCxtStmt();
 
+    buildLockSetIndex();
+
     DOTIMESTAT(double lockEnd = PTAStat::getClk(true));
     DOTIMESTAT(lockTime += (lockEnd - lockStart) / TIMEINTERVAL);
 }
@@ -138,32 +144,131 @@ void LockAnalysis::buildCandidateFuncSetforLock()
     }
 }
 
+/*!
+ * Number lock/unlock sites, and record for each site the sites whose lock values may alias its own.
+ * With a BVDataPTAImpl, sites are bucketed by the objects of their (field-insensitively
+ * expanded) points-to sets instead of querying alias for every pair of sites.
+ */
+void LockAnalysis::buildLockAliasIndex()
+{
+    std::vector<const ICFGNode*> sites(locksites.begin(), locksites.end());
+    sites.insert(sites.end(), unlocksites.begin(), unlocksites.end());
+    for (u32_t i = 0; i < sites.size(); ++i)
+        lockSiteToIdx[sites[i]] = i;
+    aliasedLockSites.assign(sites.size(), NodeBS());
+
+    PointerAnalysis* pta = tct->getPTA();
+    if (BVDataPTAImpl* bvPta = SVFUtil::dyn_cast<BVDataPTAImpl>(pta))
+    {
+        std::vector<PointsTo> sitePts(sites.size());
+        Map<NodeID, NodeBS> objToSites;
+        NodeBS blackHoleSites;
+        NodeBS allSites;
+        for (u32_t i = 0; i < sites.size(); ++i)
+        {
+            bvPta->expandFIObjs(bvPta->getPts(getLockVal(sites[i])->getId()), sitePts[i]);
+            if (bvPta->containBlackHoleNode(sitePts[i]))
+                blackHoleSites.set(i);
+            for (const NodeID o : sitePts[i])
+                objToSites[o].set(i);
+            allSites.set(i);
+        }
+        /// same as BVDataPTAImpl::alias
+        for (u32_t i = 0; i < sites.size(); ++i)
+        {
+            if (blackHoleSites.test(i))
+            {
+                aliasedLockSites[i] = allSites;
+                continue;
+            }
+            aliasedLockSites[i] = blackHoleSites;
+            for (const NodeID o : sitePts[i])
+                aliasedLockSites[i] |= objToSites[o];
+        }
+    }
+    else
+    {
+        for (u32_t i = 0; i < sites.size(); ++i)
+        {
+            for (u32_t j = i; j < sites.size(); ++j)
+            {
+                if (pta->alias(getLockVal(sites[i])->getId(), getLockVal(sites[j])->getId()))
+                {
+                    aliasedLockSites[i].set(j);
+                    aliasedLockSites[j].set(i);
+                }
+            }
+        }
+    }
+}
+
 /*!
  * Analyze intraprocedural locks
  * A lock is intraprocedural if its lock span is within a procedural
+ *
+ * The traversals of different functions are independent (locks are aliased through
+ * aliasedLockSites only), so functions are analyzed on Options::LockThreads() threads
+ * and their spans are added afterwards.
  */
 void LockAnalysis::analyzeIntraProcedualLock()
 {
-
-    // Identify the protected Instructions.
-    for (InstSet::const_iterator it = locksites.begin(), ie = locksites.end(); it != ie; ++it)
+    struct IntraLockResult
     {
-        const ICFGNode* lockSite = *it;
-        assert(isCallSite(lockSite) && "Lock acquire instruction must be a CallSite");
-
-        // Perform forward traversal
+        bool forward;
+        bool backward;
         InstSet forwardInsts;
-        InstSet backwardInsts;
-        InstSet unlockSet;
+    };
 
-        bool forward = intraForwardTraverse(lockSite,unlockSet,forwardInsts);
-        bool backward =	intraBackwardTraverse(unlockSet,backwardInsts);
+    Map<const FunObjVar*, InstVec> funToLockSites;
+    for (InstSet::const_iterator it = locksites.begin(), ie = locksites.end(); it != ie; ++it)
+    {
+        assert(isCallSite(*it) && "Lock acquire instruction must be a CallSite");
+        funToLockSites[(*it)->getFun()].push_back(*it);
+    }
+    std::vector<const InstVec*> funLockSites;
+    for (const auto& item : funToLockSites)
+        funLockSites.push_back(&item.second);
 
-        /// FIXME:Should we intersect forwardInsts and backwardInsts?
-        if(forward && backward)
-            addIntraLock(lockSite,forwardInsts);
-        else if(forward && !backward)
-            addCondIntraLock(lockSite,forwardInsts);
+    std::vector<std::vector<IntraLockResult>> results(funLockSites.size());
+    std::atomic<u32_t> next(0);
+    auto work = [&]()
+    {
+        for (u32_t i = next++; i < funLockSites.size(); i = next++)
+        {
+            // Identify the protected Instructions.
+            for (const ICFGNode* lockSite : *funLockSites[i])
+            {
+                // Perform forward traversal
+                IntraLockResult result;
+                InstSet backwardInsts;
+                InstSet unlockSet;
+
+                result.forward = intraForwardTraverse(lockSite,unlockSet,result.forwardInsts);
+                result.backward = intraBackwardTraverse(unlockSet,backwardInsts);
+                results[i].push_back(std::move(result));
+            }
+        }
+    };
+    const u32_t numThreads = std::max<u32_t>(Options::LockThreads(), 1);
+    std::vector<std::thread> threads;
+    for (u32_t t = 1; t < numThreads; ++t)
+        threads.push_back(std::thread(work));
+    work();
+    for (std::thread& t : threads)
+        t.join();
+
+    for (u32_t i = 0; i < funLockSites.size(); ++i)
+    {
+        for (u32_t j = 0; j < results[i].size(); ++j)
+        {
+            const ICFGNode* lockSite = (*funLockSites[i])[j];
+            const IntraLockResult& result = results[i][j];
+            /// FIXME:Should we intersect forwardInsts and backwardInsts?
+            if(result.forward && result.backward)
+                addIntraLock(lockSite,result.forwardInsts);
+            else if(result.forward && !result.backward)
+                addCondIntraLock(lockSite,result.forwardInsts);
+        }
     }
 }
 
@@ -390,6 +495,44 @@ void LockAnalysis::analyzeLockSpanCxtStmt()
 }
 
 
+/*!
+ * Build the lock-site bitsets of every instruction inside an intra-procedural lock or
+ * a context-sensitive lock span. Contexts of an instruction holding the same lock
+ * sites are merged, as whether two locks alias only depends on their sites.
+ */
+void LockAnalysis::buildLockSetIndex()
+{
+    for (const auto& item : instCILocksMap)
+    {
+        LockSiteSet& lss = instToCILockSites[item.first];
+        for (const ICFGNode* lockSite : item.second)
+            addLockSite(lss, lockSite);
+    }
+
+    for (const auto& item : instToCxtStmtSet)
+    {
+        std::vector<LockSiteSet> lssVec;
+        Set<NodeBS> visited;
+        bool complete = true;
+        for (const CxtStmt& cts : item.second)
+        {
+            if (!hasCxtLockfromCxtStmt(cts))
+            {
+                complete = false;
+                break;
+            }
+            LockSiteSet lss;
+            for (const CxtLock& cl : getCxtLockfromCxtStmt(cts))
+                addLockSite(lss, cl.getStmt());
+            if (visited.insert(lss.lockSites).second)
+                lssVec.push_back(std::move(lss));
+        }
+        /// statements without lock sets are handled by the slow path
+        if (complete)
+            instToCxtLockSites[item.first] = std::move(lssVec);
+    }
+}
+
 /*!
  * Print context-insensitive and context-sensitive locks
  */
@@ -565,17 +708,21 @@ bool LockAnalysis::matchCxt(CallStrCxt& cxt, const CallICFGNode* call, const Fun
 bool LockAnalysis::isProtectedByCommonLock(const ICFGNode *i1, const ICFGNode *i2)
 {
     numOfTotalQueries++;
-    bool commonlock = false;
     DOTIMESTAT(double queryStart = PTAStat::getClk(true));
-    if (isInsideIntraLock(i1) && isInsideIntraLock(i2))
-        commonlock = isProtectedByCommonCILock(i1,i2) ;
-    else
-        commonlock = isProtectedByCommonCxtLock(i1,i2);
+    bool commonlock = isProtectedByCommonLockNoStat(i1, i2);
     DOTIMESTAT(double queryEnd = PTAStat::getClk(true));
     DOTIMESTAT(lockQueriesTime += (queryEnd - queryStart) / TIMEINTERVAL);
     return commonlock;
 }
 
+bool LockAnalysis::isProtectedByCommonLockNoStat(const ICFGNode *i1, const ICFGNode *i2)
+{
+    if (isInsideIntraLock(i1) && isInsideIntraLock(i2))
+        return isProtectedByCommonCILock(i1,i2);
+    else
+        return isProtectedByCommonCxtLock(i1,i2);
+}
+
 /*!
  * Protected by at least one common context-insensitive lock
  */
@@ -584,16 +731,10 @@ bool LockAnalysis::isProtectedByCommonCILock(const ICFGNode *i1, const ICFGNode
 
     if(!isInsideCondIntraLock(i1) && !isInsideCondIntraLock(i2))
     {
-        const InstSet& lockset1 = getIntraLockSet(i1);
-        const InstSet& lockset2 = getIntraLockSet(i2);
-        for (InstSet::const_iterator cil1 = lockset1.begin(), ecil1 = lockset1.end(); cil1!=ecil1; ++cil1)
-        {
-            for (InstSet::const_iterator cil2=lockset2.begin(), ecil2=lockset2.end(); cil2!=ecil2; ++cil2)
-            {
-                if (isAliasedLocks(*cil1, *cil2))
-                    return true;
-            }
-        }
+        auto it1 = instToCILockSites.find(i1);
+        auto it2 = instToCILockSites.find(i2);
+        assert(it1 != instToCILockSites.end() && it2 != instToCILockSites.end() && "intralock not found!");
+        return hasAliasedLocks(it1->second, it2->second);
     }
     return false;
 }
@@ -617,6 +758,24 @@ bool LockAnalysis::isProtectedByCommonCxtLock(const ICFGNode *i1, const ICFGNode
 {
     if(!hasCxtStmtfromInst(i1) || !hasCxtStmtfromInst(i2))
         return false;
+
+    /// Fast path: the context-sensitive statements of two different instructions
+    /// are always different, so every pair of their distinct lock sets is checked
+    auto it1 = instToCxtLockSites.find(i1);
+    auto it2 = instToCxtLockSites.find(i2);
+    if (i1 != i2 && it1 != instToCxtLockSites.end() && it2 != instToCxtLockSites.end())
+    {
+        for (const LockSiteSet& lss1 : it1->second)
+        {
+            for (const LockSiteSet& lss2 : it2->second)
+            {
+                if (!hasAliasedLocks(lss1, lss2))
+                    return false;
+            }
+        }
+        return true;
+    }
+
     const CxtStmtSet& ctsset1 = getCxtStmtfromInst(i1);
     const CxtStmtSet& ctsset2 = getCxtStmtfromInst(i2);
     for (CxtStmtSet::const_iterator cts1 = ctsset1.begin(), ects1 = ctsset1.end(); cts1 != ects1; cts1++)
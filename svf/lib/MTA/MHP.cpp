@@ -33,6 +33,8 @@
 #include "MTA/LockAnalysis.h"
 #include "Util/SVFUtil.h"
 #include "Util/PTAStat.h"
+#include <atomic>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -41,19 +43,28 @@ using namespace SVFUtil;
 /*!
  * Constructor
  */
-MHP::MHP(TCT* t) : tcg(t->getThreadCallGraph()), tct(t), numOfTotalQueries(0), numOfMHPQueries(0),
+MHP::MHP(TCT* t) : tcg(t->getThreadCallGraph()), tct(t), ownFJA(true), numOfTotalQueries(0), numOfMHPQueries(0),
     interleavingTime(0), interleavingQueriesTime(0)
 {
     fja = new ForkJoinAnalysis(tct);
     fja->analyzeForkJoinPair();
 }
 
+/*!
+ * Constructor of a worker of the parallel interleaving analysis
+ */
+MHP::MHP(const MHP* master) : tcg(master->tcg), tct(master->tct), fja(master->fja), ownFJA(false),
+    numOfTotalQueries(0), numOfMHPQueries(0), interleavingTime(0), interleavingQueriesTime(0)
+{
+}
+
 /*!
  * Destructor
  */
 MHP::~MHP()
 {
-    delete fja;
+    if (ownFJA)
+        delete fja;
 }
 
 /*!
@@ -74,68 +85,118 @@ void MHP::analyze()
  */
 void MHP::analyzeInterleaving()
 {
-    for (const std::pair<const NodeID, TCTNode*>& tpair : *tct)
+    if (Options::MHPThreads() > 1)
+        analyzeInterleavingInParallel();
+    else
     {
-        const CxtThread& ct = tpair.second->getCxtThread();
-        NodeID rootTid = tpair.first;
-        const FunObjVar* routine = tct->getStartRoutineOfCxtThread(ct);
-        const ICFGNode* svfInst = routine->getEntryBlock()->front();
-        CxtThreadStmt rootcts(rootTid, ct.getContext(), svfInst);
+        for (const std::pair<const NodeID, TCTNode*>& tpair : *tct)
+            analyzeRootInterleaving(tpair.first);
+    }
+
+    /// update non-candidate functions' interleaving
+    updateNonCandidateFunInterleaving();
+
+    if (Options::PrintInterLev())
+        printInterleaving();
+}
+
+/*!
+ * Analyze the interleavings seeded by thread rootTid, i.e., propagate rootTid
+ * from the entry of its start routine, its ancestors' fork sites and its siblings
+ */
+void MHP::analyzeRootInterleaving(NodeID rootTid)
+{
+    const CxtThread& ct = tct->getTCTNode(rootTid)->getCxtThread();
+    const FunObjVar* routine = tct->getStartRoutineOfCxtThread(ct);
+    const ICFGNode* svfInst = routine->getEntryBlock()->front();
+    CxtThreadStmt rootcts(rootTid, ct.getContext(), svfInst);
 
-        addInterleavingThread(rootcts, rootTid);
-        updateAncestorThreads(rootTid);
-        updateSiblingThreads(rootTid);
+    addInterleavingThread(rootcts, rootTid);
+    updateAncestorThreads(rootTid);
+    updateSiblingThreads(rootTid);
 
-        while (!cxtStmtList.empty())
+    while (!cxtStmtList.empty())
+    {
+        CxtThreadStmt cts = popFromCTSWorkList();
+        const ICFGNode* curInst = cts.getStmt();
+        DBOUT(DMTA, outs() << "-----\nMHP analysis root thread: " << rootTid << " ");
+        DBOUT(DMTA, cts.dump());
+        DBOUT(DMTA, outs() << "current thread interleaving: < ");
+        DBOUT(DMTA, dumpSet(getInterleavingThreads(cts)));
+        DBOUT(DMTA, outs() << " >\n-----\n");
+
+        /// handle non-candidate function
+        if (!tct->isCandidateFun(curInst->getFun()))
         {
-            CxtThreadStmt cts = popFromCTSWorkList();
-            const ICFGNode* curInst = cts.getStmt();
-            DBOUT(DMTA, outs() << "-----\nMHP analysis root thread: " << rootTid << " ");
-            DBOUT(DMTA, cts.dump());
-            DBOUT(DMTA, outs() << "current thread interleaving: < ");
-            DBOUT(DMTA, dumpSet(getInterleavingThreads(cts)));
-            DBOUT(DMTA, outs() << " >\n-----\n");
-
-            /// handle non-candidate function
-            if (!tct->isCandidateFun(curInst->getFun()))
+            handleNonCandidateFun(cts);
+        }
+        /// handle candidate function
+        else
+        {
+            if (isTDFork(curInst))
             {
-                handleNonCandidateFun(cts);
+                handleFork(cts, rootTid);
             }
-            /// handle candidate function
-            else
+            else if (isTDJoin(curInst))
             {
-                if (isTDFork(curInst))
-                {
-                    handleFork(cts, rootTid);
-                }
-                else if (isTDJoin(curInst))
-                {
-                    handleJoin(cts, rootTid);
-                }
-                else if (tct->isCallSite(curInst) && !tct->isExtCall(curInst))
-                {
-                    handleCall(cts, rootTid);
-                    CallGraph::FunctionSet callees;
-                    if (!tct->isCandidateFun(getCallee(SVFUtil::cast<CallICFGNode>(curInst), callees)))
-                        handleIntra(cts);
-                }
-                else if (isRetInstNode(curInst))
-                {
-                    handleRet(cts);
-                }
-                else
-                {
+                handleJoin(cts, rootTid);
+            }
+            else if (tct->isCallSite(curInst) && !tct->isExtCall(curInst))
+            {
+                handleCall(cts, rootTid);
+                CallGraph::FunctionSet callees;
+                if (!tct->isCandidateFun(getCallee(SVFUtil::cast<CallICFGNode>(curInst), callees)))
                     handleIntra(cts);
-                }
+            }
+            else if (isRetInstNode(curInst))
+            {
+                handleRet(cts);
+            }
+            else
+            {
+                handleIntra(cts);
             }
         }
     }
+}
 
-    /// update non-candidate functions' interleaving
-    updateNonCandidateFunInterleaving();
+/*!
+ * Every transfer function (fork, call, return, intra) unions interleavings and
+ * a join removes joined threads bit by bit, so the interleaving bit of a thread
+ * only depends on the propagation seeded by that thread. Each worker hence runs
+ * the sequential worklist algorithm over its share of the thread roots, and the
+ * interleavings of a statement are the union of those of the workers.
+ */
+void MHP::analyzeInterleavingInParallel()
+{
+    std::vector<NodeID> roots;
+    for (const std::pair<const NodeID, TCTNode*>& tpair : *tct)
+        roots.push_back(tpair.first);
 
-    if (Options::PrintInterLev())
-        printInterleaving();
+    const u32_t numThreads = Options::MHPThreads();
+    std::vector<std::unique_ptr<MHP>> workers;
+    for (u32_t t = 0; t < numThreads; ++t)
+        workers.push_back(std::unique_ptr<MHP>(new MHP(this)));
+
+    std::atomic<u32_t> next(0);
+    auto work = [&](MHP* worker)
+    {
+        for (u32_t i = next++; i < roots.size(); i = next++)
+            worker->analyzeRootInterleaving(roots[i]);
+    };
+    std::vector<std::thread> threads;
+    for (u32_t t = 0; t < numThreads; ++t)
+        threads.push_back(std::thread(work, workers[t].get()));
+    for (std::thread& t : threads)
+        t.join();
+
+    for (const std::unique_ptr<MHP>& worker : workers)
+    {
+        for (const auto& item : worker->threadStmtToTheadInterLeav)
+            threadStmtToTheadInterLeav[item.first] |= item.second;
+        for (const auto& item : worker->instToTSMap)
+            instToTSMap[item.first].insert(item.second.begin(), item.second.end());
+    }
 }
 
 /*!
@@ -422,7 +483,7 @@ void MHP::updateSiblingThreads(NodeID curTid)
     tds.set(curTid);
     for (const unsigned tid : tds)
     {
-        NodeBS siblingTds = tct->getSiblingThread(tid);
+        const NodeBS& siblingTds = tct->getSiblingThread(tid);
         for (const unsigned stid : siblingTds)
         {
             if ((isHBPair(tid, stid) && isRecurFullJoin(tid, curTid)) || isHBPair(stid, tid))
@@ -448,6 +509,8 @@ bool MHP::isRecurFullJoin(NodeID parentTid, NodeID curTid)
 {
     if (parentTid == curTid)
         return true;
+    if (fja->hasRecurFullJoin(curTid))
+        return fja->isRecurFullJoin(parentTid, curTid);
 
     const TCTNode* curNode = tct->getTCTNode(curTid);
     FIFOWorkList<const TCTNode*> worklist;
@@ -565,10 +628,10 @@ bool MHP::mayHappenInParallelInst(const ICFGNode* i1, const ICFGNode* i2)
     const CxtThreadStmtSet& tsSet2 = getThreadStmtSet(i2);
     for (const CxtThreadStmt& ts1 : tsSet1)
     {
-        NodeBS l1 = getInterleavingThreads(ts1);
+        const NodeBS& l1 = getInterleavingThreads(ts1);
         for (const CxtThreadStmt& ts2 : tsSet2)
         {
-            NodeBS l2 = getInterleavingThreads(ts2);
+            const NodeBS& l2 = getInterleavingThreads(ts2);
             if (ts1.getTid() != ts2.getTid())
             {
                 if (l1.test(ts2.getTid()) && l2.test(ts1.getTid()))
@@ -642,6 +705,96 @@ bool MHP::executedByTheSameThread(const ICFGNode* i1, const ICFGNode* i2)
     return true;
 }
 
+/*!
+ * Collect the thread pairs <t,u> of an instruction where u is in the
+ * interleaving of a thread statement of t. Thread statements of the same
+ * thread but different contexts contribute to the same pairs.
+ */
+void MHP::collectInstThreadPairs(const ICFGNode* inst, InstThreadPairs& tp)
+{
+    /// Same as mayHappenInParallelInst, an instruction without thread statements has no MHP pairs
+    if (!hasThreadStmtSet(inst))
+        return;
+
+    const u32_t n = tct->getTCTNodeNum();
+    for (const CxtThreadStmt& ts : getThreadStmtSet(inst))
+    {
+        NodeID t = ts.getTid();
+        if (isMultiForkedThread(t))
+            tp.multiForkedTids.set(t);
+        for (const unsigned u : getInterleavingThreads(ts))
+        {
+            if (u == t)
+                continue;
+            tp.pairs.set(t * n + u);
+            tp.revPairs.set(u * n + t);
+        }
+    }
+}
+
+/*!
+ * i1 and i2 may happen in parallel (see mayHappenInParallelInst) if
+ * (1) a thread pair <t1,t2> of i1 is also a pair <t2,t1> of i2, i.e., pairs of i1 intersects revPairs of i2
+ * (2) both are executed by the same multiforked thread
+ * so that each pair of instructions costs two bitset intersections
+ * once the thread pairs of every instruction are collected.
+ * Instruction pairs are distributed to Options::MHPThreads() threads by rows.
+ */
+u32_t MHP::countMHPPairs(const InstSet& instSet1, const InstSet& instSet2)
+{
+    DOTIMESTAT(double queryStart = PTAStat::getClk(true));
+
+    assert(tct->getTCTNodeNum() <= std::numeric_limits<u16_t>::max() && "too many threads for thread pair bitsets");
+
+    Map<const ICFGNode*, InstThreadPairs> instToPairs;
+    for (const ICFGNode* inst : instSet1)
+        collectInstThreadPairs(inst, instToPairs[inst]);
+    for (const ICFGNode* inst : instSet2)
+    {
+        if (instToPairs.find(inst) == instToPairs.end())
+            collectInstThreadPairs(inst, instToPairs[inst]);
+    }
+
+    std::vector<const InstThreadPairs*> rows;
+    std::vector<const InstThreadPairs*> cols;
+    for (const ICFGNode* inst : instSet1)
+        rows.push_back(&instToPairs[inst]);
+    for (const ICFGNode* inst : instSet2)
+        cols.push_back(&instToPairs[inst]);
+
+    std::atomic<u32_t> next(0);
+    std::atomic<u32_t> mhpPairNum(0);
+    auto work = [&]()
+    {
+        u32_t localNum = 0;
+        for (u32_t i = next++; i < rows.size(); i = next++)
+        {
+            const InstThreadPairs* tp1 = rows[i];
+            for (const InstThreadPairs* tp2 : cols)
+            {
+                if (tp1->pairs.intersects(tp2->revPairs) || tp1->multiForkedTids.intersects(tp2->multiForkedTids))
+                    localNum++;
+            }
+        }
+        mhpPairNum += localNum;
+    };
+    const u32_t numThreads = std::max<u32_t>(Options::MHPThreads(), 1);
+    std::vector<std::thread> threads;
+    for (u32_t t = 1; t < numThreads; ++t)
+        threads.push_back(std::thread(work));
+    work();
+    for (std::thread& t : threads)
+        t.join();
+
+    numOfTotalQueries += rows.size() * cols.size();
+    numOfMHPQueries += mhpPairNum;
+
+    DOTIMESTAT(double queryEnd = PTAStat::getClk(true));
+    DOTIMESTAT(interleavingQueriesTime += (queryEnd - queryStart) / TIMEINTERVAL);
+
+    return mhpPairNum;
+}
+
 /*!
  * Print interleaving results
  */
@@ -780,6 +933,80 @@ void ForkJoinAnalysis::analyzeForkJoinPair()
             }
         }
     }
+
+    collectJoinClosures();
+}
+
+/*!
+ * Collect the rows of recurFullJoinMatrix and fullJoinClosure by OR-ing the
+ * rows of parent or child threads instead of walking the TCT per query.
+ * (1) t1 fully joins t recursively iff t1 == t or the parent p of t fully
+ *     joins t and t1 fully joins p recursively. Threads with more than one
+ *     parent, and threads below them, have no row and are walked by MHP.
+ * (2) the full join closure of t is the union of {c} and the closure of c
+ *     for every child c fully joined by t. A child created after t has a
+ *     larger id, so rows are collected in descending order of thread id;
+ *     a thread with a full join edge to an older thread is walked.
+ */
+void ForkJoinAnalysis::collectJoinClosures()
+{
+    const u32_t threadNum = tct->getTCTNodeNum();
+
+    recurFullJoinMatrix.assign(threadNum, BitVector());
+    for (NodeID tid = 0; tid < threadNum; ++tid)
+    {
+        const TCTNode* node = tct->getTCTNode(tid);
+        if (node->getInEdges().size() > 1)
+            continue;
+        recurFullJoinMatrix[tid].set(tid);
+        if (node->getInEdges().size() == 1)
+        {
+            NodeID parentTid = tct->getParentThread(tid);
+            if (isFullJoin(parentTid, tid))
+            {
+                if (!hasRecurFullJoin(parentTid))
+                    continue;
+                recurFullJoinMatrix[tid] |= recurFullJoinMatrix[parentTid];
+            }
+        }
+        hasRecurFullJoinRow.set(tid);
+    }
+
+    fullJoinClosure.assign(threadNum, NodeBS());
+    for (NodeID tid = threadNum; tid-- > 0;)
+    {
+        NodeBS& closure = fullJoinClosure[tid];
+        bool ordered = true;
+        for (const TCTEdge* edge : tct->getTCTNode(tid)->getOutEdges())
+        {
+            NodeID childTid = edge->getDstID();
+            if (!isFullJoin(tid, childTid))
+                continue;
+            if (childTid <= tid)
+            {
+                ordered = false;
+                break;
+            }
+            closure.set(childTid);
+            closure |= fullJoinClosure[childTid];
+        }
+        if (ordered)
+            continue;
+
+        closure.clear();
+        FIFOWorkList<NodeID> worklist;
+        worklist.push(tid);
+        while (!worklist.empty())
+        {
+            NodeID curTid = worklist.pop();
+            for (const TCTEdge* edge : tct->getTCTNode(curTid)->getOutEdges())
+            {
+                NodeID childTid = edge->getDstID();
+                if (isFullJoin(curTid, childTid) && closure.test_and_set(childTid))
+                    worklist.push(childTid);
+            }
+        }
+    }
 }
 
 /// Handle fork
@@ -975,33 +1202,15 @@ void ForkJoinAnalysis::handleIntra(const CxtStmt& cts)
 NodeBS ForkJoinAnalysis::getDirAndIndJoinedTid(const CxtStmt& cs)
 {
 
+    std::lock_guard<std::mutex> lock(joinedTidMutex);
     CxtStmtToTIDMap::const_iterator it = dirAndIndJoinMap.find(cs);
     if (it != dirAndIndJoinMap.end())
         return it->second;
 
     const NodeBS& directJoinTids = getDirectlyJoinedTid(cs);
     NodeBS allJoinTids = directJoinTids;
-
-    FIFOWorkList<NodeID> worklist;
     for (unsigned id : directJoinTids)
-    {
-        worklist.push(id);
-    }
-
-    while (!worklist.empty())
-    {
-        NodeID tid = worklist.pop();
-        TCTNode* node = tct->getTCTNode(tid);
-        for (TCT::ThreadCreateEdgeSet::const_iterator it = tct->getChildrenBegin(node), eit = tct->getChildrenEnd(node); it != eit; ++it)
-        {
-            NodeID childTid = (*it)->getDstID();
-            if (isFullJoin(tid, childTid))
-            {
-                allJoinTids.set(childTid);
-                worklist.push(childTid);
-            }
-        }
-    }
+        allJoinTids |= fullJoinClosure[id];
 
     dirAndIndJoinMap[cs] = allJoinTids;
 
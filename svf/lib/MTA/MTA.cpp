@@ -34,13 +34,17 @@
 #include "MTA/TCT.h"
 #include "MTA/LockAnalysis.h"
 #include "MTA/MTAStat.h"
+#include "MTA/FSMPTA.h"
 #include "WPA/Andersen.h"
+#include "MemoryModel/AliasOracle.h"
 #include "Util/SVFUtil.h"
+#include <atomic>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
 
-MTA::MTA() : tcg(nullptr), tct(nullptr), mhp(nullptr), lsa(nullptr)
+MTA::MTA() : pta(nullptr), tcg(nullptr), tct(nullptr), mhp(nullptr), lsa(nullptr)
 {
     stat = std::make_unique<MTAStat>();
 }
@@ -63,8 +67,18 @@ bool MTA::runOnModule(SVFIR* pag)
     mhp = computeMHP();
     lsa = computeLocksets(mhp->getTCT());
 
+    if (Options::FSMPTA())
+    {
+        fsmpta = std::make_unique<FSMPTA>(mhp, lsa);
+        fsmpta->analyze();
+    }
+
     if(Options::RaceCheck())
+    {
         detect();
+        if (!Options::RaceReport().empty())
+            report.dumpToJsonFile(Options::RaceReport());
+    }
 
     return false;
 }
@@ -85,8 +99,9 @@ MHP* MTA::computeMHP()
     DBOUT(DGENERAL, outs() << pasMsg("MTA analysis\n"));
     DBOUT(DMTA, outs() << pasMsg("MTA analysis\n"));
     SVFIR* pag = PAG::getPAG();
-    PointerAnalysis* pta = AndersenWaveDiff::createAndersenWaveDiff(pag);
-    pta->getCallGraph()->dump("ptacg");
+    pta = AndersenWaveDiff::createAndersenWaveDiff(pag);
+    if (Options::CallGraphDotGraph())
+        pta->getCallGraph()->dump("ptacg");
 
     DBOUT(DGENERAL, outs() << pasMsg("Build TCT\n"));
     DBOUT(DMTA, outs() << pasMsg("Build TCT\n"));
@@ -96,13 +111,14 @@ MHP* MTA::computeMHP()
     DOTIMESTAT(double tctEnd = stat->getClk());
     DOTIMESTAT(stat->TCTTime += (tctEnd - tctStart) / TIMEINTERVAL);
 
-    if (pta->printStat())
+    if (Options::PStat())
     {
         stat->performThreadCallGraphStat(tcg);
         stat->performTCTStat(tct.get());
     }
 
-    tcg->dump("tcg");
+    if (Options::CallGraphDotGraph())
+        tcg->dump("tcg");
 
     DBOUT(DGENERAL, outs() << pasMsg("MHP analysis\n"));
     DBOUT(DMTA, outs() << pasMsg("MHP analysis\n"));
@@ -124,16 +140,24 @@ MHP* MTA::computeMHP()
 // * 		 (3) read-read race (optional)
 // * when two memory access may-happen in parallel and are not protected by the same lock
 // * (excluding global constraints because they are initialized before running the main function)
+// *
+// * Instead of checking every load against every store, stores are bucketed by the
+// * (field-insensitively expanded) objects their pointers may point to, and a load
+// * is only paired with the stores in the buckets of its own objects, which are the
+// * stores it may alias. Stores whose pointers may point to the black hole object
+// * alias every load (and vice versa). The MHP and lock checks of the candidates of
+// * different loads are independent and run on Options::RaceThreads() threads.
+// * With -fsmpta the flow-sensitive points-to results replace Andersen's.
 // */
 void MTA::detect()
 {
 
     DBOUT(DGENERAL, outs() << pasMsg("Starting Race Detection\n"));
 
-    Set<const LoadStmt*> loads;
-    Set<const StoreStmt*> stores;
+    std::vector<const LoadStmt*> loads;
+    std::vector<const StoreStmt*> stores;
     SVFIR* pag = SVFIR::getPAG();
-    PointerAnalysis* pta = AndersenWaveDiff::createAndersenWaveDiff(pag);
+    assert(pta && "computeMHP() has not run!");
 
     // Add symbols for all of the functions and the instructions in them.
     for (const auto& item : *PAG::getPAG()->getCallGraph())
@@ -145,33 +169,89 @@ void MTA::detect()
             const SVFBasicBlock* svfbb = it.second;
             for (const ICFGNode* icfgNode : svfbb->getICFGNodeList())
             {
+                if (SVFUtil::isa<GlobalICFGNode>(icfgNode))
+                    continue;
                 for(const SVFStmt* stmt : pag->getSVFStmtList(icfgNode))
                 {
                     if (const LoadStmt* l = SVFUtil::dyn_cast<LoadStmt>(stmt))
                     {
-                        loads.insert(l);
+                        loads.push_back(l);
                     }
                     else if (const StoreStmt* s = SVFUtil::dyn_cast<StoreStmt>(stmt))
                     {
-                        stores.insert(s);
+                        stores.push_back(s);
                     }
                 }
             }
         }
     }
 
-    for (Set<const LoadStmt*>::const_iterator lit = loads.begin(), elit = loads.end(); lit != elit; ++lit)
+    /// The oracle also computes every points-to set up front,
+    /// so that the PTA is only read by the threads below
+    BVDataPTAImpl* racePTA = pta;
+    if (fsmpta)
+        racePTA = fsmpta.get();
+    AliasOracle oracle(racePTA);
+    Map<NodeID, NodeBS> objToStores;
+    NodeBS blackHoleStores;
+    NodeBS allStores;
+    for (u32_t i = 0; i < stores.size(); ++i)
+    {
+        const PointsTo& pts = oracle.getPts(stores[i]->getLHSVarID());
+        if (racePTA->containBlackHoleNode(pts))
+            blackHoleStores.set(i);
+        for (const NodeID o : pts)
+            objToStores[o].set(i);
+        allStores.set(i);
+    }
+
+    std::vector<std::vector<u32_t>> races(loads.size());
+    std::atomic<u32_t> next(0);
+    auto work = [&]()
+    {
+        for (u32_t i = next++; i < loads.size(); i = next++)
+        {
+            const LoadStmt* load = loads[i];
+            const PointsTo& pts = oracle.getPts(load->getRHSVarID());
+            NodeBS candidates;
+            if (racePTA->containBlackHoleNode(pts))
+                candidates = allStores;
+            else
+            {
+                candidates = blackHoleStores;
+                for (const NodeID o : pts)
+                {
+                    Map<NodeID, NodeBS>::const_iterator it = objToStores.find(o);
+                    if (it != objToStores.end())
+                        candidates |= it->second;
+                }
+            }
+
+            for (const u32_t s : candidates)
+            {
+                const StoreStmt* store = stores[s];
+                if(mhp->mayHappenInParallelInst(load->getICFGNode(),store->getICFGNode()))
+                    if(lsa->isProtectedByCommonLockNoStat(load->getICFGNode(),store->getICFGNode()) == false)
+                        races[i].push_back(s);
+            }
+        }
+    };
+    const u32_t numThreads = std::max<u32_t>(Options::RaceThreads(), 1);
+    std::vector<std::thread> threads;
+    for (u32_t t = 1; t < numThreads; ++t)
+        threads.push_back(std::thread(work));
+    work();
+    for (std::thread& t : threads)
+        t.join();
+
+    for (u32_t i = 0; i < loads.size(); ++i)
     {
-        const LoadStmt* load = *lit;
-        for (Set<const StoreStmt*>::const_iterator sit = stores.begin(), esit = stores.end(); sit != esit; ++sit)
+        for (const u32_t s : races[i])
         {
-            const StoreStmt* store = *sit;
-            if(SVFUtil::isa<GlobalICFGNode>(load->getICFGNode()) || SVFUtil::isa<GlobalICFGNode>(store->getICFGNode()))
-                continue;
-            if(mhp->mayHappenInParallelInst(load->getICFGNode(),store->getICFGNode()) && pta->alias(load->getRHSVarID(),store->getLHSVarID()))
-                if(lsa->isProtectedByCommonLock(load->getICFGNode(),store->getICFGNode()) == false)
-                    outs() << SVFUtil::bugMsg1("race pair(") << " store: " << store->toString() << ", load: " << load->toString() << SVFUtil::bugMsg1(")") << "\n";
+            GenericBug::EventStack eventStack;
+            eventStack.push_back(SVFBugEvent(SVFBugEvent::SourceInst, loads[i]->getICFGNode()));
+            eventStack.push_back(SVFBugEvent(SVFBugEvent::SourceInst, stores[s]->getICFGNode()));
+            report.addMTABug(GenericBug::DATARACE, eventStack);
         }
     }
 }
-
@@ -115,8 +115,8 @@ void MTAStat::performMHPPairStat(MHP* mhp, LockAnalysis* lsa)
     SVFIR* pag = SVFIR::getPAG();
     if(Options::AllPairMHP())
     {
-        Set<const ICFGNode*> instSet1;
-        Set<const ICFGNode*> instSet2;
+        MHP::InstSet instSet1;
+        MHP::InstSet instSet2;
 
         for (const auto& item : *PAG::getPAG()->getCallGraph())
         {
@@ -147,13 +147,7 @@ void MTAStat::performMHPPairStat(MHP* mhp, LockAnalysis* lsa)
         }
 
 
-        for(Set<const ICFGNode*>::const_iterator it1 = instSet1.begin(), eit1 = instSet1.end(); it1!=eit1; ++it1)
-        {
-            for(Set<const ICFGNode*>::const_iterator it2 = instSet2.begin(), eit2 = instSet2.end(); it2!=eit2; ++it2)
-            {
-                mhp->mayHappenInParallel(*it1,*it2);
-            }
-        }
+        mhp->countMHPPairs(instSet1, instSet2);
     }
 
 
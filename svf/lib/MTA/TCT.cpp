@@ -33,7 +33,11 @@
 #include "MTA/MTA.h"
 #include "Graphs/CallGraph.h"
 
+#include <fstream>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -239,6 +243,34 @@ void TCT::collectMultiForkedThreads()
 }
 
 
+/*!
+ * Collect the ancestors and siblings of all threads once the tree is built,
+ * so that MHP does not walk the tree for every thread statement.
+ * A thread with a single parent was created together with its only TCT edge,
+ * hence its parent has a smaller id and ancestors can be collected in order
+ * of thread id as ancestors(t) = ancestors(parent(t)) | {parent(t)}.
+ */
+void TCT::collectThreadRelations()
+{
+    ancestorRows.assign(TCTNodeNum, NodeBS());
+    siblingRows.assign(TCTNodeNum, NodeBS());
+    for (NodeID tid = 0; tid < TCTNodeNum; ++tid)
+    {
+        if (hasParentThread(tid) == false)
+            continue;
+        NodeID parent = getParentThread(tid);
+        assert(parent < tid && "a thread is created after its parent");
+        ancestorRows[tid] = ancestorRows[parent];
+        ancestorRows[tid].set(parent);
+
+        for (const TCTEdge* edge : getTCTNode(parent)->getOutEdges())
+        {
+            if (edge->getDstID() != tid)
+                siblingRows[tid].set(edge->getDstID());
+        }
+    }
+}
+
 /*!
  * Handle call relations
  */
@@ -393,16 +425,46 @@ void TCT::build()
     // start routine is empty
 
     collectEntryFunInCallGraph();
-    for (FunSet::iterator it=entryFuncSet.begin(), eit=entryFuncSet.end(); it!=eit; ++it)
+
+    if (Options::ReadTCT().empty() || !readFromFile(Options::ReadTCT()))
     {
-        if (!isCandidateFun(*it))
-            continue;
-        CallStrCxt cxt;
-        TCTNode* mainTCTNode = getOrCreateTCTNode(cxt, nullptr, cxt, *it);
-        CxtThreadProc t(mainTCTNode->getId(), cxt, *it);
-        pushToCTPWorkList(t);
+        for (FunSet::iterator it=entryFuncSet.begin(), eit=entryFuncSet.end(); it!=eit; ++it)
+        {
+            if (!isCandidateFun(*it))
+                continue;
+            CallStrCxt cxt;
+            TCTNode* mainTCTNode = getOrCreateTCTNode(cxt, nullptr, cxt, *it);
+            CxtThreadProc t(mainTCTNode->getId(), cxt, *it);
+            pushToCTPWorkList(t);
+        }
+
+        const u32_t threadNum = std::max<u32_t>(Options::TCTThreads(), 1);
+        if (threadNum > 1)
+            expandCTPsInParallel(threadNum);
+        else
+            expandCTPs();
     }
 
+    collectMultiForkedThreads();
+
+    collectThreadRelations();
+
+    if (!Options::WriteTCT().empty())
+        writeToFile(Options::WriteTCT());
+
+    if (Options::TCTDotGraph())
+    {
+        print();
+        dump("tct");
+    }
+
+}
+
+/*!
+ * Expand the calling contexts of the ctps in ctpList, forking new threads on the way
+ */
+void TCT::expandCTPs()
+{
     while(!ctpList.empty())
     {
         CxtThreadProc ctp = popFromCTPWorkList();
@@ -428,15 +490,297 @@ void TCT::build()
             }
         }
     }
+}
 
-    collectMultiForkedThreads();
+/*!
+ * Expand the threads wave by wave: the ctps of every thread of a wave are
+ * expanded by a worker on its own, and the forks found are merged in order of
+ * thread id, so the tree does not depend on the number of workers. A thread
+ * created by a merge is expanded in the next wave.
+ *
+ * TCT node ids follow this merge order. They are the same for any number of
+ * workers above one. They differ from the ids of expandCTPs, which numbers
+ * the threads in the order of its single worklist. The tree is the same
+ * either way, so ids should only be compared between runs with the same
+ * -tct-threads setting.
+ */
+void TCT::expandCTPsInParallel(u32_t threadNum)
+{
+    std::vector<CxtThreadProcSet> threadVisited(TCTNodeNum);
+    OrderedMap<NodeID, std::vector<CxtThreadProc>> wave;
+    while (!ctpList.empty())
+    {
+        CxtThreadProc ctp = popFromCTPWorkList();
+        threadVisited[ctp.getTid()].insert(ctp);
+        wave[ctp.getTid()].push_back(ctp);
+    }
 
-    if (Options::TCTDotGraph())
+    while (!wave.empty())
     {
-        print();
-        dump("tct");
+        std::vector<NodeID> tids;
+        std::vector<const std::vector<CxtThreadProc>*> seeds;
+        for (const auto& item : wave)
+        {
+            tids.push_back(item.first);
+            seeds.push_back(&item.second);
+        }
+        std::vector<std::vector<ForkEvent>> forks(tids.size());
+
+        std::atomic<u32_t> next(0);
+        auto work = [&]()
+        {
+            for (u32_t i = next++; i < tids.size(); i = next++)
+                expandThread(*seeds[i], threadVisited[tids[i]], forks[i]);
+        };
+        std::vector<std::thread> threads;
+        for (u32_t t = 1; t < threadNum && t < tids.size(); ++t)
+            threads.push_back(std::thread(work));
+        work();
+        for (std::thread& t : threads)
+            t.join();
+
+        OrderedMap<NodeID, std::vector<CxtThreadProc>> nextWave;
+        for (u32_t i = 0; i < tids.size(); ++i)
+        {
+            for (const ForkEvent& fork : forks[i])
+            {
+                TCTNode* spawneeNode = getOrCreateTCTNode(fork.cxt, fork.fork, fork.oldCxt, fork.routine);
+                if (spawneeNode->getId() >= threadVisited.size())
+                    threadVisited.resize(TCTNodeNum);
+                CxtThreadProc newctp(spawneeNode->getId(), fork.cxt, fork.routine);
+                if (threadVisited[spawneeNode->getId()].insert(newctp).second)
+                {
+                    addTCTEdge(getGNode(tids[i]), spawneeNode);
+                    nextWave[spawneeNode->getId()].push_back(newctp);
+                }
+            }
+        }
+        wave.swap(nextWave);
+    }
+
+    for (const CxtThreadProcSet& visited : threadVisited)
+        visitedCTPs.insert(visited.begin(), visited.end());
+}
+
+/*!
+ * Expand the ctps of one thread within its call graph, only the calling
+ * contexts and the forks are computed here, the tree is left untouched
+ */
+void TCT::expandThread(const std::vector<CxtThreadProc>& seeds, CxtThreadProcSet& visited, std::vector<ForkEvent>& forks)
+{
+    FIFOWorkList<CxtThreadProc> worklist;
+    for (const CxtThreadProc& ctp : seeds)
+        worklist.push(ctp);
+
+    auto handleCall = [&](const CxtThreadProc& ctp, const CallGraphEdge* cgEdge, const CallICFGNode* cs)
+    {
+        const FunObjVar* callee = cgEdge->getDstNode()->getFunction();
+        CallStrCxt cxt(ctp.getContext());
+        CallStrCxt oldCxt = cxt;
+        pushCxt(cxt, cs, callee);
+
+        if (cgEdge->getEdgeKind() == CallGraphEdge::CallRetEdge)
+        {
+            CxtThreadProc newctp(ctp.getTid(), cxt, callee);
+            if (visited.insert(newctp).second)
+                worklist.push(newctp);
+        }
+        else if (cgEdge->getEdgeKind() == CallGraphEdge::TDForkEdge)
+            forks.push_back({cxt, oldCxt, cs, callee});
+    };
+
+    while (!worklist.empty())
+    {
+        CxtThreadProc ctp = worklist.pop();
+        const CallGraphNode* cgNode = tcg->getCallGraphNode(ctp.getProc());
+        if (isCandidateFun(cgNode->getFunction()) == false)
+            continue;
+
+        for (const CallGraphEdge* cgEdge : cgNode->getOutEdges())
+        {
+            for (auto cit = cgEdge->directCallsBegin(), ecit = cgEdge->directCallsEnd(); cit != ecit; ++cit)
+                handleCall(ctp, cgEdge, *cit);
+            for (auto ind = cgEdge->indirectCallsBegin(), eind = cgEdge->indirectCallsEnd(); ind != eind; ++ind)
+                handleCall(ctp, cgEdge, *ind);
+        }
+    }
+}
+
+/*!
+ * Write the TCT as
+ *   <node number> <edge number>
+ *   <tid> <fork site ICFG node or -1> <start routine> <cxt size> <call sites> <fork cxt size> <call sites>
+ *   <src tid> <dst tid>
+ * the nodes are written in order of id
+ */
+void TCT::writeToFile(const std::string& filename) const
+{
+    outs() << "Storing the thread creation tree to '" << filename << "'...";
+
+    std::ofstream f(filename.c_str());
+    if (!f.good())
+    {
+        outs() << "  error opening file for writing!\n";
+        return;
+    }
+
+    f << TCTNodeNum << " " << TCTEdgeNum << "\n";
+    for (NodeID tid = 0; tid < TCTNodeNum; ++tid)
+    {
+        const CxtThread& ct = getTCTNode(tid)->getCxtThread();
+        if (ct.getThread() != nullptr)
+            f << tid << " " << ct.getThread()->getId();
+        else
+            f << tid << " -1";
+        f << " " << getStartRoutineOfCxtThread(ct)->getId();
+        for (const CallStrCxt* cxt : {&ct.getContext(), &getCxtOfCxtThread(ct)})
+        {
+            f << " " << cxt->size();
+            for (u32_t cs : *cxt)
+                f << " " << cs;
+        }
+        f << "\n";
+    }
+    for (NodeID tid = 0; tid < TCTNodeNum; ++tid)
+    {
+        for (const TCTEdge* edge : getTCTNode(tid)->getOutEdges())
+            f << edge->getSrcID() << " " << edge->getDstID() << "\n";
+    }
+
+    f.close();
+    outs() << "\n";
+}
+
+/*!
+ * Read a TCT written by writeToFile. The file is checked against the SVFIR
+ * and the thread call graph before any node is created, false is returned
+ * on the first record that does not fit, in which case the tree is built as
+ * usual. A record fits if
+ *   - its id is the next one,
+ *   - the main threads start an entry function with an empty context,
+ *   - any other thread is forked at a fork site with a fork edge to its
+ *     start routine, and its context is that of the fork site extended by
+ *     the fork as expandCTPs does,
+ *   - no two records are the same thread,
+ * and every thread but the main ones is forked by exactly one thread created
+ * before it.
+ */
+bool TCT::readFromFile(const std::string& filename)
+{
+    outs() << "Loading the thread creation tree from '" << filename << "'...";
+
+    std::ifstream F(filename.c_str());
+    if (!F.is_open())
+    {
+        outs() << "  error opening file for reading!\n";
+        return false;
     }
 
+    struct NodeRecord
+    {
+        const CallICFGNode* fork;
+        const FunObjVar* routine;
+        CallStrCxt cxt;
+        CallStrCxt forkCxt;
+    };
+    std::vector<NodeRecord> records;
+    std::vector<std::pair<NodeID, NodeID>> edges;
+
+    const SVFIR* pag = PAG::getPAG();
+    const ICFG* icfg = pag->getICFG();
+    auto readCxt = [&](std::istringstream& ss, CallStrCxt& cxt)
+    {
+        u32_t size = 0;
+        if (!(ss >> size))
+            return false;
+        for (u32_t i = 0; i < size; ++i)
+        {
+            CallSiteID cs;
+            if (!(ss >> cs) || cs == 0 || cs >= tcg->getTotalCallSiteNumber())
+                return false;
+            pushCxt(cxt, cs);
+        }
+        return true;
+    };
+    /// Whether the thread of record is forked at its fork site as the tree would fork it
+    auto isForkOf = [&](const NodeRecord& record)
+    {
+        if (!tcg->isForksite(record.fork) || !tcg->hasThreadForkEdge(record.fork))
+            return false;
+        bool hasEdge = false;
+        for (auto it = tcg->getForkEdgeBegin(record.fork), eit = tcg->getForkEdgeEnd(record.fork); it != eit; ++it)
+            hasEdge |= (*it)->getDstNode()->getFunction() == record.routine;
+        if (!hasEdge || !isCandidateFun(record.fork->getFun()))
+            return false;
+        CallStrCxt cxt = record.forkCxt;
+        pushCxt(cxt, record.fork, record.routine);
+        return cxt == record.cxt;
+    };
+
+    std::string line;
+    u32_t nodeNum = 0, edgeNum = 0;
+    bool valid = std::getline(F, line) && (std::istringstream(line) >> nodeNum >> edgeNum) && nodeNum > 0;
+    std::set<std::pair<u32_t, const ICFGNode*>> threads;
+    u32_t rootNum = 0;
+    for (NodeID tid = 0; valid && tid < nodeNum; ++tid)
+    {
+        NodeID id;
+        long long fork;
+        NodeID routine;
+        NodeRecord record;
+        std::istringstream ss;
+        valid = (bool) std::getline(F, line);
+        ss.str(line);
+        valid = valid && (ss >> id >> fork >> routine) && id == tid &&
+                (fork == -1 || (fork >= 0 && icfg->hasGNode(fork) && SVFUtil::isa<CallICFGNode>(icfg->getGNode(fork)))) &&
+                pag->hasGNode(routine) && SVFUtil::isa<FunObjVar>(pag->getGNode(routine)) &&
+                readCxt(ss, record.cxt) && readCxt(ss, record.forkCxt);
+        if (!valid)
+            break;
+        record.fork = fork == -1 ? nullptr : SVFUtil::cast<CallICFGNode>(icfg->getGNode(fork));
+        record.routine = SVFUtil::cast<FunObjVar>(pag->getGNode(routine));
+        if (record.fork == nullptr)
+        {
+            valid = record.cxt.empty() && record.forkCxt.empty() && isCandidateFun(record.routine) &&
+                    entryFuncSet.find(record.routine) != entryFuncSet.end();
+            rootNum++;
+        }
+        else
+            valid = isForkOf(record);
+        valid = valid && threads.insert(std::make_pair(record.cxt.getId(), record.fork)).second;
+        records.push_back(record);
+    }
+
+    /// Every forked thread has one parent, which has a smaller id
+    std::vector<u8_t> hasParent(nodeNum, 0);
+    valid = valid && edgeNum == nodeNum - rootNum;
+    for (u32_t i = 0; valid && i < edgeNum; ++i)
+    {
+        NodeID src, dst;
+        valid = std::getline(F, line) && (std::istringstream(line) >> src >> dst) && src < dst && dst < nodeNum &&
+                records[dst].fork != nullptr && !hasParent[dst];
+        if (valid)
+        {
+            hasParent[dst] = 1;
+            edges.push_back(std::make_pair(src, dst));
+        }
+    }
+    F.close();
+
+    if (!valid)
+    {
+        outs() << "  the file does not match the program, building the tree instead\n";
+        return false;
+    }
+
+    for (const NodeRecord& record : records)
+        getOrCreateTCTNode(record.cxt, record.fork, record.forkCxt, record.routine);
+    assert(TCTNodeNum == nodeNum && "duplicated threads in the file");
+    for (const std::pair<NodeID, NodeID>& edge : edges)
+        addTCTEdge(getGNode(edge.first), getGNode(edge.second));
+
+    outs() << "\n";
+    return true;
 }
 
 /*!
@@ -0,0 +1,95 @@
+//===- AliasOracle.cpp -- Alias queries over finished points-to results-------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * AliasOracle.cpp
+ *
+ */
+
+#include "MemoryModel/AliasOracle.h"
+
+using namespace SVF;
+
+AliasOracle::AliasOracle(BVDataPTAImpl* p)
+    : pta(p), ptCache(p->getPtCache()), indexBuilt(false), classNum(0), queryNum(0), pairCacheHitNum(0)
+{
+    Set<ClassID> classes;
+    SVFIR* pag = pta->getPAG();
+    for (SVFIR::iterator it = pag->begin(), eit = pag->end(); it != eit; ++it)
+    {
+        const PointsTo& pts = pta->getPts(it->first);
+        if (pts.empty())
+            continue;
+
+        PointsTo expandedPts;
+        pta->expandFIObjs(pts, expandedPts);
+        ClassID cls = ptCache.emplacePts(expandedPts);
+        ptrToClass[it->first] = cls;
+        if (classes.insert(cls).second && pta->containBlackHoleNode(expandedPts))
+            blackHoleClasses.insert(cls);
+    }
+    classNum = classes.size();
+}
+
+AliasResult AliasOracle::alias(NodeID p, NodeID q)
+{
+    queryNum++;
+    ClassID cp = getClass(p);
+    ClassID cq = getClass(q);
+
+    if (blackHoleClasses.count(cp) || blackHoleClasses.count(cq))
+        return AliasResult::MayAlias;
+
+    const ClassID empty = PersistentPointsToCache<PointsTo>::emptyPointsToId();
+    if (cp == empty || cq == empty)
+        return AliasResult::NoAlias;
+    if (cp == cq)
+        return AliasResult::MayAlias;
+
+    std::pair<ClassID, ClassID> key = cp < cq ? std::make_pair(cp, cq) : std::make_pair(cq, cp);
+    auto it = pairCache.find(key);
+    bool mayAlias;
+    if (it != pairCache.end())
+    {
+        pairCacheHitNum++;
+        mayAlias = it->second;
+    }
+    else
+    {
+        mayAlias = ptCache.getActualPts(cp).intersects(ptCache.getActualPts(cq));
+        pairCache.emplace(key, mayAlias);
+    }
+    return mayAlias ? AliasResult::MayAlias : AliasResult::NoAlias;
+}
+
+const NodeBS& AliasOracle::getPointersTo(NodeID obj)
+{
+    if (!indexBuilt)
+    {
+        for (const auto& it : ptrToClass)
+        {
+            for (NodeID o : ptCache.getActualPts(it.second))
+                objToPtrs[o].set(it.first);
+        }
+        indexBuilt = true;
+    }
+    return objToPtrs[obj];
+}
@@ -40,9 +40,9 @@
 using namespace SVF;
 using namespace SVFUtil;
 
-u64_t DPItem::maximumBudget = ULONG_MAX - 1;
+thread_local u64_t DPItem::maximumBudget = ULONG_MAX - 1;
 u32_t ContextCond::maximumCxtLen = 0;
-u32_t ContextCond::maximumCxt = 0;
+std::atomic<u32_t> ContextCond::maximumCxt{0};
 u32_t ContextCond::maximumPathLen = 0;
 u32_t ContextCond::maximumPath = 0;
 u32_t SaberCondAllocator::totalCondNum = 0;
@@ -50,7 +50,8 @@ u32_t SaberCondAllocator::totalCondNum = 0;
 
 SaberCondAllocator::SaberCondAllocator()
 {
-
+    if (Options::SaberCondBackend() == BDD_COND)
+        bddManager = std::make_unique<BDDManager>();
 }
 
 /*!
@@ -193,7 +194,7 @@ SaberCondAllocator::evaluateTestNullLikeExpr(const BranchStmt *branchStmt, const
     {
         // branch condition is a constant value, return nullexpr because it cannot be test null
         //  br i1 false, label %44, label %75, !dbg !7669 { "ln": 2033, "cl": 7, "fl": "re_lexer.c" }
-        return Condition::nullExpr();
+        return Condition();
     }
     if (isTestNullExpr(SVFUtil::cast<ICFGNode>(condVar->getICFGNode())))
     {
@@ -213,7 +214,7 @@ SaberCondAllocator::evaluateTestNullLikeExpr(const BranchStmt *branchStmt, const
         else
             return getFalseCond();
     }
-    return Condition::nullExpr();
+    return Condition();
 }
 
 /*!
@@ -254,7 +255,7 @@ SaberCondAllocator::Condition SaberCondAllocator::evaluateProgExit(const BranchS
     }
     /// no branch call program exit
     else
-        return Condition::nullExpr();
+        return Condition();
 
 }
 
@@ -291,7 +292,7 @@ SaberCondAllocator::Condition SaberCondAllocator::evaluateLoopExitBranch(const S
         if (allPDT)
             return getTrueCond();
     }
-    return Condition::nullExpr();
+    return Condition();
 }
 
 /*!
@@ -321,15 +322,15 @@ SaberCondAllocator::Condition SaberCondAllocator::evaluateBranchCond(const SVFBa
                     (void)is_succ; // Suppress warning of unused variable under release build
                     assert(is_succ && "not a successor??");
                     Condition evalLoopExit = evaluateLoopExitBranch(bb, succ);
-                    if (!eq(evalLoopExit, Condition::nullExpr()))
+                    if (!evalLoopExit.isNull())
                         return evalLoopExit;
 
                     Condition evalProgExit = evaluateProgExit(branchStmt, succ);
-                    if (!eq(evalProgExit, Condition::nullExpr()))
+                    if (!evalProgExit.isNull())
                         return evalProgExit;
 
                     Condition evalTestNullLike = evaluateTestNullLikeExpr(branchStmt, succ);
-                    if (!eq(evalTestNullLike, Condition::nullExpr()))
+                    if (!evalTestNullLike.isNull())
                         return evalTestNullLike;
                     break;
                 }
@@ -538,7 +539,7 @@ SaberCondAllocator::Condition SaberCondAllocator::ComputeIntraVFGGuard(const SVF
         /// if the dstBB is the eligible loop exit of the current basic block
         /// we can early terminate the computation
         Condition loopExitCond = evaluateLoopExitBranch(bb, dstBB);
-        if (!eq(loopExitCond, Condition::nullExpr()))
+        if (!loopExitCond.isNull())
             return condAnd(cond, loopExitCond);
 
         for (const SVFBasicBlock* succ : bb->getSuccessors())
@@ -602,8 +603,9 @@ void SaberCondAllocator::printPathCond()
 SaberCondAllocator::Condition SaberCondAllocator::newCond(const ICFGNode* inst)
 {
     u32_t condCountIdx = totalCondNum++;
-    Condition expr = Condition::getContext().bool_const(("c" + std::to_string(condCountIdx)).c_str());
-    Condition negCond = Condition::NEG(expr);
+    Condition expr = bddManager ? Condition(bddManager->getVar(condCountIdx)) :
+                     Condition(Z3Expr(Z3Expr::getContext().bool_const(("c" + std::to_string(condCountIdx)).c_str())));
+    Condition negCond = condNeg(expr);
     setCondInst(expr, inst);
     setNegCondInst(negCond, inst);
     conditionVec.push_back(expr);
@@ -611,32 +613,267 @@ SaberCondAllocator::Condition SaberCondAllocator::newCond(const ICFGNode* inst)
     return expr;
 }
 
-/// Whether lhs and rhs are equivalent branch conditions
+/*!
+ * Whether lhs and rhs are equivalent branch conditions.
+ * Z3 hash-conses expressions, so structurally equal conditions share an id and
+ * a query is cached by the ids of its two sides. The cache keeps its conditions
+ * alive, so it is bounded and cleared for every source. Conditions over a few branch
+ * conditions only are decided by comparing their truth tables, the remaining
+ * ones by Z3. BDDs are canonical, so with the BDD backend two conditions are
+ * equivalent iff they are the same node.
+ */
 bool SaberCondAllocator::isEquivalentBranchCond(const Condition &lhs,
         const Condition &rhs) const
 {
-    Condition::getSolver().push();
-    Condition::getSolver().add(lhs.getExpr() != rhs.getExpr()); /// check equal using z3 solver
-    z3::check_result res = Condition::getSolver().check();
-    Condition::getSolver().pop();
-    return res == z3::unsat;
+    equivQueryNum++;
+    if (bddManager)
+        return lhs.getBDD() == rhs.getBDD();
+    if (lhs.id() == rhs.id())
+    {
+        equivCacheHitNum++;
+        return true;
+    }
+    std::pair<u32_t, u32_t> key = std::minmax(lhs.id(), rhs.id());
+    auto it = equivQueryCache.find(key);
+    if (it != equivQueryCache.end())
+    {
+        equivCacheHitNum++;
+        return it->second.equivalent;
+    }
+
+    bool equivalent;
+    TruthTable lhsTable, rhsTable;
+    if (computeTruthTables(lhs, rhs, lhsTable, rhsTable))
+    {
+        equivTableNum++;
+        equivalent = (lhsTable == rhsTable);
+    }
+    else
+    {
+        equivZ3Num++;
+        Z3Expr::getSolver().push();
+        Z3Expr::getSolver().add(lhs.getExpr() != rhs.getExpr()); /// check equal using z3 solver
+        z3::check_result res = Z3Expr::getSolver().check();
+        Z3Expr::getSolver().pop();
+        equivalent = (res == z3::unsat);
+    }
+    if (equivQueryCache.size() >= MaxEquivQueryCacheSize)
+        equivQueryCache.clear();
+    equivQueryCache.emplace(key, EquivQuery{lhs, rhs, equivalent});
+    return equivalent;
 }
 
 /// whether condition is satisfiable
 bool SaberCondAllocator::isSatisfiable(const Condition &condition)
 {
-    Condition::getSolver().add(condition.getExpr());
-    z3::check_result result = Condition::getSolver().check();
-    Condition::getSolver().pop();
+    if (bddManager)
+        return condition.getBDD() != BDDManager::FalseRef;
+
+    TruthTable table, falseTable;
+    if (computeTruthTables(condition, getFalseCond(), table, falseTable))
+        return table != falseTable;
+
+    Z3Expr::getSolver().push();
+    Z3Expr::getSolver().add(condition.getExpr());
+    z3::check_result result = Z3Expr::getSolver().check();
+    Z3Expr::getSolver().pop();
     if (result == z3::sat || result == z3::unknown)
         return true;
     else
         return false;
 }
 
-/// extract subexpression from a Z3 expression
+bool SaberCondAllocator::collectTableVars(const z3::expr& expr, Map<u32_t, u32_t>& varToIdx) const
+{
+    if (!expr.is_bool())
+        return false;
+    switch (expr.decl().decl_kind())
+    {
+    case Z3_OP_TRUE:
+    case Z3_OP_FALSE:
+        return true;
+    case Z3_OP_UNINTERPRETED:
+        if (expr.num_args() != 0)
+            return false;
+        if (varToIdx.find(expr.id()) == varToIdx.end())
+        {
+            u32_t idx = varToIdx.size();
+            varToIdx[expr.id()] = idx;
+        }
+        return varToIdx.size() <= std::min(Options::CondTableVars(), MaxTableVars);
+    case Z3_OP_DISTINCT:
+        if (expr.num_args() != 2)
+            return false;
+    /* fall through */
+    case Z3_OP_NOT:
+    case Z3_OP_AND:
+    case Z3_OP_OR:
+    case Z3_OP_XOR:
+    case Z3_OP_IMPLIES:
+    case Z3_OP_IFF:
+    case Z3_OP_EQ:
+    case Z3_OP_ITE:
+        for (u32_t i = 0; i < expr.num_args(); ++i)
+        {
+            if (!collectTableVars(expr.arg(i), varToIdx))
+                return false;
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool SaberCondAllocator::computeTruthTables(const Condition& lhs, const Condition& rhs,
+        TruthTable& lhsTable, TruthTable& rhsTable) const
+{
+    Map<u32_t, u32_t> varToIdx;
+    if (!collectTableVars(lhs.getExpr(), varToIdx) || !collectTableVars(rhs.getExpr(), varToIdx))
+        return false;
+    u32_t numVars = varToIdx.size();
+    Map<u32_t, TruthTable> memo;
+    lhsTable = computeTruthTable(lhs.getExpr(), varToIdx, numVars, memo);
+    rhsTable = computeTruthTable(rhs.getExpr(), varToIdx, numVars, memo);
+    // With fewer than 6 variables only the low 2^numVars bits are assignments
+    if (numVars < 6)
+    {
+        u64_t mask = (1ULL << (1U << numVars)) - 1;
+        lhsTable[0] &= mask;
+        rhsTable[0] &= mask;
+    }
+    return true;
+}
+
+/*!
+ * Assignment a sets variable k to bit k of a. The table of a variable is thus
+ * a fixed bit pattern, and the table of a compound expression is computed
+ * word-wise from the tables of its arguments.
+ */
+const SaberCondAllocator::TruthTable& SaberCondAllocator::computeTruthTable(const z3::expr& expr,
+        const Map<u32_t, u32_t>& varToIdx, u32_t numVars, Map<u32_t, TruthTable>& memo) const
+{
+    auto it = memo.find(expr.id());
+    if (it != memo.end())
+        return it->second;
+
+    static const u64_t varPatterns[6] =
+    {
+        0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+    };
+    assert(numVars <= MaxTableVars && "too many variables for a truth table");
+    u32_t numWords = numVars <= 6 ? 1 : (u32_t) ((u64_t) 1 << (numVars - 6));
+    TruthTable table(numWords, 0);
+    Z3_decl_kind kind = expr.decl().decl_kind();
+    auto argTable = [&](u32_t i) -> const TruthTable&
+    {
+        return computeTruthTable(expr.arg(i), varToIdx, numVars, memo);
+    };
+    switch (kind)
+    {
+    case Z3_OP_TRUE:
+        std::fill(table.begin(), table.end(), ~0ULL);
+        break;
+    case Z3_OP_FALSE:
+        break;
+    case Z3_OP_UNINTERPRETED:
+    {
+        u32_t k = varToIdx.at(expr.id());
+        for (u32_t w = 0; w < numWords; ++w)
+            table[w] = k < 6 ? varPatterns[k] : (((w >> (k - 6)) & 1) ? ~0ULL : 0);
+        break;
+    }
+    case Z3_OP_NOT:
+    {
+        const TruthTable& arg = argTable(0);
+        for (u32_t w = 0; w < numWords; ++w)
+            table[w] = ~arg[w];
+        break;
+    }
+    case Z3_OP_AND:
+    {
+        std::fill(table.begin(), table.end(), ~0ULL);
+        for (u32_t i = 0; i < expr.num_args(); ++i)
+        {
+            const TruthTable& arg = argTable(i);
+            for (u32_t w = 0; w < numWords; ++w)
+                table[w] &= arg[w];
+        }
+        break;
+    }
+    case Z3_OP_OR:
+    case Z3_OP_XOR:
+    {
+        for (u32_t i = 0; i < expr.num_args(); ++i)
+        {
+            const TruthTable& arg = argTable(i);
+            for (u32_t w = 0; w < numWords; ++w)
+                table[w] = kind == Z3_OP_OR ? (table[w] | arg[w]) : (table[w] ^ arg[w]);
+        }
+        break;
+    }
+    case Z3_OP_IMPLIES:
+    {
+        TruthTable premise = argTable(0);
+        const TruthTable& conclusion = argTable(1);
+        for (u32_t w = 0; w < numWords; ++w)
+            table[w] = ~premise[w] | conclusion[w];
+        break;
+    }
+    case Z3_OP_IFF:
+    case Z3_OP_EQ:
+    case Z3_OP_DISTINCT:
+    {
+        // Boolean (in)equality, chained over all arguments
+        std::fill(table.begin(), table.end(), ~0ULL);
+        TruthTable first = argTable(0);
+        for (u32_t i = 1; i < expr.num_args(); ++i)
+        {
+            const TruthTable& arg = argTable(i);
+            for (u32_t w = 0; w < numWords; ++w)
+                table[w] &= ~(first[w] ^ arg[w]);
+        }
+        if (kind == Z3_OP_DISTINCT)
+        {
+            for (u32_t w = 0; w < numWords; ++w)
+                table[w] = ~table[w];
+        }
+        break;
+    }
+    case Z3_OP_ITE:
+    {
+        TruthTable cond = argTable(0);
+        TruthTable thenTable = argTable(1);
+        const TruthTable& elseTable = argTable(2);
+        for (u32_t w = 0; w < numWords; ++w)
+            table[w] = (cond[w] & thenTable[w]) | (~cond[w] & elseTable[w]);
+        break;
+    }
+    default:
+        assert(false && "expression not collected by collectTableVars!");
+        abort();
+    }
+    return memo[expr.id()] = std::move(table);
+}
+
+/*!
+ * Extract the branch conditions of a condition. With the BDD backend these are
+ * the literals of one satisfying path, each given by the id of the condition
+ * allocated for it (a variable or its negation).
+ */
 void SaberCondAllocator::extractSubConds(const Condition &condition, NodeBS &support) const
 {
+    if (bddManager)
+    {
+        std::vector<BDDManager::Literal> cube;
+        bddManager->getOneCube(condition.getBDD(), cube);
+        for (const BDDManager::Literal& lit : cube)
+        {
+            BDDManager::BDDRef var = bddManager->getVar(lit.first);
+            support.set(lit.second ? var : bddManager->NEG(var));
+        }
+        return;
+    }
     if (condition.getExpr().num_args() == 1 && isNegCond(condition.id()))
     {
         support.set(condition.getExpr().id());
@@ -647,7 +884,7 @@ void SaberCondAllocator::extractSubConds(const Condition &condition, NodeBS &sup
             support.set(condition.getExpr().id());
     for (u32_t i = 0; i < condition.getExpr().num_args(); ++i)
     {
-        Condition expr = condition.getExpr().arg(i);
+        Condition expr = Z3Expr(condition.getExpr().arg(i));
         extractSubConds(expr, support);
     }
 
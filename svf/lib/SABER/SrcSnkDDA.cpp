@@ -33,6 +33,8 @@
 #include "Graphs/SVFGStat.h"
 #include "Util/Options.h"
 #include "WPA/Andersen.h"
+#include <atomic>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -65,6 +67,13 @@ void SrcSnkDDA::analyze()
 
     ContextCond::setMaxCxtLen(Options::CxtLimit());
 
+    if (Options::SaberThreads() > 1 || Options::SaberFWSummary())
+    {
+        analyzeInParallel();
+        finalize();
+        return;
+    }
+
     for (SVFGNodeSetIter iter = sourcesBegin(), eiter = sourcesEnd();
             iter != eiter; ++iter)
     {
@@ -110,6 +119,76 @@ void SrcSnkDDA::analyze()
 
 }
 
+/*!
+ * Slices of different sources are independent, hence the forward and backward
+ * traversals run on a pool of threads. Sources are handled in batches so that
+ * only the slices of one batch are kept alive. ProgSlices are then rebuilt in
+ * source order, and their guards and bugs are computed on the current thread
+ * so that the reports are the same as those of the sequential analysis.
+ * Each thread keeps its slicer, and hence its forward summaries, across batches.
+ */
+void SrcSnkDDA::analyzeInParallel()
+{
+    std::vector<const SVFGNode*> srcs(sourcesBegin(), sourcesEnd());
+    const u32_t numThreads = Options::SaberThreads();
+    const u32_t batchSize = numThreads * 16;
+
+    std::vector<std::unique_ptr<SrcSnkSlicer>> slicers;
+    for (u32_t t = 0; t < numThreads; ++t)
+        slicers.push_back(std::make_unique<SrcSnkSlicer>(this, svfg, Options::SaberFWSummary()));
+
+    std::vector<SrcSnkSlicer::Result> results;
+    for (u32_t begin = 0; begin < srcs.size(); begin += batchSize)
+    {
+        const u32_t end = std::min<u32_t>(begin + batchSize, srcs.size());
+        results.clear();
+        results.resize(end - begin);
+
+        std::atomic<u32_t> next(begin);
+        auto worker = [&](SrcSnkSlicer* slicer)
+        {
+            for (u32_t i = next++; i < end; i = next++)
+                slicer->slice(srcs[i], results[i - begin]);
+        };
+        std::vector<std::thread> workers;
+        for (u32_t t = 0; t < numThreads; ++t)
+            workers.push_back(std::thread(worker, slicers[t].get()));
+        for (std::thread& t : workers)
+            t.join();
+
+        for (u32_t i = begin; i < end; ++i)
+        {
+            const SrcSnkSlicer::Result& result = results[i - begin];
+            setCurSlice(srcs[i]);
+            for (const SVFGNode* node : result.forwardSlice)
+                addToCurForwardSlice(node);
+            for (const SVFGNode* node : result.sinks)
+                _curSlice->addToSinks(node);
+            for (const SVFGNode* node : result.backwardSlice)
+                addToCurBackwardSlice(node);
+            if (result.partialReachable)
+                _curSlice->setPartialReachable();
+
+            /// same as analyze(): no bug when reaching a global SVFGNode
+            if (result.reachGlobal)
+                _curSlice->setReachGlobal();
+            else
+            {
+                if(Options::DumpSlice())
+                    annotateSlice(_curSlice);
+
+                if(_curSlice->AllPathReachableSolve())
+                    _curSlice->setAllReachable();
+            }
+
+            reportBug(getCurSlice());
+        }
+    }
+
+    DBOUT(DSaber, outs() << "Forward summaries of the first slicer: " << slicers[0]->getSummaryNum()
+          << " (reused " << slicers[0]->getSummaryHitNum() << ")\n");
+}
+
 
 /*!
  * determine whether a SVFGNode n is in a allocation wrapper function,
@@ -208,7 +287,28 @@ void SrcSnkDDA::FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge)
 
 
     /// perform context sensitive reachability
-    // push context for calling
+    if (!propagateContext(edge, newItem))
+        return;
+
+    /// whether this dstNode has been visited or not
+    if(forwardVisited(dstNode,newItem))
+    {
+        DBOUT(DSaber,outs() << " node "<< dstNode->getId() <<" has been visited\n");
+        return;
+    }
+    else
+        addForwardVisited(dstNode, newItem);
+
+    if(pushIntoWorklist(newItem))
+        DBOUT(DSaber,outs() << " --> " << edge->getDstID() << ", cxt size: " << newItem.getContexts().cxtSize() <<")\n");
+
+}
+
+/*!
+ * Push context for calling and match context for return
+ */
+bool SrcSnkDDA::propagateContext(const SVFGEdge* edge, DPIm& newItem)
+{
     if (edge->isCallVFGEdge())
     {
         CallSiteID csId = 0;
@@ -220,7 +320,6 @@ void SrcSnkDDA::FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge)
         newItem.pushContext(csId);
         DBOUT(DSaber, outs() << " push cxt [" << csId << "] ");
     }
-    // match context for return
     else if (edge->isRetVFGEdge())
     {
         CallSiteID csId = 0;
@@ -232,23 +331,11 @@ void SrcSnkDDA::FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge)
         if (newItem.matchContext(csId) == false)
         {
             DBOUT(DSaber, outs() << "-|-\n");
-            return;
+            return false;
         }
         DBOUT(DSaber, outs() << " pop cxt [" << csId << "] ");
     }
-
-    /// whether this dstNode has been visited or not
-    if(forwardVisited(dstNode,newItem))
-    {
-        DBOUT(DSaber,outs() << " node "<< dstNode->getId() <<" has been visited\n");
-        return;
-    }
-    else
-        addForwardVisited(dstNode, newItem);
-
-    if(pushIntoWorklist(newItem))
-        DBOUT(DSaber,outs() << " --> " << edge->getDstID() << ", cxt size: " << newItem.getContexts().cxtSize() <<")\n");
-
+    return true;
 }
 
 /*!
@@ -277,6 +364,7 @@ void SrcSnkDDA::setCurSlice(const SVFGNode* src)
         _curSlice = nullptr;
         clearVisitedMap();
     }
+    getSaberCondAllocator()->clearEquivQueryCache();
 
     _curSlice = new ProgSlice(src,getSaberCondAllocator(), getSVFG());
 }
@@ -304,4 +392,165 @@ void SrcSnkDDA::printZ3Stat()
 
     outs() << "Z3 Mem usage: " << getSaberCondAllocator()->getMemUsage() << "\n";
     outs() << "Z3 Number: " << getSaberCondAllocator()->getCondNum() << "\n";
+    outs() << "Cond Equivalence Queries: " << getSaberCondAllocator()->getEquivQueryNum()
+           << " (cached " << getSaberCondAllocator()->getEquivCacheHitNum()
+           << ", truth table " << getSaberCondAllocator()->getEquivTableNum()
+           << ", Z3 " << getSaberCondAllocator()->getEquivZ3Num() << ")\n";
+    if (const BDDManager* bdd = getSaberCondAllocator()->getBDDManager())
+    {
+        outs() << "BDD Nodes: " << bdd->getNodeNum()
+               << " (unique table hits " << bdd->getUniqueHitNum() << ")\n";
+        outs() << "BDD Cache: " << bdd->getCacheHitNum() << " hits, "
+               << bdd->getCacheMissNum() << " misses\n";
+    }
+}
+
+void SrcSnkSlicer::slice(const SVFGNode* src, Result& result)
+{
+    cur = &result;
+    nodeToDPItemsMap.clear();
+    visitedSet.clear();
+
+    ContextCond cxt;
+    DPIm item(src->getId(), cxt);
+    if (useSummary)
+    {
+        FWSummary summary;
+        forwardClosure(item, summary);
+        for (NodeID id : summary.nodes)
+            result.forwardSlice.insert(getNode(id));
+        for (NodeID id : summary.sinks)
+            result.sinks.insert(getNode(id));
+        result.partialReachable = !summary.sinks.empty();
+        result.reachGlobal = summary.reachGlobal;
+    }
+    else
+        forwardTraverse(item);
+
+    if (result.reachGlobal)
+        return;
+    for (const SVFGNode* sink : result.sinks)
+    {
+        ContextCond sinkCxt;
+        DPIm sinkItem(sink->getId(), sinkCxt);
+        backwardTraverse(sinkItem);
+    }
+}
+
+void SrcSnkSlicer::FWProcessCurNode(const DPIm& item)
+{
+    const SVFGNode* node = getNode(item.getCurNodeID());
+    if(dda->isSink(node))
+    {
+        cur->sinks.insert(node);
+        cur->partialReachable = true;
+    }
+    cur->forwardSlice.insert(node);
+}
+
+void SrcSnkSlicer::BWProcessCurNode(const DPIm& item)
+{
+    const SVFGNode* node = getNode(item.getCurNodeID());
+    if(cur->forwardSlice.find(node) != cur->forwardSlice.end())
+        cur->backwardSlice.insert(node);
+}
+
+void SrcSnkSlicer::FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge)
+{
+    const SVFGNode* dstNode = edge->getDstNode();
+    DPIm newItem(dstNode->getId(), item.getContexts());
+
+    if(dda->isGlobalSVFGNode(dstNode) || cur->reachGlobal)
+    {
+        cur->reachGlobal = true;
+        return;
+    }
+
+    if (!SrcSnkDDA::propagateContext(edge, newItem))
+        return;
+
+    if (nodeToDPItemsMap[dstNode].insert(newItem).second)
+        pushIntoWorklist(newItem);
+}
+
+void SrcSnkSlicer::BWProcessIncomingEdge(const DPIm&, SVFGEdge* edge)
+{
+    const SVFGNode* srcNode = edge->getSrcNode();
+    if (!visitedSet.insert(srcNode).second)
+        return;
+
+    ContextCond cxt;
+    DPIm newItem(srcNode->getId(), cxt);
+    pushIntoWorklist(newItem);
+}
+
+/*!
+ * Forward traversal with the same rules as FWProcessOutgoingEdge. When a call
+ * edge enters a callee, the summary of the callee entry item is merged instead
+ * of exploring it. A summary reaching a global only marks the closure as
+ * reaching a global, as a traversal stops propagating once a global is met.
+ */
+void SrcSnkSlicer::forwardClosure(const DPIm& start, FWSummary& summary)
+{
+    WorkList worklist;
+    DPImSet visited;
+    worklist.push(start);
+    while (!worklist.empty())
+    {
+        DPIm item = worklist.pop();
+        const SVFGNode* node = getNode(item.getCurNodeID());
+        summary.nodes.set(node->getId());
+        if (dda->isSink(node))
+            summary.sinks.set(node->getId());
+
+        for (const SVFGEdge* edge : node->getOutEdges())
+        {
+            const SVFGNode* dstNode = edge->getDstNode();
+            if (dda->isGlobalSVFGNode(dstNode) || summary.reachGlobal)
+            {
+                summary.reachGlobal = true;
+                continue;
+            }
+
+            DPIm newItem(dstNode->getId(), item.getContexts());
+            if (!SrcSnkDDA::propagateContext(edge, newItem))
+                continue;
+            if (!visited.insert(newItem).second)
+                continue;
+
+            if (edge->isCallVFGEdge())
+            {
+                if (const FWSummary* callee = getSummary(newItem))
+                {
+                    if (callee->reachGlobal)
+                        summary.reachGlobal = true;
+                    else
+                    {
+                        summary.nodes |= callee->nodes;
+                        summary.sinks |= callee->sinks;
+                    }
+                    continue;
+                }
+            }
+            worklist.push(newItem);
+        }
+    }
+}
+
+const SrcSnkSlicer::FWSummary* SrcSnkSlicer::getSummary(const DPIm& entry)
+{
+    auto it = summaries.find(entry);
+    if (it != summaries.end())
+    {
+        ++summaryHitNum;
+        return &it->second;
+    }
+    /// a recursive call reaching an entry under computation is explored inline
+    if (!inProgress.insert(entry).second)
+        return nullptr;
+
+    FWSummary summary;
+    forwardClosure(entry, summary);
+    inProgress.erase(entry);
+    return &(summaries[entry] = std::move(summary));
 }
@@ -0,0 +1,154 @@
+//===- BDD.cpp -- Reduced ordered binary decision diagrams--------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * BDD.cpp
+ *
+ */
+
+#include "Util/BDD.h"
+#include <sstream>
+
+using namespace SVF;
+
+BDDManager::BDDManager(u32_t cacheBits) : cache((size_t) 1 << cacheBits)
+{
+    // Terminals are ordered below every variable
+    const u32_t terminalVar = std::numeric_limits<u32_t>::max();
+    nodes.push_back({terminalVar, FalseRef, FalseRef});
+    nodes.push_back({terminalVar, TrueRef, TrueRef});
+}
+
+BDDManager::BDDRef BDDManager::makeNode(u32_t var, BDDRef low, BDDRef high)
+{
+    if (low == high)
+        return low;
+    std::pair<u32_t, u64_t> key(var, ((u64_t) low << 32) | high);
+    auto it = uniqueTable.find(key);
+    if (it != uniqueTable.end())
+    {
+        uniqueHitNum++;
+        return it->second;
+    }
+    BDDRef ref = nodes.size();
+    assert(ref != NullRef && "too many BDD nodes");
+    nodes.push_back({var, low, high});
+    uniqueTable[key] = ref;
+    return ref;
+}
+
+BDDManager::BDDRef BDDManager::getVar(u32_t var)
+{
+    return makeNode(var, FalseRef, TrueRef);
+}
+
+BDDManager::BDDRef BDDManager::ITE(BDDRef f, BDDRef g, BDDRef h)
+{
+    // Terminal cases
+    if (f == TrueRef || g == h)
+        return g;
+    if (f == FalseRef)
+        return h;
+    if (g == TrueRef && h == FalseRef)
+        return f;
+
+    CacheEntry& entry = cache[cacheSlot(f, g, h)];
+    if (entry.f == f && entry.g == g && entry.h == h)
+    {
+        cacheHitNum++;
+        return entry.result;
+    }
+    cacheMissNum++;
+
+    u32_t var = std::min(nodes[f].var, std::min(nodes[g].var, nodes[h].var));
+    BDDRef high = ITE(cofactor(f, var, true), cofactor(g, var, true), cofactor(h, var, true));
+    BDDRef low = ITE(cofactor(f, var, false), cofactor(g, var, false), cofactor(h, var, false));
+    BDDRef result = makeNode(var, low, high);
+
+    // The recursive calls may have overwritten the slot
+    CacheEntry& slot = cache[cacheSlot(f, g, h)];
+    slot.f = f;
+    slot.g = g;
+    slot.h = h;
+    slot.result = result;
+    return result;
+}
+
+void BDDManager::getSupport(BDDRef f, Set<u32_t>& vars) const
+{
+    std::vector<BDDRef> worklist{f};
+    Set<BDDRef> visited;
+    while (!worklist.empty())
+    {
+        BDDRef n = worklist.back();
+        worklist.pop_back();
+        if (isTerminal(n) || !visited.insert(n).second)
+            continue;
+        vars.insert(nodes[n].var);
+        worklist.push_back(nodes[n].low);
+        worklist.push_back(nodes[n].high);
+    }
+}
+
+bool BDDManager::getOneCube(BDDRef f, std::vector<Literal>& cube) const
+{
+    if (f == FalseRef)
+        return false;
+    // In a reduced BDD every non-terminal node has a path to TrueRef,
+    // so prefer the high branch unless it is FalseRef
+    while (f != TrueRef)
+    {
+        const Node& node = nodes[f];
+        bool positive = node.high != FalseRef;
+        cube.push_back(Literal(node.var, positive));
+        f = positive ? node.high : node.low;
+    }
+    return true;
+}
+
+u32_t BDDManager::getDagSize(BDDRef f) const
+{
+    std::vector<BDDRef> worklist{f};
+    Set<BDDRef> visited;
+    while (!worklist.empty())
+    {
+        BDDRef n = worklist.back();
+        worklist.pop_back();
+        if (!visited.insert(n).second || isTerminal(n))
+            continue;
+        worklist.push_back(nodes[n].low);
+        worklist.push_back(nodes[n].high);
+    }
+    return visited.size();
+}
+
+std::string BDDManager::toString(BDDRef f) const
+{
+    if (f == TrueRef)
+        return "true";
+    if (f == FalseRef)
+        return "false";
+    if (f == NullRef)
+        return "null";
+    std::stringstream rawstr;
+    rawstr << "(c" << nodes[f].var << " ? " << toString(nodes[f].high) << " : " << toString(nodes[f].low) << ")";
+    return rawstr.str();
+}
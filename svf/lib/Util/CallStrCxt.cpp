@@ -0,0 +1,140 @@
+//===- CallStrCxt.cpp -- Hash-consed call string contexts---------------------//
+//
+//                     SVF: Static Value-Flow Analysis
+//
+// Copyright (C) <2013->  <Yulei Sui>
+//
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+
+// You should have received a copy of the GNU Affero General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+//===----------------------------------------------------------------------===//
+/*
+ * CallStrCxt.cpp
+ *
+ */
+
+#include "Util/CallStrCxt.h"
+
+using namespace SVF;
+
+CallStrCxtTable::CallStrCxtTable() : chunks(), shards(new Shard[1u << ShardBits]), cxtNum(0)
+{
+    // The root is the empty context
+    addNode(0, 0);
+}
+
+CallStrCxtTable::~CallStrCxtTable()
+{
+    for (std::atomic<Node*>& chunk : chunks)
+        delete[] chunk.load(std::memory_order_relaxed);
+}
+
+u32_t CallStrCxtTable::addNode(u32_t parent, u32_t callSite)
+{
+    u32_t id = cxtNum.fetch_add(1, std::memory_order_relaxed);
+    assert(id != InvalidId && "too many call string contexts");
+    // Nodes of one chunk may be created under the locks of different shards
+    u32_t chunkIdx, offset;
+    locate(id, chunkIdx, offset);
+    std::atomic<Node*>& chunk = chunks[chunkIdx];
+    Node* nodes = chunk.load(std::memory_order_acquire);
+    if (nodes == nullptr)
+    {
+        Node* fresh = new Node[(size_t) 1 << (ChunkBits + chunkIdx)];
+        if (chunk.compare_exchange_strong(nodes, fresh, std::memory_order_acq_rel))
+            nodes = fresh;
+        else
+            delete[] fresh;
+    }
+
+    Node& node = nodes[offset];
+    node.parent = parent;
+    node.callSite = callSite;
+    node.depth = id == 0 ? 0 : getNode(parent).depth + 1;
+    if (node.depth == 1)
+        node.front.store(0, std::memory_order_relaxed);
+    return id;
+}
+
+u32_t CallStrCxtTable::getChild(u32_t id, u32_t callSite)
+{
+    u64_t key = ((u64_t) id << 32) | callSite;
+    Shard& shard = shards[((key ^ (key >> 29)) * 0x9e3779b97f4a7c15ULL) >> (64 - ShardBits)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.children.find(key);
+    if (it != shard.children.end())
+        return it->second;
+    u32_t child = addNode(id, callSite);
+    shard.children.emplace(key, child);
+    return child;
+}
+
+/*!
+ * The suffix of a context is the suffix of its parent followed by its last call
+ * site. It is cached in the node, so that k-limiting a context pushed again and
+ * again only walks the trie once.
+ */
+u32_t CallStrCxtTable::dropFront(u32_t id)
+{
+    const Node& node = getNode(id);
+    u32_t front = node.front.load(std::memory_order_relaxed);
+    if (front != InvalidId)
+        return front;
+    front = getChild(dropFront(node.parent), node.callSite);
+    const_cast<Node&>(node).front.store(front, std::memory_order_relaxed);
+    return front;
+}
+
+bool CallStrCxtTable::contains(u32_t id, u32_t callSite) const
+{
+    for (; id != 0; id = getNode(id).parent)
+    {
+        if (getNode(id).callSite == callSite)
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * Two call strings first differ right below their longest common prefix, which
+ * is the lowest common ancestor of their nodes. A prefix is smaller than the
+ * strings extending it.
+ */
+bool CallStrCxtTable::less(u32_t lhs, u32_t rhs) const
+{
+    u32_t lhsDepth = getNode(lhs).depth, rhsDepth = getNode(rhs).depth;
+    u32_t l = getAncestor(lhs, std::min(lhsDepth, rhsDepth));
+    u32_t r = getAncestor(rhs, std::min(lhsDepth, rhsDepth));
+    if (l == r)
+        return lhsDepth < rhsDepth;
+    while (getNode(l).parent != getNode(r).parent)
+    {
+        l = getNode(l).parent;
+        r = getNode(r).parent;
+    }
+    return getNode(l).callSite < getNode(r).callSite;
+}
+
+CallStrCxt::const_iterator CallStrCxt::begin() const
+{
+    const CallStrCxtTable& table = CallStrCxtTable::getTable();
+    std::shared_ptr<std::vector<u32_t>> path = std::make_shared<std::vector<u32_t>>(size());
+    u32_t node = id;
+    for (u32_t i = path->size(); i > 0; --i)
+    {
+        (*path)[i - 1] = table.getNode(node).callSite;
+        node = table.getNode(node).parent;
+    }
+    return const_iterator(path, 0);
+}
@@ -7,6 +7,7 @@
 #include "MSSA/MemSSA.h"
 #include "WPA/WPAPass.h"
 #include "AE/Svfexe/AbstractInterpretation.h"
+#include "SABER/SaberCondAllocator.h"
 
 namespace SVF
 {
@@ -116,6 +117,12 @@ const Option<bool> Options::InsenCycle(
     false
 );
 
+const Option<std::string> Options::DDAInsenEdgeFile(
+    "insen-edges",
+    "File caching the context insensitive SVFG edges of -in-recur/-in-cycle, read if it matches the SVFG and written otherwise",
+    ""
+);
+
 const Option<bool> Options::PrintCPts(
     "cpts",
     "Dump conditional points-to set ",
@@ -144,6 +151,24 @@ OptionMultiple<PointerAnalysis::PTATY> Options::DDASelected(
 }
 );
 
+const Option<bool> Options::DDAServer(
+    "dda-server",
+    "Load the program once and answer points-to/alias queries read from stdin",
+    false
+);
+
+const Option<u32_t> Options::DDAServerThreads(
+    "dda-server-threads",
+    "Number of worker threads (each with its own solver) in -dda-server mode",
+    1
+);
+
+const Option<bool> Options::DDAServerCheck(
+    "dda-server-check",
+    "Answer the requests of -dda-server again one at a time at the end and report the answers differing from the concurrent ones",
+    false
+);
+
 // FlowDDA.cpp
 const Option<u32_t> Options::FlowBudget(
     "flow-bg",
@@ -151,6 +176,31 @@ const Option<u32_t> Options::FlowBudget(
     10000
 );
 
+// DDAVFSolver.h
+const Option<bool> Options::DDABatchQueries(
+    "dda-batch",
+    "Share resolved DPItems across the queries of a client, re-resolving them once new SVFG edges are added",
+    false
+);
+
+const Option<u32_t> Options::DDAQueryCacheSize(
+    "dda-query-cache",
+    "Maximum number of DPItems kept resolved across queries in -dda-batch mode (0 for no limit)",
+    100000
+);
+
+const Option<u32_t> Options::DDATrialBudget(
+    "dda-trial-budget",
+    "Answer every query with this step budget first and re-run the out-of-budget ones with the full budget (0 to disable)",
+    0
+);
+
+const Option<std::string> Options::DDAQueryReport(
+    "dda-query-report",
+    "Write the steps, time, memory and budget status of every DDA query to a CSV file",
+    ""
+);
+
 
 // Offline constraint graph (OfflineConsG.cpp)
 const Option<bool> Options::OCGDotGraph(
@@ -464,6 +514,12 @@ const Option<bool> Options::PrintLockSpan(
     false
 );
 
+const Option<u32_t> Options::LockThreads(
+    "lock-threads",
+    "Number of threads for the intra-procedural lock analysis",
+    1
+);
+
 
 // MHP.cpp
 const Option<bool> Options::PrintInterLev(
@@ -478,6 +534,12 @@ const Option<bool> Options::DoLockAnalysis(
     true
 );
 
+const Option<u32_t> Options::MHPThreads(
+    "mhp-threads",
+    "Number of threads for the interleaving analysis and all-pair MHP computation",
+    1
+);
+
 
 // MTAStat.cpp
 const Option<bool> Options::AllPairMHP(
@@ -487,6 +549,40 @@ const Option<bool> Options::AllPairMHP(
 );
 
 
+// MTA.cpp
+const Option<u32_t> Options::RaceThreads(
+    "race-threads",
+    "Number of threads checking the race candidates of -race",
+    1
+);
+
+const Option<std::string> Options::RaceReport(
+    "race-report",
+    "Dump the races found by -race to a JSON file",
+    ""
+);
+
+const Option<bool> Options::FSMPTA(
+    "fsmpta",
+    "Run the flow-sensitive pointer analysis for multithreaded programs and use its results in -race",
+    false
+);
+
+
+// FSMPTA.cpp
+const Option<u32_t> Options::FSMPTAThreads(
+    "fsmpta-threads",
+    "Number of threads computing the thread interference edges of the SVFG",
+    1
+);
+
+const Option<bool> Options::FSMPTALockedEdges(
+    "fsmpta-locked-edges",
+    "Also add thread interference edges between accesses protected by a common lock",
+    false
+);
+
+
 // TCT.cpp
 const Option<bool> Options::TCTDotGraph(
     "dump-tct",
@@ -494,6 +590,24 @@ const Option<bool> Options::TCTDotGraph(
     false
 );
 
+const Option<u32_t> Options::TCTThreads(
+    "tct-threads",
+    "Number of threads expanding the calling contexts of threads when building the TCT (the TCT node ids of 1 and of more threads differ)",
+    1
+);
+
+const Option<std::string> Options::WriteTCT(
+    "write-tct",
+    "Write the thread creation tree to a user-specified text file",
+    ""
+);
+
+const Option<std::string> Options::ReadTCT(
+    "read-tct",
+    "Read the thread creation tree from a text file written by -write-tct",
+    ""
+);
+
 
 // LeakChecker.cpp
 const Option<bool> Options::ValidateTests(
@@ -516,6 +630,18 @@ const Option<u32_t> Options::CxtLimit(
     3
 );
 
+const Option<u32_t> Options::SaberThreads(
+    "saber-threads",
+    "number of threads to compute the slices of different sources in source-sink analysis",
+    1
+);
+
+const Option<bool> Options::SaberFWSummary(
+    "saber-fw-summary",
+    "Reuse the forward reachability of callee entries across sources in source-sink analysis",
+    false
+);
+
 
 // CHG.cpp
 const Option<bool> Options::DumpCHA(
@@ -593,6 +719,28 @@ const Option<bool> Options::PrintPathCond(
     false
 );
 
+const Option<u32_t> Options::CondTableVars(
+    "cond-table-vars",
+    "Decide path condition queries over at most this many branch conditions (up to 20) by truth tables instead of Z3",
+    10
+);
+
+const OptionMap<u32_t> Options::SaberCondBackend(
+    "saber-cond",
+    "Representation of path conditions in source-sink analysis (Default -z3)",
+    SaberCondAllocator::CondBackend::Z3_COND,
+{
+    {
+        SaberCondAllocator::CondBackend::Z3_COND, "z3",
+        "Z3 expressions, approximated beyond -max-z3-size."
+    },
+    {
+        SaberCondAllocator::CondBackend::BDD_COND, "bdd",
+        "Reduced ordered BDDs, exact without a size limit."
+    }
+}
+);
+
 
 // SaberSVFGBuilder.cpp
 const Option<bool> Options::CollectExtRetGlobals(
@@ -763,6 +911,30 @@ const Option<bool> Options::POCRHybrid(
     false
 );
 
+const Option<bool> Options::CFLMatrix(
+    "cfl-matrix",
+    "When explicit to true, CFLMatrixSolver solves CFL reachability by semi-naive rounds over per-label adjacency matrices.",
+    false
+);
+
+const Option<u32_t> Options::CFLThreads(
+    "cfl-threads",
+    "Number of threads of CFLMatrixSolver, more than one also selects it for CFLAlias, POCRAlias and CFLVF",
+    1
+);
+
+const Option<std::string> Options::CFLClosureIn(
+    "cfl-closure-in",
+    "Closure saved by a previous run with the same grammar, mapped to the graph by node keys and updated incrementally by CFLMatrixSolver",
+    ""
+);
+
+const Option<std::string> Options::CFLClosureOut(
+    "cfl-closure-out",
+    "File to save the closure of CFLMatrixSolver to after the last round of solving",
+    ""
+);
+
 const Option<bool> Options::Customized(
     "customized",
     "When explicit to true, user can use any grammar file.",
@@ -802,6 +974,21 @@ const OptionMap<u32_t> Options::HandleRecur(
     }
 }
 );
+const OptionMap<u32_t> Options::WidenStrategy(
+    "widen-strategy",
+    "Widening operator at cycle heads in abstract execution (Default -standard)",
+    AbstractInterpretation::WidenStrategy::STANDARD_WIDEN,
+{
+    {
+        AbstractInterpretation::WidenStrategy::STANDARD_WIDEN, "standard",
+        "Unstable interval bounds are widened to infinity."
+    },
+    {
+        AbstractInterpretation::WidenStrategy::THRESHOLD_WIDEN, "threshold",
+        "Unstable interval bounds are widened to the nearest constant compared against or object size in the function first."
+    }
+}
+);
 const Option<u32_t> Options::Timeout(
     "timeout", "time out (seconds), set -1 (no timeout), default 14400s",14400);
 const Option<std::string> Options::OutputName(
@@ -832,4 +1019,34 @@ const Option<u32_t> Options::AEPrecision(
     0
 );
 
+const Option<bool> Options::ZoneDomain(
+    "zone-domain",
+    "Track difference constraints between packed integer variables in abstract execution",
+    false
+);
+
+const Option<u32_t> Options::ZonePackSize(
+    "zone-pack-size",
+    "Max number of variables in one pack of the zone domain",
+    8
+);
+
+const Option<bool> Options::AESummary(
+    "ae-summary",
+    "Reuse the effect of a call when the callee and its entry state are unchanged",
+    false
+);
+
+const Option<std::string> Options::AESummaryFile(
+    "ae-summary-file",
+    "Load function summaries from and save them to this file (implies -ae-summary)",
+    ""
+);
+
+const Option<bool> Options::AEEvictStates(
+    "ae-evict-states",
+    "Drop the abstract states of a callee once it is analysed, except at call, return, exit and cycle head nodes",
+    false
+);
+
 } // namespace SVF.
@@ -45,7 +45,8 @@ const std::map<GenericBug::BugType, std::string> GenericBug::BugType2Str =
     {GenericBug::FILEPARTIALCLOSE, "File Partial Close"},
     {GenericBug::DOUBLEFREE, "Double Free"},
     {GenericBug::FULLNULLPTRDEREFERENCE, "Full Null Ptr Dereference"},
-    {GenericBug::PARTIALNULLPTRDEREFERENCE, "Partial Null Ptr Dereference"}
+    {GenericBug::PARTIALNULLPTRDEREFERENCE, "Partial Null Ptr Dereference"},
+    {GenericBug::DATARACE, "Data Race"}
 };
 
 const std::string GenericBug::getLoc() const
@@ -274,6 +275,32 @@ void PartialNullPtrDereferenceBug::printBugToTerminal() const
                     << GenericBug::getLoc() << ")\n";
 }
 
+cJSON *DataRaceBug::getBugDescription() const
+{
+    cJSON *bugDescription = cJSON_CreateObject();
+    const SVFBugEvent& loadEvent = bugEventStack.front();
+    const SVFBugEvent& storeEvent = bugEventStack.back();
+
+    cJSON *loadLoc = cJSON_Parse(loadEvent.getEventLoc().c_str());
+    if(loadLoc == nullptr) loadLoc = cJSON_CreateObject();
+    cJSON *storeLoc = cJSON_Parse(storeEvent.getEventLoc().c_str());
+    if(storeLoc == nullptr) storeLoc = cJSON_CreateObject();
+
+    cJSON_AddItemToObject(bugDescription, "LoadLoc", loadLoc);
+    cJSON_AddItemToObject(bugDescription, "LoadFunction", cJSON_CreateString(loadEvent.getFuncName().c_str()));
+    cJSON_AddItemToObject(bugDescription, "StoreLoc", storeLoc);
+    cJSON_AddItemToObject(bugDescription, "StoreFunction", cJSON_CreateString(storeEvent.getFuncName().c_str()));
+
+    return bugDescription;
+}
+
+void DataRaceBug::printBugToTerminal() const
+{
+    SVFUtil::errs() << SVFUtil::bugMsg1("\t DataRace :") <<  " store at : ("
+                    << GenericBug::getLoc() << ")\n";
+    SVFUtil::errs() << "\t\t racing load at : (" << bugEventStack.front().getEventLoc() << ")\n";
+}
+
 const std::string SVFBugEvent::getFuncName() const
 {
     return eventInst->getFun()->getName();
@@ -42,6 +42,7 @@
 #include "WPA/VersionedFlowSensitive.h"
 #include "WPA/TypeAnalysis.h"
 #include "WPA/Steensgaard.h"
+#include "MemoryModel/AliasOracle.h"
 
 using namespace SVF;
 
@@ -132,6 +133,10 @@ void WPAPass::runPointerAnalysis(SVFIR* pag, u32_t kind)
 void WPAPass::PrintAliasPairs(PointerAnalysis* pta)
 {
     SVFIR* pag = pta->getPAG();
+    /// answer the quadratic number of queries by classes of pointers with the same points-to set
+    std::unique_ptr<AliasOracle> oracle;
+    if (BVDataPTAImpl* bvPta = SVFUtil::dyn_cast<BVDataPTAImpl>(pta))
+        oracle = std::make_unique<AliasOracle>(bvPta);
     for (SVFIR::iterator lit = pag->begin(), elit = pag->end(); lit != elit; ++lit)
     {
         PAGNode* node1 = lit->second;
@@ -143,7 +148,7 @@ void WPAPass::PrintAliasPairs(PointerAnalysis* pta)
                 continue;
             const FunObjVar* fun1 = node1->getFunction();
             const FunObjVar* fun2 = node2->getFunction();
-            AliasResult result = pta->alias(node1->getId(), node2->getId());
+            AliasResult result = oracle ? oracle->alias(node1->getId(), node2->getId()) : pta->alias(node1->getId(), node2->getId());
             SVFUtil::outs()	<< (result == AliasResult::NoAlias ? "NoAlias" : "MayAlias")
                             << " var" << node1->getId() << "[" << node1->getName()
                             << "@" << (fun1==nullptr?"":fun1->getName()) << "] --"